@@ -0,0 +1,118 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CASH_SPENTTOKENSTORE_HPP
+#define OPENTXS_CASH_SPENTTOKENSTORE_HPP
+
+#include "opentxs/core/util/Common.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace opentxs
+{
+
+class String;
+
+// Spent token database.
+//
+// Each mint series keeps one append-only log in the spent folder, named
+// "<instrument definition id>.<series>.log". Every record holds the hash of
+// a spent token followed by the armored token itself, and is synced to disk
+// before it counts as recorded. The hashes of a series are read into memory
+// the first time the series is used, so checking a token does not touch the
+// disk at all.
+//
+// Earlier versions stored one file per spent token, in a folder named
+// "<instrument definition id>.<series>". Those files are still checked for
+// any series which has such a folder.
+class SpentTokenStore
+{
+private:
+    class Series
+    {
+    public:
+        std::mutex lock_;
+        bool loaded_{false};
+        bool legacy_{false};
+        std::string folder_;
+        std::string log_;
+        std::unordered_set<std::string> spent_;
+    };
+
+    std::mutex lock_;
+    std::map<std::string, std::unique_ptr<Series>> series_;
+
+    Series& GetSeries(const String& instrumentDefinitionID, int32_t series);
+    bool Load(Series& series);
+    bool Append(
+        Series& series,
+        const std::string& tokenHash,
+        const std::string& token);
+    bool IsSpent(Series& series, const std::string& tokenHash);
+
+    SpentTokenStore() = default;
+    SpentTokenStore(const SpentTokenStore&) = delete;
+    SpentTokenStore& operator=(const SpentTokenStore&) = delete;
+
+public:
+    EXPORT static SpentTokenStore& It();
+
+    // Returns false only if the token is known not to be spent. Any error
+    // reading the spent token database counts as spent.
+    EXPORT bool IsSpent(
+        const String& instrumentDefinitionID,
+        int32_t series,
+        const String& tokenHash);
+    // Records the token as spent, unless it already was. Checking and
+    // recording happen under one lock, so of two concurrent deposits of the
+    // same token only one can succeed.
+    EXPORT bool RecordSpent(
+        const String& instrumentDefinitionID,
+        int32_t series,
+        const String& tokenHash,
+        const String& token);
+};
+
+}  // namespace opentxs
+
+#endif  // OPENTXS_CASH_SPENTTOKENSTORE_HPP
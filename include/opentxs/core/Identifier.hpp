@@ -43,7 +43,10 @@
 #include "opentxs/core/Proto.hpp"
 #include "opentxs/core/Types.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
+#include <mutex>
 #include <string>
 
 /** An Identifier is basically a 256 bit hash value. This class makes it easy to
@@ -66,6 +69,14 @@ private:
     EXPORT static proto::HashType IDToHashType(const ID type);
 
     ID type_{DefaultType};
+    // The encoded form is expensive to compute, so GetString() remembers the
+    // last result along with the type byte and digest it was computed from.
+    mutable std::mutex cache_lock_;
+    mutable std::string cached_raw_;
+    mutable std::string cached_string_;
+
+    std::string raw() const;
+    int compare(const Identifier& rhs) const;
 
 public:
     EXPORT friend std::ostream& operator<<(std::ostream& os, const String& obj);
@@ -81,7 +92,7 @@ public:
     EXPORT explicit Identifier(const OTSymmetricKey& theKey);
     EXPORT explicit Identifier(const OTCachedKey& theKey);
 
-    using OTData::swap;
+    EXPORT void swap(Identifier& rhs);
     EXPORT Identifier& operator=(Identifier rhs);
     EXPORT bool operator==(const Identifier& s2) const;
     EXPORT bool operator!=(const Identifier& s2) const;
@@ -108,4 +119,13 @@ public:
     EXPORT virtual ~Identifier() = default;
 };
 }  // namespace opentxs
+
+namespace std
+{
+template <>
+struct hash<opentxs::Identifier> {
+    EXPORT size_t operator()(const opentxs::Identifier& id) const;
+};
+}  // namespace std
+
 #endif  // OPENTXS_CORE_OTIDENTIFIER_HPP
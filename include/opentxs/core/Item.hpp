@@ -48,6 +48,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 namespace opentxs
 {
@@ -58,7 +59,7 @@ class Ledger;
 class Nym;
 class OTTransaction;
 
-typedef std::list<Item*> listOfItems;
+typedef std::vector<Item*> listOfItems;
 
 // Item as in "Transaction Item"
 // An OTLedger contains a list of transactions (pending transactions, inbox or
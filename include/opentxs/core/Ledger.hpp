@@ -46,6 +46,7 @@
 #include <cstdint>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace opentxs
 {
@@ -67,6 +68,8 @@ class String;
 // request one.
 
 typedef std::map<int64_t, OTTransaction*> mapOfTransactions;
+typedef std::multimap<int64_t, OTTransaction*> multimapOfTransactions;
+typedef std::vector<OTTransaction*> vectorOfTransactions;
 
 // the "inbox" and "outbox" functionality is implemented in this class
 class Ledger : public OTTransactionType
@@ -81,6 +84,25 @@ private:
     mapOfTransactions m_mapTransactions; // a ledger contains a map of
                                          // transactions.
 
+    // Secondary indexes over m_mapTransactions, maintained by
+    // AddTransaction / RemoveTransaction. Keyed on the raw values, so a
+    // transaction whose key was never set sits under 0.
+    multimapOfTransactions m_mapByRequestNum;
+    multimapOfTransactions m_mapByNumberOfOrigin;
+    multimapOfTransactions m_mapByInRefTo;
+
+    // m_mapTransactions in order, for GetTransactionByIndex. Rebuilt on
+    // demand after the map changes.
+    mutable vectorOfTransactions m_vecTransactions;
+
+    void InsertTransaction(OTTransaction& theTransaction);
+    void IndexTransaction(OTTransaction& theTransaction);
+    void UnindexTransaction(OTTransaction& theTransaction);
+    void GetIndexedTransactions(const multimapOfTransactions& theIndex,
+                                int64_t lKey,
+                                vectorOfTransactions& theOutput) const;
+    const vectorOfTransactions& GetTransactionVector() const;
+
 protected:
     // return -1 if error, 0 if nothing, and 1 if the node was processed.
     virtual int32_t ProcessXMLNode(irr::io::IrrXMLReader*& xml);
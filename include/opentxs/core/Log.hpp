@@ -43,9 +43,13 @@
 #include "opentxs/core/util/Assert.hpp"
 
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
 #include <thread>
 
 #if defined(unix) || defined(__unix__) || defined(__unix) ||                   \
@@ -90,13 +94,19 @@ class OTLogStream : public std::ostream, std::streambuf
 {
 private:
     int logLevel;
-    int next;
-    char* pBuffer;
+    // Each thread assembles its own line, so that lines written by different
+    // threads at the same time are not interleaved or overrun.
+    std::mutex bufferLock;
+    std::map<std::thread::id, std::string> buffers;
 
 public:
     explicit OTLogStream(int _logLevel);
     ~OTLogStream();
 
+    /** A stream whose level is above nLogLevel is left in a failed state, so
+     * that operator<< returns without formatting anything. */
+    void SetLogLevel(int32_t nLogLevel);
+
     virtual int overflow(int c);
 };
 
@@ -119,6 +129,25 @@ private:
 
     bool m_bInitialized;
 
+    std::mutex m_memlogLock;
+
+    /** Output waiting for the writer thread, which appends it to stderr and
+     * the log file in batches. */
+    std::mutex m_bufferLock;
+    std::condition_variable m_bufferSignal;
+    std::string m_strBuffer;
+    bool m_bWriting;
+    bool m_bShutdown;
+    std::thread m_writer;
+
+    Log();
+    ~Log();
+
+    void Enqueue(const String& strOutput);
+    void WriteLoop();
+
+    static void UpdateStreams(const int32_t& nLogLevel);
+
     /** For things that represent internal inconsistency in the code. Normally
      * should NEVER happen even with bad input from user. (Don't call this
      * directly. Use the above #defined macro instead.) */
@@ -161,8 +190,13 @@ public:
     // OTLog Functions:
     //
 
+    /** Queues strOutput for the writer thread. Before Init(), it is written
+     * to stderr directly. */
     EXPORT static bool LogToFile(const String& strOutput);
 
+    /** Blocks until everything queued so far has been written. */
+    EXPORT static void Flush();
+
     /** We keep 1024 logs in memory, to make them available via the API. */
     EXPORT static int32_t GetMemlogSize();
     EXPORT static String GetMemlogAtIndex(int32_t nIndex);
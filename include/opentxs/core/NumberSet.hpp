@@ -0,0 +1,127 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_NUMBERSET_HPP
+#define OPENTXS_CORE_NUMBERSET_HPP
+
+#include "opentxs/core/util/Common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace opentxs
+{
+
+class String;
+
+/** Set of transaction (or request) numbers, as held by a Nym for one notary.
+ * Nyms are issued their numbers in blocks, so the numbers are stored as runs
+ * of consecutive values. Adding, removing and verifying a number is
+ * O(log n) in the number of runs, and a Nym with thousands of numbers usually
+ * has only a handful of runs. Iteration is in ascending order. */
+class NumberSet
+{
+public:
+    /** Maps the first number of each run to the last. */
+    typedef std::map<int64_t, int64_t> Ranges;
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int64_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int64_t* pointer;
+        typedef const int64_t& reference;
+
+        const_iterator(
+            Ranges::const_iterator range,
+            Ranges::const_iterator end);
+
+        reference operator*() const { return value_; }
+        pointer operator->() const { return &value_; }
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& rhs) const;
+        bool operator!=(const const_iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        Ranges::const_iterator range_;
+        Ranges::const_iterator end_;
+        int64_t value_{0};
+    };
+
+    EXPORT NumberSet() = default;
+
+    /** if false, means the value was already there. */
+    EXPORT bool Add(const int64_t& theValue);
+    /** if false, means the value was NOT already there. */
+    EXPORT bool Remove(const int64_t& theValue);
+    /** returns true/false (whether value is already there.) */
+    EXPORT bool Verify(const int64_t& theValue) const;
+    /** The number at position nIndex, counting from the lowest. Returns 0 if
+     * there is no such position. This walks the runs, so loops over every
+     * number should iterate the set instead. */
+    EXPORT int64_t At(std::size_t nIndex) const;
+    /** The lowest and highest numbers. Return 0 if the set is empty. */
+    EXPORT int64_t Lowest() const;
+    EXPORT int64_t Highest() const;
+    /** Outputs the numbers as a comma-separated string, in the same form as
+     * NumList. returns false if the set was empty. */
+    EXPORT bool Output(String& strOutput) const;
+    const Ranges& Intervals() const { return m_ranges; }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool empty() const { return 0 == m_size; }
+    std::size_t size() const { return m_size; }
+    EXPORT void clear();
+
+private:
+    Ranges m_ranges;
+    std::size_t m_size{0};
+};
+
+}  // namespace opentxs
+
+#endif  // OPENTXS_CORE_NUMBERSET_HPP
@@ -40,6 +40,7 @@
 #define OPENTXS_CORE_OTPSEUDONYM_HPP
 
 #include "opentxs/core/Identifier.hpp"
+#include "opentxs/core/NumberSet.hpp"
 #include "opentxs/core/NymIDSource.hpp"
 #include "opentxs/core/Proto.hpp"
 #include "opentxs/core/Types.hpp"
@@ -50,9 +51,11 @@
 #include <cstdint>
 #include <czmq.h>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 
 namespace opentxs
@@ -74,13 +77,14 @@ class Wallet;
 typedef std::deque<Message*> dequeOfMail;
 typedef std::map<std::string, int64_t> mapOfRequestNums;
 typedef std::map<std::string, int64_t> mapOfHighestNums;
-typedef std::deque<int64_t> dequeOfTransNums;
-typedef std::map<std::string, dequeOfTransNums*> mapOfTransNums;
+typedef std::map<std::string, NumberSet*> mapOfTransNums;
 typedef std::map<std::string, Identifier> mapOfIdentifiers;
 typedef std::map<std::string, CredentialSet*> mapOfCredentialSets;
 typedef std::list<OTAsymmetricKey*> listOfAsymmetricKeys;
 typedef proto::CredentialIndex serializedCredentialIndex;
 typedef bool CredentialIndexModeFlag;
+// Nym ID, nymfile payload (empty if the nymfile could not be written)
+typedef std::function<void(const String&, const String&)> NymfileCallback;
 
 class Nym
 {
@@ -91,7 +95,14 @@ public:
     static const CredentialIndexModeFlag FULL_CREDS = false;
     Nym(const Nym&) = default;
 
+    // Called each time SaveSignedNymfile() writes a nymfile, or fails to.
+    // Pass an empty function to remove it.
+    EXPORT static void SetNymfileCallback(const NymfileCallback& callback);
+
 private:
+    static std::mutex nymfile_callback_lock_;
+    static NymfileCallback nymfile_callback_;
+
     std::string alias_;
     uint32_t version_{0};
     std::uint32_t index_{0};
@@ -673,6 +684,8 @@ public:
     EXPORT int64_t GetIssuedNum(
         const Identifier& theNotaryID,
         int32_t nIndex) const;  // index
+    EXPORT const NumberSet& GetIssuedNums(
+        const Identifier& theNotaryID) const;  // all, ascending
 
     EXPORT bool AddIssuedNum(
         const String& strNotaryID,
@@ -693,6 +706,8 @@ public:
     EXPORT int64_t GetTransactionNum(
         const Identifier& theNotaryID,
         int32_t nIndex) const;  // index
+    EXPORT const NumberSet& GetTransactionNums(
+        const Identifier& theNotaryID) const;  // all, ascending
 
     EXPORT bool AddTransactionNum(
         const String& strNotaryID,
@@ -784,6 +799,8 @@ public:
     EXPORT int64_t GetAcknowledgedNum(
         const Identifier& theNotaryID,
         int32_t nIndex) const;  // index
+    EXPORT const NumberSet& GetAcknowledgedNums(
+        const Identifier& theNotaryID) const;  // all, ascending
 
     EXPORT bool AddAcknowledgedNum(
         const String& strNotaryID,
@@ -830,6 +847,11 @@ public:
         const mapOfTransNums& THE_MAP,
         const Identifier& theNotaryID,
         int32_t nIndex) const;
+    // Looking a number up by index walks the runs of the set, so loops over
+    // every number should iterate this instead. Empty if there are none.
+    EXPORT const NumberSet& GetGenericNums(
+        const mapOfTransNums& THE_MAP,
+        const Identifier& theNotaryID) const;
     // Whenever a Nym receives a message via his Nymbox, and then the Nymbox is
     // processed, (which happens automatically)
     // that processing will drop all mail messages into this deque for
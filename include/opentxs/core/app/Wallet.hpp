@@ -155,7 +155,7 @@ public:
      *    \returns A smart pointer to the object. The smart pointer will not be
      *             instantiated if the object does not exist or is invalid.
      */
-    std::shared_ptr<proto::PeerReply> PeerReply(
+    std::shared_ptr<const proto::PeerReply> PeerReply(
         const Identifier& nym,
         const Identifier& reply,
         const StorageBox& box) const;
@@ -237,7 +237,7 @@ public:
      *    \returns A smart pointer to the object. The smart pointer will not be
      *             instantiated if the object does not exist or is invalid.
      */
-    std::shared_ptr<proto::PeerRequest> PeerRequest(
+    std::shared_ptr<const proto::PeerRequest> PeerRequest(
         const Identifier& nym,
         const Identifier& request,
         const StorageBox& box) const;
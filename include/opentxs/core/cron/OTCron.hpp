@@ -44,6 +44,11 @@
 #include "opentxs/core/util/StringUtils.hpp"
 #include "opentxs/core/util/Timer.hpp"
 
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
+
 namespace opentxs
 {
 
@@ -68,10 +73,34 @@ class OTCron : public Contract
 private:
     typedef Contract ot_super;
 
+    /** Where a cron item sits on m_multimapCronItems and m_multimapDueItems. */
+    struct ItemPosition {
+        multimapOfCronItems::iterator added_;
+        multimapOfCronItems::iterator due_;
+    };
+
 private:
     mapOfMarkets m_mapMarkets;      // A list of all valid markets.
     mapOfCronItems m_mapCronItems;  // Cron Items are found on both lists.
     multimapOfCronItems m_multimapCronItems;
+    multimapOfCronItems m_multimapDueItems;  // Mapped to the time each item
+                                             // is next due for processing, so
+                                             // a round only visits those.
+    std::map<int64_t, ItemPosition> m_mapItemPositions;  // By transaction
+                                                          // number.
+
+    // Changes since the last SaveCron() are appended to the cron journal
+    // instead of rewriting the whole cron file each time.
+    int64_t m_lJournalGeneration;  // Stored in the cron file. Journal records
+                                   // from any other generation are stale.
+    int32_t m_nJournalRecords;     // Records in the journal right now.
+
+    // Only used while LoadCron() replays the journal.
+    std::map<int64_t, std::pair<time64_t, String>> m_mapJournalItems;
+    std::set<int64_t> m_setJournalRemovals;
+    listOfLongNumbers m_listJournalNumbers;
+    bool m_bJournalHasNumbers;
+    int64_t m_lJournalNextNumber;
     Identifier m_NOTARY_ID;  // Always store this in any object that's
                              // associated with a specific server.
 
@@ -137,6 +166,8 @@ public:
     EXPORT mapOfCronItems::iterator FindItemOnMap(int64_t lTransactionNum);
     EXPORT multimapOfCronItems::iterator FindItemOnMultimap(
         int64_t lTransactionNum);
+    /** Call whenever theItem's GetNextDueDate() may have changed. */
+    void ScheduleCronItem(OTCronItem& theItem);
     // MARKETS
     bool AddMarket(OTMarket& theMarket, bool bSaveMarketFile = true);
     bool RemoveMarket(const Identifier& MARKET_ID);  // if returns false,
@@ -189,7 +220,12 @@ public:
     inline Nym* GetServerNym() const { return m_pServerNym; }
 
     EXPORT bool LoadCron();
+    /** Saves the whole cron file, which also empties the journal. */
     EXPORT bool SaveCron();
+    /** Call after adding or changing theItem. Only theItem gets written. */
+    EXPORT bool SaveCronItem(OTCronItem& theItem);
+    /** Call after adding transaction numbers. */
+    EXPORT bool SaveTransactionNumbers();
 
     EXPORT OTCron();
     explicit OTCron(const Identifier& NOTARY_ID);
@@ -207,6 +243,14 @@ public:
     /** Before transmission or serialization, this is where the ledger saves its
      * contents */
     virtual void UpdateContents();
+
+private:
+    void EraseItemPosition(int64_t lTransactionNum);
+
+    bool SaveCronRemovals(const listOfLongNumbers& theRemovals);
+    bool AppendJournal(const char* szAction, const String& strData);
+    void ReadJournal();
+    void ReplayJournal();
 };
 
 }  // namespace opentxs
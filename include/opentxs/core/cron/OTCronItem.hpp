@@ -149,10 +149,7 @@ public:
     {
         return m_bRemovalFlag;
     }
-    inline void FlagForRemoval()
-    {
-        m_bRemovalFlag = true;
-    }
+    EXPORT void FlagForRemoval();
     inline void SetCronPointer(OTCron& theCron)
     {
         m_pCron = &theCron;
@@ -199,6 +196,10 @@ public:
     {
         return m_PROCESS_INTERVAL;
     }
+    // The time when ProcessCron() will next have any work to do. Subclasses
+    // skip processing until their interval has passed since the last process
+    // date. (Items which never set a process date are always due.)
+    time64_t GetNextDueDate() const;
 
     inline OTCron* GetCron() const
     {
@@ -78,6 +78,17 @@ protected:
         OTPassword& theOutput, const char* szPrompt) const = 0;
 
 public:
+    /** Linear-time base64 (RFC 4648) encoding, used for armored payloads. */
+    static std::string Base64Encode(
+        const std::uint8_t* inputStart,
+        const size_t& inputSize,
+        const bool& breakLines = false);
+    /** Whitespace is skipped. Returns false on any other invalid input. */
+    static bool Base64Decode(
+        const char* inputStart,
+        const size_t& inputSize,
+        std::string& output);
+
     static std::string Base58CheckEncode(
         const std::string& input,
         const bool& breakLines = false);
@@ -42,6 +42,8 @@
 #include "opentxs/core/String.hpp"
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -74,6 +76,10 @@ extern const char* OT_BEGIN_SIGNED_escaped;
 /** The natural state of OTASCIIArmor is in compressed and base64-encoded,
  string form.
 
+ Encoded payloads start with a version tag followed by base64 of the data and
+ its CRC-32. Payloads without the tag are legacy Base58Check, and are still
+ decoded.
+
  HOW TO USE THIS CLASS
 
  Methods that put data into OTASCIIArmor
@@ -176,6 +182,15 @@ public:
     EXPORT bool SetString(const String& theData, bool bLineBreaks = true);
 
 private:
+    static std::string encode(
+        const std::uint8_t* input,
+        const std::size_t size,
+        const bool lineBreaks);
+    static bool decode(
+        const char* input,
+        const std::size_t size,
+        std::string& output);
+
     std::string compress_string(
         const std::string& str,
         int32_t compressionlevel) const;
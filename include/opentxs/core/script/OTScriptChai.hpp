@@ -41,6 +41,9 @@
 
 #include "opentxs/core/script/OTScript.hpp"
 
+#include <memory>
+#include <vector>
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4702) // warning C4702: unreachable code
@@ -64,6 +67,19 @@ namespace opentxs
 
 class OTScriptChai : public OTScript
 {
+private:
+    // A ChaiScript instance with the standard library and the static OT
+    // calls already loaded, plus a snapshot of its state from before any
+    // script used it. Engines are pooled, since building one is far more
+    // expensive than running a typical clause.
+    class Engine;
+
+    static std::vector<std::unique_ptr<Engine>>& IdleEngines();
+    static Engine* CheckoutEngine();
+    static void ReturnEngine(Engine* pEngine);
+
+    Engine* const engine_;
+
 public:
     OTScriptChai();
     OTScriptChai(const String& strValue);
@@ -71,6 +87,9 @@ public:
     OTScriptChai(const char* new_string, size_t sizeLength);
     OTScriptChai(const std::string& new_string);
 
+    // Puts the engine back in the state it was checked out in (dropping the
+    // parties, variables and calls registered for this script) and returns
+    // it to the pool.
     virtual ~OTScriptChai();
 
     virtual bool ExecuteScript(OTVariable* pReturnVar = nullptr);
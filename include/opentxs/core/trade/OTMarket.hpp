@@ -138,8 +138,15 @@ private:
     // two are technically
     // interchangeable.
 
-    void cleanup_four_accounts(Account* p1, Account* p2, Account* p3,
-                               Account* p4);
+    // Nyms, accounts and inboxes used by the matches made during one sweep
+    // of the book. Each is loaded and verified once per sweep, and the
+    // changed ones are signed and saved once when the sweep ends.
+    // Defined in OTMarket.cpp.
+    class MatchSession;
+
+    void ProcessTrade(MatchSession& session, OTTrade& theTrade,
+                      OTOffer& theOffer, OTOffer& theOtherOffer);
+
     void rollback_four_accounts(Account& p1, bool b1, const int64_t& a1,
                                 Account& p2, bool b2, const int64_t& a2,
                                 Account& p3, bool b3, const int64_t& a3,
@@ -169,8 +176,6 @@ public:
     // then both are passed in here.
     // --Returns True if Trade should stay on the Cron list for more processing.
     // --Returns False if it should be removed and deleted.
-    void ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
-                      OTOffer& theOtherOffer);
     bool ProcessTrade(OTTrade& theTrade, OTOffer& theOffer);
 
     int64_t GetHighestBidPrice();
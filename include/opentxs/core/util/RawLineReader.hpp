@@ -0,0 +1,92 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_UTIL_RAWLINEREADER_HPP
+#define OPENTXS_CORE_UTIL_RAWLINEREADER_HPP
+
+#include <cstddef>
+
+namespace opentxs
+{
+
+// Hands out the lines of a contract's raw file in place, without copying
+// them. Lines are split exactly the way String::sgets splits them with the
+// 2048 byte buffer ParseRawFile used to read into: at each newline, and
+// after every 2047 characters of an overlong line. The signed content
+// depends on that.
+class RawLineReader
+{
+public:
+    RawLineReader(const char* szData, std::size_t lLength)
+        : data_(szData)
+        , length_(lLength)
+        , position_(0)
+    {
+    }
+
+    // Returns false once the last line has been handed out.
+    bool Next(const char*& pLine, std::size_t& lLength)
+    {
+        pLine = data_ + position_;
+        lLength = 0;
+
+        while ((position_ < length_) && (lLength < MaxLine)) {
+            if ('\n' == data_[position_]) {
+                ++position_;
+
+                return position_ < length_;
+            }
+
+            ++position_;
+            ++lLength;
+        }
+
+        return position_ < length_;
+    }
+
+private:
+    static const std::size_t MaxLine = 2047;
+
+    const char* data_;
+    std::size_t length_;
+    std::size_t position_;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_UTIL_RAWLINEREADER_HPP
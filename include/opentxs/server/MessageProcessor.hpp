@@ -41,17 +41,27 @@
 
 #include <czmq.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 // forward declare czmq types
 typedef struct _zsock_t zsock_t;
 typedef struct _zactor_t zactor_t;
 typedef struct _zpoller_t zpoller_t;
+typedef struct _zmsg_t zmsg_t;
 
 namespace opentxs
 {
 
+class Message;
 class ServerLoader;
 class OTServer;
 
@@ -63,15 +73,50 @@ public:
     EXPORT void run();
 
 private:
+    // Requests are assigned to a worker by the identity of the client
+    // connection, so requests from any one client are processed in the order
+    // they were received.
+    struct WorkQueue
+    {
+        std::mutex lock_;
+        std::condition_variable signal_;
+        std::deque<zmsg_t*> requests_;
+    };
+
+    // Each request holds the stripes of the Nyms, accounts and units it can
+    // modify (see UserCommandProcessor::LockKeys), so requests which touch
+    // different accounts run in parallel. Requests which modify state shared
+    // by the whole server, and Cron, hold every stripe.
+    static const std::size_t LOCK_STRIPES = 64;
+    // How often lockStripes() starts over after finding more IDs under the
+    // stripes it holds, before it gives up and holds every stripe.
+    static const int STRIPE_ATTEMPTS = 3;
+
     void init(int port, zcert_t* transportKey);
     bool processMessage(const std::string& messageString, std::string& reply);
-    void processSocket();
+    void processFrontend();
+    void processBackend();
+    void startThreads();
+    void stopThreads();
+    void worker(WorkQueue* queue);
+    void cron();
+    static std::set<std::size_t> getStripes(
+        const std::set<std::string>& keys);
+    std::vector<std::unique_lock<std::mutex>> lockStripes(
+        const Message& message);
+    std::vector<std::unique_lock<std::mutex>> lockAllStripes();
 
 private:
     OTServer* server_;
-    zsock_t* zmqSocket_;
+    zsock_t* frontend_;
+    zsock_t* backend_;
     zactor_t* zmqAuth_;
     zpoller_t* zmqPoller_;
+    std::atomic<bool> shutdown_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::unique_ptr<std::thread> cron_;
+    std::mutex stripes_[LOCK_STRIPES];
 };
 
 } // namespace opentxs
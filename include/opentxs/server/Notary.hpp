@@ -39,6 +39,9 @@
 #ifndef OPENTXS_SERVER_NOTARY_HPP
 #define OPENTXS_SERVER_NOTARY_HPP
 
+#include <set>
+#include <string>
+
 namespace opentxs
 {
 
@@ -52,6 +55,14 @@ class Notary
 public:
     explicit Notary(OTServer* server);
 
+    // Adds the IDs of every Nym and account whose files notarizing
+    // transaction can modify to keys, plus "unit <ID>" for the voucher and
+    // cash reserve accounts and the mint of a unit. Returns false if the
+    // transaction can modify state shared by the whole server (Cron, markets,
+    // baskets, dividends), or if it can't tell.
+    bool LockKeys(OTTransaction& transaction,
+                  std::set<std::string>& keys) const;
+
     // If the server receives a notarizeTransaction command, it will be
     // accompanied by a payload containing a ledger to be notarized.
     // UserCmdNotarizeTransaction will loop through that ledger,
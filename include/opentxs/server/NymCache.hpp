@@ -0,0 +1,114 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_NYMCACHE_HPP
+#define OPENTXS_SERVER_NYMCACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+namespace proto
+{
+class CredentialIndex;
+} // namespace proto
+
+class Nym;
+class String;
+
+// Remembers the client Nyms whose credentials and nymfiles the server has
+// already verified, so that repeated requests from the same Nym don't have
+// to reload and re-verify them every time.
+//
+// Cached credentials are only used while their revision matches the
+// credential index in storage, and are dropped by Invalidate() (registerNym
+// and unregisterNym call it.) A cached nymfile is used without reading the
+// file at all. Nym::SaveSignedNymfile() hands each nymfile it writes to
+// Update(), and drops the cached one if the write fails, so this relies on
+// the server writing nymfiles only that way.
+class NymCache
+{
+public:
+    NymCache();
+    ~NymCache();
+
+    // Loads the public credentials of nym. Sets verified if they came from
+    // the cache, in which case the caller can skip VerifyPseudonym().
+    bool LoadCredentials(Nym& nym, bool& verified);
+    // Call once VerifyPseudonym() succeeds for a Nym loaded above.
+    void SetVerified(const Nym& nym);
+    // Same as nym.LoadSignedNymfile(signer), but uses the cached nymfile if
+    // there is one instead of reading and verifying the file.
+    bool LoadNymfile(Nym& nym, Nym& signer);
+    // Replaces the cached nymfile of a Nym which is already in the cache. An
+    // empty payload drops it.
+    void Update(const String& nymID, const String& payload);
+    void Invalidate(const String& nymID);
+
+private:
+    struct Entry {
+        std::uint64_t revision_{0};
+        std::shared_ptr<const proto::CredentialIndex> credentials_;
+        // Payload of the nymfile, empty until it has been verified
+        std::string payload_;
+        // Changes whenever payload_ is replaced
+        std::uint64_t generation_{0};
+        std::list<std::string>::iterator position_;
+    };
+
+    std::mutex lock_;
+    std::map<std::string, Entry> entries_;
+    // Most recently used first.
+    std::list<std::string> lru_;
+    std::uint64_t generation_{0};
+
+    // Caches a nymfile read from disk, unless it was replaced since
+    // generation was read.
+    void setNymfile(const String& nymID, const std::uint64_t generation,
+                    const String& payload);
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_NYMCACHE_HPP
@@ -53,6 +53,7 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 
@@ -101,6 +102,8 @@ public:
     void ProcessCron();
     int64_t computeTimeout()
     {
+        std::lock_guard<std::recursive_mutex> cronLock(cron_lock_);
+
         return m_Cron.computeTimeout();
     }
 
@@ -148,6 +151,9 @@ private:
     Nym m_nymServer;
 
     OTCron m_Cron; // This is where re-occurring and expiring tasks go.
+    // Guards m_Cron (and the markets inside it) against concurrent access
+    // from the cron thread and the request worker threads.
+    std::recursive_mutex cron_lock_;
 };
 
 } // namespace opentxs
@@ -77,6 +77,26 @@ struct ServerSettings
         __heartbeat_ms_between_beats = value;
     }
 
+    static int32_t GetWorkerThreads()
+    {
+        return __worker_threads;
+    }
+
+    static void SetWorkerThreads(int32_t value)
+    {
+        __worker_threads = value;
+    }
+
+    static int32_t GetNymCacheSize()
+    {
+        return __nym_cache_size;
+    }
+
+    static void SetNymCacheSize(int32_t value)
+    {
+        __nym_cache_size = value;
+    }
+
     static const std::string& GetOverrideNymID()
     {
         return __override_nym_id;
@@ -92,6 +112,13 @@ struct ServerSettings
     static int32_t __heartbeat_no_requests;
     static int32_t __heartbeat_ms_between_beats;
 
+    // The number of threads processing client requests. (0 means one per core.)
+    static int32_t __worker_threads;
+
+    // The number of verified client Nyms remembered between requests.
+    // (0 turns the cache off.)
+    static int32_t __nym_cache_size;
+
     // The Nym who's allowed to do certain commands even if they are turned off.
     static std::string __override_nym_id;
     // Are usage credits REQUIRED in order to use this server?
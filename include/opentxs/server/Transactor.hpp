@@ -44,6 +44,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace opentxs
@@ -55,6 +56,7 @@ class Nym;
 class Identifier;
 class Account;
 class MainFile;
+class NumList;
 
 class Transactor
 {
@@ -65,6 +67,7 @@ public:
     ~Transactor();
 
     bool issueNextTransactionNumber(int64_t& txNumber);
+    bool issueNextTransactionNumbers(int32_t count, NumList& txNumbers);
     bool issueNextTransactionNumberToNym(Nym& nym, int64_t& txNumber);
     bool verifyTransactionNumber(Nym& nym, const int64_t& transactionNumber);
     bool removeTransactionNumber(Nym& nym, const int64_t& transactionNumber,
@@ -77,9 +80,19 @@ public:
         return transactionNumber_;
     }
 
+    // Everything up to here has been reserved in the main file, and may
+    // already have been issued. This is what gets saved.
+    int64_t reservedTransactionNumber() const
+    {
+        return reservedTransactionNumber_;
+    }
+
+    // Called when loading the main file. Numbers which were reserved but
+    // not issued before a restart are skipped, never reissued.
     void transactionNumber(int64_t value)
     {
         transactionNumber_ = value;
+        reservedTransactionNumber_ = value;
     }
 
     bool addBasketAccountID(const Identifier& basketId,
@@ -132,9 +145,20 @@ private:
     typedef std::multimap<std::string, Mint*> MintsMap;
     typedef std::map<std::string, std::string> BasketsMap;
 
+    // How many transaction numbers each save of the main file reserves.
+    static const int64_t TRANSACTION_NUMBER_BLOCK = 1000;
+
+    bool reserveTransactionNumbers(int64_t count);
+
 private:
+    // Request worker threads and the cron thread share this object. (Also
+    // taken by MainFile while it reads the members below.)
+    std::recursive_mutex lock_;
     // This stores the last VALID AND ISSUED transaction number.
     int64_t transactionNumber_;
+    // The highest transaction number saved in the main file. Numbers are
+    // issued from memory until transactionNumber_ catches up with it.
+    int64_t reservedTransactionNumber_;
     // maps basketId with basketAccountId
     BasketsMap idToBasketMap_;
     // basket issuer account ID, which is *different* on each server, using the
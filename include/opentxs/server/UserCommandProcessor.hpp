@@ -39,7 +39,11 @@
 #ifndef OPENTXS_SERVER_USERCOMMANDPROCESSOR_HPP
 #define OPENTXS_SERVER_USERCOMMANDPROCESSOR_HPP
 
+#include "opentxs/server/NymCache.hpp"
+
 #include <cstdint>
+#include <set>
+#include <string>
 
 namespace opentxs
 {
@@ -57,6 +61,10 @@ public:
 
     bool ProcessUserCommand(Message& msgIn, Message& msgOut,
                             ClientConnection* connection, Nym* nym);
+    // Adds the IDs of every Nym and account whose files processing msgIn can
+    // modify to keys (see Notary::LockKeys). Returns false if the command
+    // can modify state shared by the whole server.
+    bool LockKeys(const Message& msgIn, std::set<std::string>& keys) const;
 
 private:
     bool SendMessageToNym(const Identifier& notaryID,
@@ -115,6 +123,7 @@ private:
 
 private:
     OTServer* server_;
+    NymCache nym_cache_;
 };
 
 } // namespace opentxs
@@ -41,20 +41,27 @@
 
 #include "opentxs/core/Proto.hpp"
 #include "opentxs/core/Types.hpp"
+#include "opentxs/storage/StorageCache.hpp"
 #include "opentxs/storage/StorageConfig.hpp"
+#include "opentxs/storage/StoragePool.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 namespace opentxs
 {
@@ -66,6 +73,66 @@ typedef std::function<std::string()>
 typedef std::function<void(const proto::CredentialIndex&)> NymLambda;
 typedef std::function<void(const proto::ServerContract&)> ServerLambda;
 typedef std::function<void(const proto::UnitDefinition&)> UnitLambda;
+// Receives the bytes of a stored object, which are only valid for the
+// duration of the call
+typedef std::function<bool(const char*, const std::size_t)> RawReader;
+// Called once a traversal has finished, with the same value as its result
+typedef std::function<void(const bool)> TraversalCallback;
+
+// Work done by garbage collection since the Storage object was created. Pause
+// times are in microseconds, and measure how long collection kept writers
+// blocked.
+class StorageGCMetrics
+{
+public:
+    uint64_t runs_ = 0;
+    uint64_t keys_migrated_ = 0;
+    uint64_t bytes_migrated_ = 0;
+    uint64_t last_pause_ = 0;
+    uint64_t longest_pause_ = 0;
+    uint64_t total_pause_ = 0;
+};
+
+// Handle to a traversal started by Storage::MapPublicNyms(), MapServers()
+// or MapUnitDefinitions()
+class StorageTraversal
+{
+private:
+    friend class Storage;
+
+    std::atomic<bool> cancel_{false};
+    std::promise<bool> promise_;
+    std::shared_future<bool> result_;
+    TraversalCallback done_;
+    // Snapshot of the index being traversed
+    std::vector<proto::StorageItemHash> items_;
+    // Position of the next item to be visited
+    std::atomic<std::size_t> next_{0};
+    // Number of workers which have not finished yet
+    std::atomic<std::size_t> workers_{0};
+    // Set if an object in the snapshot could not be loaded
+    std::atomic<bool> missed_{false};
+    // Serializes calls to the lambda
+    std::mutex lambda_lock_;
+
+    StorageTraversal() = delete;
+    StorageTraversal(const StorageTraversal&) = delete;
+    StorageTraversal& operator=(const StorageTraversal&) = delete;
+
+public:
+    explicit StorageTraversal(const TraversalCallback& done)
+        : result_(promise_.get_future().share())
+        , done_(done)
+    {
+    }
+
+    // Objects which are already being visited are finished, the rest are
+    // skipped
+    void Cancel() { cancel_.store(true); }
+    // True if every object in the index was visited. False if the traversal
+    // was cancelled, or the index or any object in it could not be read.
+    std::shared_future<bool> Result() const { return result_; }
+};
 
 // Content-aware storage module for opentxs
 //
@@ -97,7 +164,7 @@ class Storage
 template<class T>
 bool LoadProto(
     const std::string& hash,
-    std::shared_ptr<T>& serialized,
+    std::shared_ptr<const T>& serialized,
     const bool checking = false)
 {
     if (hash.empty()) {
@@ -108,43 +175,62 @@ bool LoadProto(
         return false;
     }
 
+    // While collection is migrating objects, most of them are still in the
+    // old bucket. Once it is done, everything reachable is in the active one.
     bool attemptFirst;
-    if (gc_running_.load() ) {
+    if (gc_migrating_.load()) {
         attemptFirst = !current_bucket_;
     } else {
         attemptFirst = current_bucket_;
     }
 
-    std::string data;
+    // Objects are content addressed, so a cached copy is always current.
+    // Every caller shares it; those which modify what they load must copy it
+    // first.
+    auto cached = std::dynamic_pointer_cast<const T>(cache_.Get(hash));
 
-    std::lock_guard<std::mutex> bucketLock(bucket_lock_);
-    bool foundInPrimary = false;
-    if (Load(hash, data, attemptFirst)) {
-        if (1 < data.size()) {
-            serialized.reset(new T);
-            serialized->ParseFromArray(data.c_str(), data.size());
+    if (cached) {
+        serialized = cached;
 
-            foundInPrimary = proto::Check<T>(*serialized, 0, 0xFFFFFFFF);
-        }
+        return true;
     }
 
+    std::size_t size = 0;
+    std::shared_ptr<T> loaded;
+    const RawReader parse = [&](const char* data, const std::size_t bytes)
+    {
+        size = bytes;
+
+        if (1 < bytes) {
+            loaded.reset(new T);
+            loaded->ParseFromArray(data, bytes);
+
+            return Verify(*loaded);
+        }
+
+        return false;
+    };
+
+    // Parsing and validation happen under the lock too, but since it is
+    // shared they do not hold up other readers.
+    SharedGuard bucketLock(bucket_lock_);
+    bool foundInPrimary = Load(hash, attemptFirst, parse);
+
     bool foundInSecondary = false;
     if (!foundInPrimary) {
         // try again in the other bucket
-        if (Load(hash, data, !attemptFirst)) {
-            if (1 < data.size()) {
-                serialized.reset(new T);
-                serialized->ParseFromArray(data.c_str(), data.size());
-
-                foundInSecondary = proto::Check<T>(*serialized, 0, 0xFFFFFFFF);
-            }
-        }
+        foundInSecondary = Load(hash, !attemptFirst, parse);
     }
 
     if (!foundInPrimary && !foundInSecondary && !checking) {
         std::cerr << "Failed loading object" << std::endl
                   << "Hash: " << hash << std::endl
-                  << "Size: " << data.size() << std::endl;
+                  << "Size: " << size << std::endl;
+    }
+
+    if (foundInPrimary || foundInSecondary) {
+        serialized = loaded;
+        cache_.Put(hash, serialized, size);
     }
 
     return (foundInPrimary || foundInSecondary);
@@ -194,10 +280,53 @@ private:
      */
     typedef std::map<std::string, Metadata> Index;
 
+    typedef ::google::protobuf::RepeatedPtrField<proto::StorageItemHash>
+        ItemHashList;
+    // Loads the object an index entry refers to and passes it to the lambda
+    // of a traversal, under the lock it is given. Returns false if the object
+    // could not be loaded.
+    typedef std::function<bool(const proto::StorageItemHash&, std::mutex&)>
+        ItemVisitor;
+
+    // Nym, server and unit indices are stored as a tree keyed by the FNV-1a
+    // hash of the item id, one hex digit per level. A node with few enough
+    // items is a leaf listing them, and is an ordinary index object. Any
+    // other node lists its children instead, and both the node and each of
+    // its entries carry a version reserved for that. A change rewrites only
+    // the nodes on the path to its item, and unchanged subtrees keep their
+    // hash.
+    struct IndexTree
+    {
+        // Item ids ordered by hash, so the items under a node are contiguous
+        std::set<std::pair<uint32_t, std::string>> keys_;
+        // Hash of each stored node below the root, by path
+        std::map<std::string, std::string> nodes_;
+        // Paths whose items changed since they were last stored
+        std::set<std::string> dirty_;
+
+        // Add an item which is already stored
+        void Add(const std::string& id);
+        // Add or change an item, and mark its path for rewriting
+        void Touch(const std::string& id);
+        void Remove(const std::string& id);
+    };
+
+    // Brackets the writes made by one logical update with BeginBatch() and
+    // CommitBatch(). Defined in Storage.cpp.
+    class Batch;
+
     static Storage* instance_pointer_;
 
     std::thread* gc_thread_ = nullptr;
     int64_t gc_interval_ = std::numeric_limits<int64_t>::max();
+    // Only used by the garbage collection thread
+    bool gc_resumed_ = false;
+    int64_t gc_slice_ = 0;
+    StorageCache cache_;
+    // Runs traversals, and the loads they fan out to
+    StoragePool pool_;
+    mutable std::mutex gc_metrics_lock_;
+    StorageGCMetrics gc_metrics_;
 
     Storage(const Storage&) = delete;
     Storage& operator=(const Storage&) = delete;
@@ -206,6 +335,14 @@ private:
         const std::string& id,
         const std::string& hash,
         proto::StorageNymList& box);
+    // True if the calling thread has a write batch open. The caller must
+    // hold write_lock_.
+    bool Batching() const;
+    // Build an index object from the corresponding in-memory index. The
+    // caller must hold the lock for that index.
+    proto::StorageCredentials BuildCredentialIndex() const;
+    proto::StorageSeeds BuildSeedIndex() const;
+    void ClearPendingIndexes();
     void CollectGarbage();
     bool FindNym(const std::string& id, const bool checking, std::string& hash);
     bool FindNym(
@@ -223,44 +360,68 @@ private:
         const bool checking,
         const proto::StorageNym& nym,
         std::string& hash);
+    void FinishTraversal(StorageTraversal& traversal, const bool success);
+    // Writes the pending indices and commits them. On failure they stay
+    // pending and the in-memory root is restored. The caller must hold
+    // write_lock_.
+    bool FlushIndexes();
     bool LoadCredentialIndex(
         const std::string& hash,
-        std::shared_ptr<proto::CredentialIndex>& nym);
+        std::shared_ptr<const proto::CredentialIndex>& nym);
+    // Load every entry of a nym, server or unit index tree. nodes receives
+    // the hash of each node below the root, by path.
+    template<class T>
+    bool LoadIndex(
+        const std::string& hash,
+        const ItemHashList& (T::*list)() const,
+        std::vector<proto::StorageItemHash>& items,
+        std::map<std::string, std::string>& nodes,
+        const std::string& path = "");
     bool LoadNym(
         const std::string& hash,
-        std::shared_ptr<proto::StorageNym>& nym);
+        std::shared_ptr<const proto::StorageNym>& nym);
     bool LoadNymIndex(
         const std::string& hash,
-        std::shared_ptr<proto::StorageNymList>& index);
+        std::shared_ptr<const proto::StorageNymList>& index);
     bool LoadOrCreateBox(
         const proto::StorageNym& nym,
         const StorageBox& type,
-        std::shared_ptr<proto::StorageNymList>& box);
+        std::shared_ptr<const proto::StorageNymList>& box);
     bool LoadPeerReply(
         const std::string& id,
         const bool checking,
         const proto::StorageNymList& box,
-        std::shared_ptr<proto::PeerReply>& reply);
+        std::shared_ptr<const proto::PeerReply>& reply);
     bool LoadPeerRequest(
         const std::string& id,
         const bool checking,
         const proto::StorageNymList& box,
-        std::shared_ptr<proto::PeerRequest>& request);
+        std::shared_ptr<const proto::PeerRequest>& request);
     bool MigrateBox(const proto::StorageItemHash& box);
     bool MigrateKey(const std::string& key);
+    void RecordGCPause(const std::chrono::steady_clock::time_point& start);
     // Regenerate in-memory indices by recursively loading index objects
     // starting from the root hash
     void Read();
     bool RemoveItemFromBox(
         const std::string& id,
         proto::StorageNymList& box);
-    void RunMapPublicNyms(NymLambda lambda); // copy the lambda since original
-                                             // may destruct during execution
-    void RunMapServers(ServerLambda lambda); // copy the lambda since original
-                                             // may destruct during execution
-    void RunMapUnits(UnitLambda lambda);     // copy the lambda since original
-                                             // may destruct during execution
+    // Visit the items of a traversal until none are left. Runs on every
+    // worker the traversal fans out to.
+    void RunTraversal(
+        const std::shared_ptr<StorageTraversal>& traversal,
+        const ItemVisitor& visitor);
+    // Take a snapshot of a nym, server or unit index, then fan out over it
+    template<class T>
+    void StartTraversal(
+        const std::shared_ptr<StorageTraversal>& traversal,
+        const std::string& (proto::StorageItems::*index)() const,
+        const ItemHashList& (T::*list)() const,
+        const ItemVisitor& visitor);
     // Methods for updating index objects
+    // Write every index deferred by a write batch, followed by a single items
+    // object and root
+    bool UpdateIndexes();
     bool UpdateCredentials(const std::string& id, const std::string& hash);
     bool UpdateNymCreds(
         const std::string& id,
@@ -301,6 +462,23 @@ private:
         const std::string& alias);
     bool UpdateUnitAlias(const std::string& id, const std::string& alias);
     bool UpdateUnits(std::unique_lock<std::mutex>& unitlock);
+    // Write the changed nodes of a nym, server or unit index tree and build
+    // its root in output. lock must hold the lock for the index on entry, and
+    // is released once the tree has been written.
+    template<class T>
+    bool StoreIndex(
+        std::unique_lock<std::mutex>& lock,
+        const Index& index,
+        IndexTree& tree,
+        proto::StorageItemHash* (T::*add)(),
+        T& output);
+    template<class T>
+    bool StoreIndexNode(
+        const Index& index,
+        IndexTree& tree,
+        const std::string& path,
+        proto::StorageItemHash* (T::*add)(),
+        T& output);
     bool UpdateItems(const proto::StorageCredentials& creds);
     bool UpdateItems(const proto::StorageNymList& nyms);
     bool UpdateItems(const proto::StorageSeeds& seeds);
@@ -311,17 +489,68 @@ private:
     bool UpdateRoot();
     bool ValidateReplyBox(const StorageBox& type) const;
     bool ValidateRequestBox(const StorageBox& type) const;
+    // Checks an object read from the backend before it is used. Interior
+    // nodes of an index tree are checked here, since they are not a version
+    // of the index message that proto::Check knows.
+    template<class T>
+    static bool Verify(const T& data)
+    {
+        return proto::Check<T>(data, 0, 0xFFFFFFFF);
+    }
+    static bool Verify(const proto::StorageNymList& data);
+    static bool Verify(const proto::StorageServers& data);
+    static bool Verify(const proto::StorageUnits& data);
 
     void Cleanup_Storage();
 
 protected:
+    // Any number of threads may hold this lock shared, or one thread may
+    // hold it exclusively. A thread waiting for exclusive access stops new
+    // shared holders from entering, so it can not be starved.
+    class SharedMutex
+    {
+    private:
+        std::mutex lock_;
+        std::condition_variable signal_;
+        int readers_ = 0;
+        int writers_waiting_ = 0;
+        bool writer_ = false;
+
+    public:
+        void lock();
+        void unlock();
+        void lock_shared();
+        void unlock_shared();
+    };
+
+    class SharedGuard
+    {
+    private:
+        SharedMutex& mutex_;
+
+        SharedGuard() = delete;
+        SharedGuard(const SharedGuard&) = delete;
+        SharedGuard& operator=(const SharedGuard&) = delete;
+
+    public:
+        explicit SharedGuard(SharedMutex& mutex)
+            : mutex_(mutex)
+        {
+            mutex_.lock_shared();
+        }
+
+        ~SharedGuard() { mutex_.unlock_shared(); }
+    };
+
     const uint32_t HASH_TYPE = 2; // BTC160
     StorageConfig config_;
     Digest digest_;
     Random random_;
 
     std::mutex init_lock_; // controls access to Read() method
-    std::mutex bucket_lock_; // ensures buckets not changed during read
+    // Held shared by every read, and exclusively while the active bucket
+    // is switched
+    SharedMutex bucket_lock_;
     std::mutex cred_lock_; // ensures atomic writes to credentials_
     std::mutex default_seed_lock_; // ensures atomic writes to default_seed_
     std::mutex gc_lock_; // prevents multiple garbage collection threads
@@ -339,13 +568,34 @@ protected:
     std::atomic<bool> current_bucket_;
     std::atomic<bool> isLoaded_;
     std::atomic<bool> gc_running_;
+    // Set from the bucket switch until the new root has been written, while
+    // gc_running_ stays set until the old bucket has been emptied as well
+    std::atomic<bool> gc_migrating_;
     std::atomic<bool> gc_resume_;
+    std::atomic<bool> shutdown_;
+    // Traversals which have not finished yet. Collection does not start
+    // while there are any, so the objects in their snapshots stay in the
+    // backend until they are visited.
+    std::atomic<std::size_t> traversals_;
+    // Depth of the open write batch of each thread, guarded by write_lock_.
+    // Index updates made by those threads are recorded below instead of
+    // being written.
+    std::map<std::thread::id, int> write_batches_;
+    bool pending_creds_ = false;
+    bool pending_nyms_ = false;
+    bool pending_seeds_ = false;
+    bool pending_servers_ = false;
+    bool pending_units_ = false;
     int64_t last_gc_ = 0;
     Index credentials_;
     Index nyms_;
     Index seeds_;
     Index servers_;
     Index units_;
+    // Guarded by the lock of the corresponding index
+    IndexTree nym_tree_;
+    IndexTree server_tree_;
+    IndexTree unit_tree_;
 
     Storage(
         const StorageConfig& config,
@@ -366,6 +616,20 @@ protected:
         const std::string& value,
         const bool bucket) const = 0;
     virtual bool EmptyBucket(const bool bucket) = 0;
+    // Passes the stored value to reader and returns its result. Backends
+    // which can expose stored bytes in place override this to avoid copying
+    // them first.
+    virtual bool Load(
+        const std::string& key,
+        const bool bucket,
+        const RawReader& reader) const;
+
+    // Backends which can commit several writes at once override these. Every
+    // Store() and StoreRoot() made by the calling thread between BeginBatch()
+    // and the matching CommitBatch() is then written together, and Load()
+    // from that thread sees them before they are committed. Batches nest.
+    virtual bool BeginBatch() const { return true; }
+    virtual bool CommitBatch() const { return true; }
 
 public:
     // Method for instantiating the singleton.
@@ -375,62 +639,76 @@ public:
         const StorageConfig& config);
 
     ObjectList NymBoxList(const std::string& nymID, const StorageBox box);
+    uint64_t CacheHits() const { return cache_.Hits(); }
+    uint64_t CacheMisses() const { return cache_.Misses(); }
     std::string DefaultSeed();
+    StorageGCMetrics GCMetrics() const;
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::Credential>& cred,
+        std::shared_ptr<const proto::Credential>& cred,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::CredentialIndex>& nym,
+        std::shared_ptr<const proto::CredentialIndex>& nym,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::CredentialIndex>& nym,
+        std::shared_ptr<const proto::CredentialIndex>& nym,
         std::string& alias,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& nymID,
         const std::string& id,
         const StorageBox box,
-        std::shared_ptr<proto::PeerReply>& request,
+        std::shared_ptr<const proto::PeerReply>& request,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& nymID,
         const std::string& id,
         const StorageBox box,
-        std::shared_ptr<proto::PeerRequest>& request,
+        std::shared_ptr<const proto::PeerRequest>& request,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::Seed>& seed,
+        std::shared_ptr<const proto::Seed>& seed,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::Seed>& seed,
+        std::shared_ptr<const proto::Seed>& seed,
         std::string& alias,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::ServerContract>& contract,
+        std::shared_ptr<const proto::ServerContract>& contract,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::ServerContract>& contract,
+        std::shared_ptr<const proto::ServerContract>& contract,
         std::string& alias,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::UnitDefinition>& contract,
+        std::shared_ptr<const proto::UnitDefinition>& contract,
         const bool checking = false); // If true, suppress "not found" errors
     bool Load(
         const std::string& id,
-        std::shared_ptr<proto::UnitDefinition>& contract,
+        std::shared_ptr<const proto::UnitDefinition>& contract,
         std::string& alias,
         const bool checking = false); // If true, suppress "not found" errors
-    void MapPublicNyms(NymLambda& lambda);
-    void MapServers(ServerLambda& lambda);
-    void MapUnitDefinitions(UnitLambda& lambda);
+    // Apply a lambda to every public nym, server contract or unit definition
+    // in the database. The traversal works from a snapshot of the index taken
+    // when it starts, and objects are loaded in parallel on a shared pool of
+    // threads, but the lambda is only called by one thread at a time.
+    // Garbage collection does not start until the traversal is finished.
+    std::shared_ptr<StorageTraversal> MapPublicNyms(
+        NymLambda& lambda,
+        const TraversalCallback& done = nullptr);
+    std::shared_ptr<StorageTraversal> MapServers(
+        ServerLambda& lambda,
+        const TraversalCallback& done = nullptr);
+    std::shared_ptr<StorageTraversal> MapUnitDefinitions(
+        UnitLambda& lambda,
+        const TraversalCallback& done = nullptr);
     bool RemoveNymBoxItem(
         const std::string& nymID,
         const StorageBox box,
@@ -441,6 +719,17 @@ public:
     std::string ServerAlias(const std::string& id);
     ObjectList ServerList();
     bool SetDefaultSeed(const std::string& id);
+    // Objects stored between StartWriteBatch() and FinishWriteBatch() are
+    // written immediately, but the index objects, items object and root are
+    // written once when the outermost batch finishes instead of once per
+    // object. This turns a bulk import from quadratic to linear in the size
+    // of the indices. Each thread has its own batch, so writes from other
+    // threads are not held back, and garbage collection does not start
+    // while any batch is open. FinishWriteBatch() returns false if the
+    // indices could not be written. They are then written again by the next
+    // batch to finish or by the next collection.
+    void StartWriteBatch();
+    bool FinishWriteBatch();
     bool SetNymAlias(const std::string& id, const std::string& alias);
     bool SetSeedAlias(const std::string& id, const std::string& alias);
     bool SetServerAlias(const std::string& id, const std::string& alias);
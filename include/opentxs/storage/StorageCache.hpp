@@ -0,0 +1,121 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGECACHE_HPP
+#define OPENTXS_STORAGE_STORAGECACHE_HPP
+
+#include <google/protobuf/message_lite.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Each shard gets this share of the size limit and evicts on its own
+#define STORAGE_CACHE_SHARDS 16
+
+namespace opentxs
+{
+
+// Size bounded LRU cache of parsed and validated objects, keyed by the hash
+// they are stored under.
+//
+// Stored objects are content addressed, so a cached entry can never become
+// stale and entries are only ever evicted. The cache is split into shards,
+// each with its own lock and its own share of the size limit, so that
+// concurrent readers rarely contend.
+class StorageCache
+{
+public:
+    typedef std::shared_ptr<const ::google::protobuf::MessageLite> Object;
+
+    // A limit of zero disables the cache
+    explicit StorageCache(const std::size_t bytes);
+
+    // Returns nullptr if the hash is not cached
+    Object Get(const std::string& hash);
+    uint64_t Hits() const { return hits_.load(); }
+    uint64_t Misses() const { return misses_.load(); }
+    // size is the serialized size of the object, which is what the limit is
+    // measured in
+    void Put(
+        const std::string& hash,
+        const Object& object,
+        const std::size_t size);
+
+    ~StorageCache() = default;
+
+private:
+    class Entry
+    {
+    public:
+        std::string hash_;
+        Object object_;
+        std::size_t size_ = 0;
+    };
+
+    typedef std::list<Entry> Entries;
+
+    class Shard
+    {
+    public:
+        std::mutex lock_;
+        // most recently used first
+        Entries entries_;
+        std::map<std::string, Entries::iterator> index_;
+        std::size_t bytes_ = 0;
+    };
+
+    const std::size_t shard_limit_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+
+    Shard& GetShard(const std::string& hash);
+
+    StorageCache() = delete;
+    StorageCache(const StorageCache&) = delete;
+    StorageCache& operator=(const StorageCache&) = delete;
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGECACHE_HPP
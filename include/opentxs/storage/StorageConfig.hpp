@@ -54,6 +54,15 @@ public:
     bool auto_publish_servers_ = true;
     bool auto_publish_units_ = true;
     int64_t gc_interval_ = 60 * 60 * 1;
+    // Garbage collection pauses for gc_slice_pause_ milliseconds after
+    // migrating every gc_slice_keys_ objects, so that it does not starve
+    // other users of the database.
+    int64_t gc_slice_keys_ = 256;
+    int64_t gc_slice_pause_ = 10;
+    // Memory, in bytes of serialized data, used to cache loaded objects
+    int64_t cache_bytes_ = 32 * 1024 * 1024;
+    // Threads shared by nym, server and unit definition traversals
+    int64_t map_threads_ = 4;
     std::string path_;
     InsertCB dht_callback_;
 
@@ -70,6 +79,15 @@ public:
     std::string sqlite3_root_key_ = "a";
     std::string sqlite3_db_file_ = "opentxs.sqlite3";
 #endif
+
+#ifdef OT_STORAGE_LMDB
+    std::string lmdb_primary_bucket_ = "a";
+    std::string lmdb_secondary_bucket_ = "b";
+    std::string lmdb_control_table_ = "control";
+    std::string lmdb_root_key_ = "root";
+    // Upper bound on the size of the database
+    int64_t lmdb_map_size_ = 1024 * 1024 * 1024;
+#endif
 };
 
 }  // namespace opentxs
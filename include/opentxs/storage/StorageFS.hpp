@@ -41,12 +41,22 @@
 
 #include "opentxs/storage/Storage.hpp"
 
+#include <mutex>
+#include <set>
+#include <string>
+
 namespace opentxs
 {
 
 class StorageConfig;
 
 // Simple filesystem implementation of opentxs::storage
+//
+// Objects are stored in subdirectories of each bucket named after the last
+// two characters of their key, so that no directory grows too large. Every file
+// is written to a temporary name, synced and renamed into place. The
+// directories which received new entries are synced before the root file is
+// replaced, so the root never refers to an object which could be lost.
 class StorageFS : public Storage
 {
 private:
@@ -55,6 +65,11 @@ private:
     friend Storage;
 
     std::string folder_;
+    // Directories with renamed entries which have not been synced yet
+    mutable std::set<std::string> dirty_directories_;
+    // Shard directories known to exist
+    mutable std::set<std::string> shard_directories_;
+    mutable std::mutex directory_lock_;
 
     std::string GetBucketName(const bool bucket) const
     {
@@ -70,6 +85,18 @@ private:
     StorageFS(const StorageFS&) = delete;
     StorageFS& operator=(const StorageFS&) = delete;
 
+    // Location of an object in the current layout
+    std::string GetFilename(const std::string& key, const bool bucket) const;
+    // Location of an object in a bucket written before buckets were sharded
+    std::string GetFlatFilename(const std::string& key, const bool bucket)
+        const;
+    bool ReadFile(const std::string& filename, std::string& value) const;
+    bool SyncDirectories() const;
+    bool WriteFile(
+        const std::string& directory,
+        const std::string& filename,
+        const std::string& value) const;
+
     void Init_StorageFS();
     void Purge(const std::string& path);
 
@@ -0,0 +1,135 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGELMDB_HPP
+#define OPENTXS_STORAGE_STORAGELMDB_HPP
+
+#include "opentxs/storage/Storage.hpp"
+
+#include <lmdb.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace opentxs
+{
+
+class StorageConfig;
+
+// LMDB implementation of opentxs::storage
+//
+// Both buckets and the control table are named databases in a single
+// environment, so the root hash is committed atomically and emptying a
+// bucket is a single mdb_drop. Reads hand the memory mapped value straight
+// to the parser.
+class StorageLMDB : public Storage
+{
+private:
+    typedef Storage ot_super;
+
+    friend Storage;
+    friend class Test_StorageLMDB;
+
+    std::string folder_;
+    MDB_env* env_ = nullptr;
+    MDB_dbi primary_ = 0;
+    MDB_dbi secondary_ = 0;
+    MDB_dbi control_ = 0;
+    // Write transaction of the open batch. batch_lock_ is held by the owning
+    // thread for as long as the batch is open.
+    mutable MDB_txn* batch_ = nullptr;
+    mutable std::recursive_mutex batch_lock_;
+    mutable std::atomic<std::thread::id> batch_owner_;
+    mutable int batch_depth_ = 0;
+
+    MDB_dbi GetDatabase(const bool bucket) const
+    {
+        return bucket ? secondary_ : primary_;
+    }
+
+    StorageLMDB() = delete;
+    StorageLMDB(
+        const StorageConfig& config,
+        const Digest& hash,
+        const Random& random);
+    StorageLMDB(const StorageLMDB&) = delete;
+    StorageLMDB& operator=(const StorageLMDB&) = delete;
+
+    bool Get(
+        const MDB_dbi database,
+        const std::string& key,
+        const RawReader& reader) const;
+    bool Put(
+        const MDB_dbi database,
+        const std::string& key,
+        const std::string& value) const;
+
+    void Init_StorageLMDB();
+
+protected:
+    bool BeginBatch() const override;
+    bool CommitBatch() const override;
+
+public:
+    std::string LoadRoot() const override;
+    bool StoreRoot(const std::string& hash) override;
+    using ot_super::Load;
+    bool Load(
+        const std::string& key,
+        std::string& value,
+        const bool bucket) const override;
+    bool Load(
+        const std::string& key,
+        const bool bucket,
+        const RawReader& reader) const override;
+    using ot_super::Store;
+    bool Store(
+        const std::string& key,
+        const std::string& value,
+        const bool bucket) const override;
+    bool EmptyBucket(const bool bucket) override;
+
+    void Cleanup_StorageLMDB();
+    void Cleanup() override;
+    ~StorageLMDB();
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGELMDB_HPP
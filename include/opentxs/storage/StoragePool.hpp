@@ -0,0 +1,88 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGEPOOL_HPP
+#define OPENTXS_STORAGE_STORAGEPOOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace opentxs
+{
+
+// Fixed number of worker threads which run storage jobs in the order they
+// were queued. The threads are started by the first job, so that Storage
+// objects which never queue anything do not own idle threads.
+class StoragePool
+{
+public:
+    typedef std::function<void()> Job;
+
+    // At least one thread is always used
+    explicit StoragePool(const std::size_t threads);
+
+    // Jobs queued after Stop() run on the calling thread
+    void Run(const Job& job);
+    std::size_t Size() const { return size_; }
+    // Runs every job which is already queued, then joins the threads
+    void Stop();
+
+    ~StoragePool();
+
+private:
+    const std::size_t size_;
+    std::mutex lock_;
+    std::condition_variable signal_;
+    std::queue<Job> jobs_;
+    std::vector<std::thread> threads_;
+    bool stop_ = false;
+
+    void Worker();
+
+    StoragePool() = delete;
+    StoragePool(const StoragePool&) = delete;
+    StoragePool& operator=(const StoragePool&) = delete;
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGEPOOL_HPP
@@ -41,6 +41,13 @@
 
 #include "opentxs/storage/Storage.hpp"
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 extern "C"
 {
@@ -60,8 +67,26 @@ private:
 
     friend Storage;
 
+    // A database handle together with the statements which have been
+    // prepared on it, keyed by table name.
+    struct Connection
+    {
+        sqlite3* db_ = nullptr;
+        std::map<std::string, sqlite3_stmt*> select_;
+        std::map<std::string, sqlite3_stmt*> upsert_;
+    };
+
     std::string folder_;
-    sqlite3* db_ = nullptr;
+    // All writes go through this connection. The lock is held for the
+    // duration of a batch.
+    mutable Connection writer_;
+    mutable std::recursive_mutex writer_lock_;
+    // Idle read-only connections. Each query borrows one and hands it back
+    // afterwards, and at most OT_SQLITE3_IDLE_READERS are kept open.
+    mutable std::vector<std::unique_ptr<Connection>> readers_;
+    mutable std::mutex readers_lock_;
+    mutable std::atomic<std::thread::id> batch_owner_;
+    mutable int batch_depth_ = 0;
 
     std::string GetTableName(const bool bucket) const
     {
@@ -78,10 +103,28 @@ private:
     StorageSqlite3(const StorageSqlite3&) = delete;
     StorageSqlite3& operator=(const StorageSqlite3&) = delete;
 
+    static void Close(Connection& connection);
+    static void Forget(Connection& connection, const std::string& tablename);
+    static bool Open(
+        const std::string& filename,
+        const int flags,
+        Connection& connection);
+
+    std::unique_ptr<Connection> Borrow() const;
+    void GiveBack(std::unique_ptr<Connection>& reader) const;
+    sqlite3_stmt* Statement(
+        Connection& connection,
+        const bool upsert,
+        const std::string& tablename) const;
     bool Select(
         const std::string& key,
         const std::string& tablename,
         std::string& value) const;
+    bool Select(
+        Connection& connection,
+        const std::string& key,
+        const std::string& tablename,
+        std::string& value) const;
     bool Upsert(
         const std::string& key,
         const std::string& tablename,
@@ -91,6 +134,10 @@ private:
 
     void Init_StorageSqlite3();
 
+protected:
+    bool BeginBatch() const override;
+    bool CommitBatch() const override;
+
 public:
     std::string LoadRoot() const override;
     bool StoreRoot(const std::string& hash) override;
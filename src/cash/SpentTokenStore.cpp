@@ -0,0 +1,321 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/cash/SpentTokenStore.hpp"
+
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/OTStorage.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/util/OTFolders.hpp"
+#include "opentxs/core/util/OTPaths.hpp"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <string>
+
+namespace opentxs
+{
+
+SpentTokenStore& SpentTokenStore::It()
+{
+    static SpentTokenStore instance;
+
+    return instance;
+}
+
+SpentTokenStore::Series& SpentTokenStore::GetSeries(
+    const String& instrumentDefinitionID,
+    int32_t series)
+{
+    String strFolder;
+    strFolder.Format("%s.%d", instrumentDefinitionID.Get(), series);
+    const std::string folder(strFolder.Get());
+
+    std::lock_guard<std::mutex> lock(lock_);
+
+    std::unique_ptr<Series>& output = series_[folder];
+
+    if (!output) {
+        output.reset(new Series);
+        output->folder_ = folder;
+    }
+
+    return *output;
+}
+
+// Reads the hashes in the log of a series into memory. A record which was
+// only partly written when the server stopped is cut off the end of the log,
+// so that later records are appended to a readable log.
+bool SpentTokenStore::Load(Series& series)
+{
+    series.spent_.clear();
+
+    const std::string logName = series.folder_ + ".log";
+    std::string legacyFolder;
+
+    const int64_t lLength = OTDB::FormPathString(
+        series.log_, OTFolders::Spent().Get(), logName);
+
+    if ((0 > lLength) ||
+        (0 >
+         OTDB::FormPathString(
+             legacyFolder, OTFolders::Spent().Get(), series.folder_))) {
+        otErr << __FUNCTION__ << ": Error forming path for spent token log: "
+              << logName << "\n";
+        return false;
+    }
+
+    series.legacy_ = OTPaths::PathExists(String(legacyFolder + "/"));
+
+    bool bFolderCreated = false;
+
+    if (!OTPaths::BuildFilePath(String(series.log_), bFolderCreated)) {
+        otErr << __FUNCTION__ << ": Error creating folder for spent token "
+              << "log: " << series.log_ << "\n";
+        return false;
+    }
+
+    if (0 < lLength) {
+        std::ifstream file(series.log_, std::ios::in | std::ios::binary);
+
+        if (!file.good()) {
+            otErr << __FUNCTION__ << ": Error opening spent token log: "
+                  << series.log_ << "\n";
+            return false;
+        }
+
+        std::streamoff good = 0;
+        std::string header;
+
+        // Each record is "<token hash> <token size>\n<token>\n"
+        while (std::getline(file, header)) {
+            const std::size_t space = header.find(' ');
+
+            if ((std::string::npos == space) || (0 == space)) { break; }
+
+            const char* size = header.c_str() + space + 1;
+            char* end = nullptr;
+            const unsigned long long tokenSize = std::strtoull(size, &end, 10);
+
+            if ((size == end) || ('\0' != *end) ||
+                (static_cast<unsigned long long>(
+                     std::numeric_limits<std::streamsize>::max()) <=
+                 tokenSize)) {
+                break;
+            }
+
+            const std::streamsize expected =
+                static_cast<std::streamsize>(tokenSize);
+            file.ignore(expected);
+
+            if ((expected != file.gcount()) || ('\n' != file.get())) {
+                break;
+            }
+
+            series.spent_.insert(header.substr(0, space));
+            good = file.tellg();
+        }
+
+        const bool torn = !file.eof() || (good != lLength);
+        file.close();
+
+        if (torn) {
+            otErr << __FUNCTION__ << ": Discarding incomplete record at the "
+                  << "end of spent token log: " << series.log_ << "\n";
+#ifdef _WIN32
+            std::string contents(static_cast<std::size_t>(good), '\0');
+            std::ifstream in(series.log_, std::ios::in | std::ios::binary);
+            in.read(&contents[0], good);
+            const bool read = (good == in.gcount());
+            in.close();
+            std::ofstream out(
+                series.log_,
+                std::ios::out | std::ios::trunc | std::ios::binary);
+            out.write(contents.c_str(), contents.size());
+            out.close();
+
+            if (!read || out.fail()) {
+#else
+            if (0 != ::truncate(series.log_.c_str(), good)) {
+#endif
+                otErr << __FUNCTION__ << ": Error repairing spent token "
+                      << "log: " << series.log_ << "\n";
+                return false;
+            }
+        }
+    }
+
+    series.loaded_ = true;
+
+    return true;
+}
+
+bool SpentTokenStore::Append(
+    Series& series,
+    const std::string& tokenHash,
+    const std::string& token)
+{
+    const std::string record = tokenHash + " " +
+                               std::to_string(token.size()) + "\n" + token +
+                               "\n";
+    bool success = true;
+
+#ifdef _WIN32
+    std::ofstream file(
+        series.log_, std::ios::out | std::ios::app | std::ios::binary);
+    file.write(record.c_str(), record.size());
+    file.close();
+    success = !file.fail();
+#else
+    const bool exists = (0 == ::access(series.log_.c_str(), F_OK));
+    const int fd =
+        ::open(series.log_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    if (-1 == fd) { return false; }
+
+    const char* position = record.data();
+    std::size_t remaining = record.size();
+
+    while (0 < remaining) {
+        const ssize_t written = ::write(fd, position, remaining);
+
+        if (0 > written) {
+            if (EINTR == errno) { continue; }
+
+            success = false;
+            break;
+        }
+
+        position += written;
+        remaining -= written;
+    }
+
+    success = (0 == ::fsync(fd)) && success;
+    success = (0 == ::close(fd)) && success;
+
+    // A new log is only durable once the spent folder is synced as well
+    if (success && !exists) {
+        const std::size_t slash = series.log_.find_last_of('/');
+
+        if (std::string::npos != slash) {
+            const std::string folder = series.log_.substr(0, slash);
+            const int dir = ::open(folder.c_str(), O_RDONLY);
+            success = (-1 != dir) && (0 == ::fsync(dir));
+
+            if (-1 != dir) { ::close(dir); }
+        }
+    }
+#endif
+
+    // Part of the record may have been written. Reading the log again before
+    // the next append cuts it off.
+    if (!success) { series.loaded_ = false; }
+
+    return success;
+}
+
+bool SpentTokenStore::IsSpent(Series& series, const std::string& tokenHash)
+{
+    if (1 == series.spent_.count(tokenHash)) { return true; }
+
+    if (series.legacy_) {
+        return OTDB::Exists(
+            OTFolders::Spent().Get(), series.folder_, tokenHash);
+    }
+
+    return false;
+}
+
+bool SpentTokenStore::IsSpent(
+    const String& instrumentDefinitionID,
+    int32_t series,
+    const String& tokenHash)
+{
+    Series& tokens = GetSeries(instrumentDefinitionID, series);
+    std::lock_guard<std::mutex> lock(tokens.lock_);
+
+    if (!tokens.loaded_ && !Load(tokens)) { return true; }
+
+    return IsSpent(tokens, tokenHash.Get());
+}
+
+bool SpentTokenStore::RecordSpent(
+    const String& instrumentDefinitionID,
+    int32_t series,
+    const String& tokenHash,
+    const String& token)
+{
+    const std::string hash(tokenHash.Get());
+
+    if (hash.empty() || (std::string::npos != hash.find_first_of(" \n"))) {
+        otErr << __FUNCTION__ << ": Invalid token hash: " << hash << "\n";
+        return false;
+    }
+
+    Series& tokens = GetSeries(instrumentDefinitionID, series);
+    std::lock_guard<std::mutex> lock(tokens.lock_);
+
+    if (!tokens.loaded_ && !Load(tokens)) { return false; }
+
+    if (IsSpent(tokens, hash)) {
+        otErr << __FUNCTION__ << ": Token was already recorded as spent: "
+              << tokens.folder_ << Log::PathSeparator() << hash << "\n";
+        return false;
+    }
+
+    if (!Append(tokens, hash, token.Get())) {
+        otErr << __FUNCTION__ << ": Error writing spent token log: "
+              << tokens.log_ << "\n";
+        return false;
+    }
+
+    tokens.spent_.insert(hash);
+
+    return true;
+}
+
+}  // namespace opentxs
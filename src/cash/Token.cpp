@@ -40,6 +40,7 @@
 
 #include "opentxs/cash/Mint.hpp"
 #include "opentxs/cash/Purse.hpp"
+#include "opentxs/cash/SpentTokenStore.hpp"
 #if defined(OT_CASH_USING_LUCRE)
 #include "opentxs/cash/TokenLucre.hpp"
 #endif
@@ -48,7 +49,6 @@
 #include "opentxs/core/Instrument.hpp"
 #include "opentxs/core/Log.hpp"
 #include "opentxs/core/Nym.hpp"
-#include "opentxs/core/OTStorage.hpp"
 #include "opentxs/core/OTStringXML.hpp"
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
@@ -56,7 +56,6 @@
 #include "opentxs/core/crypto/OTNymOrSymmetricKey.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/Common.hpp"
-#include "opentxs/core/util/OTFolders.hpp"
 #include "opentxs/core/util/Tag.hpp"
 
 #include <irrxml/irrXML.hpp>
@@ -477,16 +476,12 @@ bool Token::IsTokenAlreadySpent(String& theCleartextToken)
     // Grab the new hash into a string (for use as a filename)
     String strTokenHash(theTokenHash);
 
-    String strAssetFolder;
-    strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
-                          GetSeries());
-
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
+    bool bTokenIsPresent = SpentTokenStore::It().IsSpent(
+        strInstrumentDefinitionID, GetSeries(), strTokenHash);
 
     if (bTokenIsPresent) {
         otOut << "\nToken::IsTokenAlreadySpent: Token was already spent: "
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
+              << strInstrumentDefinitionID << "." << GetSeries()
               << Log::PathSeparator() << strTokenHash << "\n";
         return true; // all errors must return true in this function.
                      // But this is not an error. Token really WAS already
@@ -500,6 +495,10 @@ bool Token::IsTokenAlreadySpent(String& theCleartextToken)
     return false;
 }
 
+// Fails if the token was already recorded, even if IsTokenAlreadySpent said
+// otherwise a moment ago, since another deposit of the same token may have
+// been recorded in between.
+//
 bool Token::RecordTokenAsSpent(String& theCleartextToken)
 {
     String strInstrumentDefinitionID(GetInstrumentDefinitionID());
@@ -511,27 +510,8 @@ bool Token::RecordTokenAsSpent(String& theCleartextToken)
     // Grab the new hash into a string (for use as a filename)
     String strTokenHash(theTokenHash);
 
-    String strAssetFolder;
-    strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
-                          GetSeries());
-
-    // See if the spent token file ALREADY EXISTS...
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
-
-    // If so, we're trying to record a token that was already recorded...
-    if (bTokenIsPresent) {
-        otErr << "Token::RecordTokenAsSpent: Trying to record token as spent,"
-                 " but it was already recorded: " << OTFolders::Spent()
-              << Log::PathSeparator() << strAssetFolder << Log::PathSeparator()
-              << strTokenHash << "\n";
-        return false;
-    }
-
-    // FINISHED:
-    //
-    // We actually save the token itself into the file, which is named based
-    // on a hash of the Lucre data.
+    // We actually save the token itself into the spent token log, under a
+    // hash of the Lucre data.
     // The success of that operation is also now the success of this one.
 
     String strFinal;
@@ -541,17 +521,17 @@ bool Token::RecordTokenAsSpent(String& theCleartextToken)
         ascTemp.WriteArmoredString(strFinal, m_strContractType.Get())) {
         otErr << "Token::RecordTokenAsSpent: Error recording token as "
                  "spent (failed writing armored string):\n"
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
+              << strInstrumentDefinitionID << "." << GetSeries()
               << Log::PathSeparator() << strTokenHash << "\n";
         return false;
     }
 
-    const bool bSaved =
-        OTDB::StorePlainString(strFinal.Get(), OTFolders::Spent().Get(),
-                               strAssetFolder.Get(), strTokenHash.Get());
+    const bool bSaved = SpentTokenStore::It().RecordSpent(
+        strInstrumentDefinitionID, GetSeries(), strTokenHash, strFinal);
+
     if (!bSaved) {
-        otErr << "Token::RecordTokenAsSpent: Error saving file: "
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
+        otErr << "Token::RecordTokenAsSpent: Error recording token as "
+                 "spent: " << strInstrumentDefinitionID << "." << GetSeries()
               << Log::PathSeparator() << strTokenHash << "\n";
     }
 
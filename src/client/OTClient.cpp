@@ -939,9 +939,8 @@ bool OTClient::AcceptEntireNymbox(Ledger& theNymbox,
             // numbers, so I can add them to my Nym and them remove them again
             // after generating the statement.
             //
-            for (int32_t i = 0; i < theIssuedNym.GetIssuedNumCount(theNotaryID);
-                 i++) {
-                int64_t lTemp = theIssuedNym.GetIssuedNum(theNotaryID, i);
+            for (const int64_t& lTemp :
+                 theIssuedNym.GetIssuedNums(theNotaryID)) {
                 // We know it's not already issued on the Nym, or it wouldn't
                 // have even gotten
                 // set inside theIssuedNym in the first place (further up
@@ -966,9 +965,8 @@ bool OTClient::AcceptEntireNymbox(Ledger& theNymbox,
             // real.
             //
             bool bAddedTentative = false;
-            for (int32_t i = 0; i < theIssuedNym.GetIssuedNumCount(theNotaryID);
-                 i++) {
-                int64_t lTemp = theIssuedNym.GetIssuedNum(theNotaryID, i);
+            for (const int64_t& lTemp :
+                 theIssuedNym.GetIssuedNums(theNotaryID)) {
                 pNym->RemoveIssuedNum(strNotaryID, lTemp);
                 pNym->AddTentativeNum(strNotaryID,
                                       lTemp); // So when I see the success
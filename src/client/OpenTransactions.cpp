@@ -8373,7 +8373,7 @@ bool OT_API::IsBasketCurrency(const Identifier& BASKET_INSTRUMENT_DEFINITION_ID)
 {
     String contractID(BASKET_INSTRUMENT_DEFINITION_ID);
 
-    std::shared_ptr<proto::UnitDefinition> contract;
+    std::shared_ptr<const proto::UnitDefinition> contract;
 
     bool loaded = App::Me().DB().Load(contractID.Get(), contract, true);
 
@@ -8393,7 +8393,7 @@ int32_t OT_API::GetBasketMemberCount(
     const Identifier& BASKET_INSTRUMENT_DEFINITION_ID) const
 {
     String contractID(BASKET_INSTRUMENT_DEFINITION_ID);
-    std::shared_ptr<proto::UnitDefinition> serialized;
+    std::shared_ptr<const proto::UnitDefinition> serialized;
     App::Me().DB().Load(contractID.Get(), serialized, true);
 
     if (!serialized) {
@@ -8419,7 +8419,7 @@ bool OT_API::GetBasketMemberType(
     Identifier& theOutputMemberType) const
 {
     String contractID(BASKET_INSTRUMENT_DEFINITION_ID);
-    std::shared_ptr<proto::UnitDefinition> serialized;
+    std::shared_ptr<const proto::UnitDefinition> serialized;
     App::Me().DB().Load(contractID.Get(), serialized, true);
 
     if (!serialized) {
@@ -8454,7 +8454,7 @@ int64_t OT_API::GetBasketMemberMinimumTransferAmount(
     int32_t nIndex) const
 {
     String contractID(BASKET_INSTRUMENT_DEFINITION_ID);
-    std::shared_ptr<proto::UnitDefinition> serialized;
+    std::shared_ptr<const proto::UnitDefinition> serialized;
     App::Me().DB().Load(contractID.Get(), serialized, true);
 
     if (!serialized) {
@@ -8483,7 +8483,7 @@ int64_t OT_API::GetBasketMinimumTransferAmount(
     const Identifier& BASKET_INSTRUMENT_DEFINITION_ID) const
 {
     String contractID(BASKET_INSTRUMENT_DEFINITION_ID);
-    std::shared_ptr<proto::UnitDefinition> serialized;
+    std::shared_ptr<const proto::UnitDefinition> serialized;
     App::Me().DB().Load(contractID.Get(), serialized, true);
 
     if (!serialized) {
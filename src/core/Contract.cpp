@@ -54,9 +54,12 @@
 #include "opentxs/core/crypto/OTSignatureMetadata.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/OTFolders.hpp"
+#include "opentxs/core/util/RawLineReader.hpp"
 #include "opentxs/core/util/Tag.hpp"
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
 #include <irrxml/irrXML.hpp>
@@ -1176,12 +1179,37 @@ bool Contract::LoadContractFromString(const String& theStr)
     return bSuccess;
 }
 
+namespace
+{
+
+bool IsTrimmable(char c)
+{
+    return (' ' == c) || ('\t' == c) || ('\f' == c) || ('\v' == c) ||
+           ('\n' == c) || ('\r' == c);
+}
+
+bool LineStartsWith(const char* pLine, std::size_t lLength,
+                    const char* szPrefix)
+{
+    const std::size_t lPrefix = std::strlen(szPrefix);
+
+    return (lLength >= lPrefix) && (0 == std::memcmp(pLine, szPrefix, lPrefix));
+}
+
+bool LineContains(const char* pLine, std::size_t lLength, const char* szText)
+{
+    const char* pEnd = pLine + lLength;
+
+    return std::search(pLine, pEnd, szText, szText + std::strlen(szText)) !=
+           pEnd;
+}
+
+} // namespace
+
 bool Contract::ParseRawFile()
 {
-    char buffer1[2100];  // a bit bigger than 2048, just for safety reasons.
     OTSignature* pSig = nullptr;
-
-    std::string line;
+    std::string strSig;
 
     bool bSignatureMode = false;           // "currently in signature mode"
     bool bContentMode = false;             // "currently in content mode"
@@ -1194,38 +1222,56 @@ bool Contract::ParseRawFile()
         return false;
     }
 
-    // This is redundant (I thought) but the problem hasn't cleared up yet.. so
-    // trying to really nail it now.
-    std::string str_Trim(m_strRawFile.Get());
-    std::string str_Trim2 = String::trim(str_Trim);
-    m_strRawFile.Set(str_Trim2.c_str());
+    // Trim the raw file in place. It's only copied if there was actually
+    // whitespace to remove.
+    {
+        const char* szRaw = m_strRawFile.Get();
+        const std::size_t lRawLength =
+            String::safe_strlen(szRaw, m_strRawFile.GetLength());
+        std::size_t lFirst = 0, lLast = lRawLength;
+
+        while ((lFirst < lRawLength) && IsTrimmable(szRaw[lFirst])) ++lFirst;
+
+        if (lFirst < lRawLength) {
+            while (IsTrimmable(szRaw[lLast - 1])) --lLast;
+        } else
+            lFirst = 0;  // Nothing but whitespace. Leave it alone.
+
+        if ((lFirst > 0) || (lLast < m_strRawFile.GetLength())) {
+            const std::string strTrimmed(szRaw + lFirst, lLast - lFirst);
+            m_strRawFile.Set(strTrimmed.c_str());
+        }
+    }
 
-    bool bIsEOF = false;
     m_strRawFile.reset();
 
-    do {
-        // Just a fresh start at the top of the loop block... probably
-        // unnecessary.
-        memset(
-            buffer1, 0, 2100);  // todo remove this in optimization. (might be
-                                // removed already...)
+    // The unsigned XML is collected here and handed to m_xmlUnsigned in one
+    // go, instead of growing it one line at a time.
+    std::string strUnsigned;
+    strUnsigned.reserve(m_strRawFile.GetLength());
+
+    if (m_xmlUnsigned.Exists()) strUnsigned.append(m_xmlUnsigned.Get());
+
+    RawLineReader theReader(m_strRawFile.Get(), m_strRawFile.GetLength());
+    const char* pLine = nullptr;
+    std::size_t lLength = 0;
+    bool bIsEOF = false;
 
+    do {
         // the call returns true if there's more to read, and false if there
         // isn't.
-        bIsEOF = !(m_strRawFile.sgets(buffer1, 2048));
-
-        line = buffer1;
-        const char* pBuf = line.c_str();
+        bIsEOF = !theReader.Next(pLine, lLength);
 
-        if (line.length() < 2) {
+        if (lLength < 2) {
             if (bSignatureMode) continue;
         }
 
         // if we're on a dashed line...
-        else if (line.at(0) == '-') {
+        else if (pLine[0] == '-') {
             if (bSignatureMode) {
                 // we just reached the end of a signature
-                //    otErr << "%s\n", pSig->Get());
+                pSig->Set(strSig.c_str());
+                strSig.clear();
                 pSig = nullptr;
                 bSignatureMode = false;
                 continue;
@@ -1238,32 +1284,19 @@ bool Contract::ParseRawFile()
             // a. I have not yet even entered content mode, and just now
             // entering it for the first time.
             if (!bHaveEnteredContentMode) {
-                if ((line.length() > 3) &&
-                    (line.find("BEGIN") != std::string::npos) &&
-                    line.at(1) == '-' && line.at(2) == '-' &&
-                    line.at(3) == '-') {
-                    //                    otErr << "\nProcessing contract...
-                    // \n";
+                if ((lLength > 3) && LineContains(pLine, lLength, "BEGIN") &&
+                    pLine[1] == '-' && pLine[2] == '-' && pLine[3] == '-') {
                     bHaveEnteredContentMode = true;
                     bContentMode = true;
-                    continue;
-                } else {
-                    continue;
                 }
 
+                continue;
             }
 
             // b. I am now entering signature mode!
             else if (
-                line.length() > 3 &&
-                line.find("SIGNATURE") != std::string::npos &&
-                line.at(1) == '-' && line.at(2) == '-' && line.at(3) == '-') {
-                // if (bContentMode)
-                //    otLog3 << "Finished reading contract.\n\nReading a
-                // signature at the bottom of the contract...\n");
-                // else
-                //    otLog3 << "Reading another signature...\n");
-
+                lLength > 3 && LineContains(pLine, lLength, "SIGNATURE") &&
+                pLine[1] == '-' && pLine[2] == '-' && pLine[3] == '-') {
                 bSignatureMode = true;
                 bContentMode = false;
 
@@ -1280,8 +1313,7 @@ bool Contract::ParseRawFile()
                 continue;
             }
             // c. There is an error in the file!
-            else if (
-                line.length() < 3 || line.at(1) != ' ' || line.at(2) != '-') {
+            else if (lLength < 3 || pLine[1] != ' ' || pLine[2] != '-') {
                 otOut
                     << "Error in contract " << m_strFilename
                     << ": a dash at the beginning of the "
@@ -1289,34 +1321,18 @@ bool Contract::ParseRawFile()
                     << m_strRawFile << "\n";
                 return false;
             }
-            // d. It is an escaped dash, and therefore kosher, so I merely
-            // remove the escape and add it.
-            // I've decided not to remove the dashes but to keep them as part of
-            // the signed content.
-            // It's just much easier to deal with that way. The input code will
-            // insert the extra dashes.
-            // pBuf += 2;
+            // d. It is an escaped dash, and therefore kosher. The escape is
+            // kept as part of the signed content.
         }
 
         // Else we're on a normal line, not a dashed line.
         else {
             if (bHaveEnteredContentMode) {
                 if (bSignatureMode) {
-                    if (line.length() < 2) {
-                        otLog3 << "Skipping short line...\n";
-
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
-                            otOut << "Error in signature for contract "
-                                  << m_strFilename
-                                  << ": Unexpected EOF after short line.\n";
-                            return false;
-                        }
-
-                        continue;
-                    } else if (line.compare(0, 8, "Version:") == 0) {
+                    if (LineStartsWith(pLine, lLength, "Version:")) {
                         otLog3 << "Skipping version section...\n";
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !theReader.Next(pLine, lLength)) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Version:\"\n";
@@ -1324,10 +1340,10 @@ bool Contract::ParseRawFile()
                         }
 
                         continue;
-                    } else if (line.compare(0, 8, "Comment:") == 0) {
+                    } else if (LineStartsWith(pLine, lLength, "Comment:")) {
                         otLog3 << "Skipping comment section...\n";
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !theReader.Next(pLine, lLength)) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Comment:\"\n";
@@ -1336,11 +1352,11 @@ bool Contract::ParseRawFile()
 
                         continue;
                     }
-                    if (line.compare(0, 5, "Meta:") == 0) {
+                    if (LineStartsWith(pLine, lLength, "Meta:")) {
                         otLog3 << "Collecting signature metadata...\n";
 
-                        if (line.length() != 13)  // "Meta:    knms" (It will
-                                                  // always be exactly 13
+                        if (lLength != 13)  // "Meta:    knms" (It will
+                                            // always be exactly 13
                         // characters int64_t.) knms represents the
                         // first characters of the Key type, NymID,
                         // Master Cred ID, and ChildCred ID. Key type is
@@ -1355,20 +1371,20 @@ bool Contract::ParseRawFile()
                         OT_ASSERT(nullptr != pSig);
                         if (false ==
                             pSig->getMetaData().SetMetadata(
-                                line.at(9),
-                                line.at(10),
-                                line.at(11),
-                                line.at(12)))  // "knms" from "Meta:    knms"
+                                pLine[9],
+                                pLine[10],
+                                pLine[11],
+                                pLine[12]))  // "knms" from "Meta:    knms"
                         {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected metadata in the \"Meta:\" "
                                      "comment.\nLine: "
-                                  << line << "\n";
+                                  << std::string(pLine, lLength) << "\n";
                             return false;
                         }
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !theReader.Next(pLine, lLength)) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Meta:\"\n";
@@ -1379,18 +1395,18 @@ bool Contract::ParseRawFile()
                     }
                 }
                 if (bContentMode) {
-                    if (line.compare(0, 6, "Hash: ") == 0) {
+                    if (LineStartsWith(pLine, lLength, "Hash: ")) {
                         otLog3 << "Collecting message digest algorithm from "
                                   "contract header...\n";
 
-                        std::string strTemp = line.substr(6);
-                        String strHashType = strTemp.c_str();
+                        String strHashType =
+                            std::string(pLine + 6, lLength - 6).c_str();
                         strHashType.ConvertToUpperCase();
 
                         m_strSigHashType =
                             CryptoHash::StringToHashType(strHashType);
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !theReader.Next(pLine, lLength)) {
                             otOut << "Error in contract " << m_strFilename
                                   << ": Unexpected EOF after \"Hash:\"\n";
                             return false;
@@ -1409,11 +1425,18 @@ bool Contract::ParseRawFile()
                 "processing signature, in "
                 "Contract::ParseRawFile");
 
-            pSig->Concatenate("%s\n", pBuf);
-        } else if (bContentMode)
-            m_xmlUnsigned.Concatenate("%s\n", pBuf);
+            strSig.append(pLine, lLength);
+            strSig.push_back('\n');
+        } else if (bContentMode) {
+            strUnsigned.append(pLine, lLength);
+            strUnsigned.push_back('\n');
+        }
     } while (!bIsEOF);
 
+    if (nullptr != pSig) pSig->Set(strSig.c_str());
+
+    m_xmlUnsigned.Set(strUnsigned.c_str());
+
     if (!bHaveEnteredContentMode) {
         otErr << "Error in Contract::ParseRawFile: Found no BEGIN for signed "
                  "content.\n";
@@ -52,6 +52,11 @@
 #include "opentxs/core/OTData.hpp"
 #include "opentxs/core/String.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+
 namespace opentxs
 {
 
@@ -84,6 +89,9 @@ Identifier::Identifier(const Identifier& theID)
     : OTData(theID)
     , type_(theID.Type())
 {
+    std::lock_guard<std::mutex> lock(theID.cache_lock_);
+    cached_raw_ = theID.cached_raw_;
+    cached_string_ = theID.cached_string_;
 }
 
 Identifier::Identifier(const std::string& theStr)
@@ -133,46 +141,83 @@ Identifier::Identifier(const OTCachedKey& theKey)
                          // would not happen, before constructing like this.)
 }
 
+void Identifier::swap(Identifier& rhs)
+{
+    if (&rhs == this) { return; }
+
+    std::lock(cache_lock_, rhs.cache_lock_);
+    std::lock_guard<std::mutex> lock(cache_lock_, std::adopt_lock);
+    std::lock_guard<std::mutex> rhsLock(rhs.cache_lock_, std::adopt_lock);
+    OTData::swap(rhs);
+    std::swap(type_, rhs.type_);
+    cached_raw_.swap(rhs.cached_raw_);
+    cached_string_.swap(rhs.cached_string_);
+}
+
 Identifier& Identifier::operator=(Identifier rhs)
 {
     swap(rhs);
     return *this;
 }
 
+// The type byte followed by the digest: the exact input to the encoded form.
+std::string Identifier::raw() const
+{
+    std::string output(1, static_cast<char>(type_));
+    output.append(static_cast<const char*>(GetPointer()), GetSize());
+
+    return output;
+}
+
+int Identifier::compare(const Identifier& rhs) const
+{
+    if (type_ != rhs.type_) {
+        return (static_cast<uint8_t>(type_) < static_cast<uint8_t>(rhs.type_))
+                   ? -1
+                   : 1;
+    }
+
+    const uint32_t size = std::min(GetSize(), rhs.GetSize());
+
+    if (0 < size) {
+        const int result = std::memcmp(GetPointer(), rhs.GetPointer(), size);
+
+        if (0 != result) { return result; }
+    }
+
+    if (GetSize() == rhs.GetSize()) { return 0; }
+
+    return (GetSize() < rhs.GetSize()) ? -1 : 1;
+}
+
 bool Identifier::operator==(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return ots1.Compare(ots2);
+    return 0 == compare(s2);
 }
 
 bool Identifier::operator!=(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return !(ots1.Compare(ots2));
+    return 0 != compare(s2);
 }
 
 bool Identifier::operator>(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return ots1.operator>(ots2);
+    return 0 < compare(s2);
 }
 
 bool Identifier::operator<(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return ots1.operator<(ots2);
+    return 0 > compare(s2);
 }
 
 bool Identifier::operator<=(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return ots1.operator<=(ots2);
+    return 0 >= compare(s2);
 }
 
 bool Identifier::operator>=(const Identifier& s2) const
 {
-    const String ots1(*this), ots2(s2);
-    return ots1.operator>=(ots2);
+    return 0 <= compare(s2);
 }
 
 bool Identifier::CalculateDigest(const String& strInput, const ID type)
@@ -238,16 +283,37 @@ void Identifier::SetString(const std::string& encoded)
 // Just call this function.
 void Identifier::GetString(String& id) const
 {
-    OTData data;
-    data.Assign(&type_, sizeof(type_));
-
-    OT_ASSERT(1 == data.GetSize());
+    const std::string input = raw();
+    std::lock_guard<std::mutex> lock(cache_lock_);
 
-    data.Concatenate(GetPointer(), GetSize());
+    if (input != cached_raw_) {
+        cached_string_ =
+            "ot" + App::Me().Crypto().Util().Base58CheckEncode(input);
+        cached_raw_ = input;
+    }
 
-    String output("ot");
-    output.Concatenate(
-        String(App::Me().Crypto().Util().Base58CheckEncode(data)));
+    String output(cached_string_);
     id.swap(output);
 }
 } // namespace opentxs
+
+namespace std
+{
+size_t hash<opentxs::Identifier>::operator()(
+    const opentxs::Identifier& id) const
+{
+    // The digest is already uniformly distributed, so its leading bytes
+    // make a good hash.
+    size_t output = static_cast<size_t>(id.Type());
+    const size_t size =
+        std::min(static_cast<size_t>(id.GetSize()), sizeof(output));
+
+    if (0 < size) {
+        size_t digest = 0;
+        std::memcpy(&digest, id.GetPointer(), size);
+        output ^= digest;
+    }
+
+    return output;
+}
+} // namespace std
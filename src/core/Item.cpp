@@ -206,15 +206,13 @@ bool Item::VerifyTransactionStatement(Nym& THE_NYM,
     //
     if (bIsRealTransaction) {
         switch (TARGET_TRANSACTION.GetType()) {
-        case OTTransaction::cancelCronItem:
+        case OTTransaction::cancelCronItem: {
             // Should only actually iterate once, in this case.
-            for (int32_t i = 0;
-                 i < theRemovedNym.GetIssuedNumCount(GetPurportedNotaryID());
-                 i++) {
-                int64_t lTemp =
-                    theRemovedNym.GetIssuedNum(GetPurportedNotaryID(), i);
+            int32_t i = 0;
 
-                if (i > 0)
+            for (const int64_t& lTemp :
+                 theRemovedNym.GetIssuedNums(GetPurportedNotaryID())) {
+                if (0 < i++)
                     otErr << "OTItem::VerifyTransactionStatement: THIS SHOULD "
                              "NOT HAPPEN.\n";
                 else if (false ==
@@ -224,6 +222,7 @@ bool Item::VerifyTransactionStatement(Nym& THE_NYM,
                              "OTItem::VerifyTransactionStatement.\n";
             }
             break;
+        }
 
         case OTTransaction::marketOffer:
         case OTTransaction::paymentPlan:
@@ -754,14 +753,14 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
     //
     for (auto& it : THE_NYM.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
+        OT_ASSERT(nullptr != pNumbers);
 
         const Identifier theNotaryID(strNotaryID);
 
-        if (!(pDeque->empty()) && (theNotaryID == GetPurportedNotaryID())) {
+        if (!(pNumbers->empty()) && (theNotaryID == GetPurportedNotaryID())) {
             nNumberOfTransactionNumbers1 +=
-                static_cast<int32_t>(pDeque->size());
+                static_cast<int32_t>(pNumbers->size());
             break; // There's only one, in this loop, that would/could/should
                    // match. (Therefore, break after finding it.)
         }
@@ -777,18 +776,18 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
         theMessageNym.LoadNymFromString(strMessageNym)) {
         for (auto& it : theMessageNym.GetMapIssuedNum()) {
             std::string strNotaryID = it.first;
-            dequeOfTransNums* pDeque = it.second;
-            OT_ASSERT(nullptr != pDeque);
+            NumberSet* pNumbers = it.second;
+            OT_ASSERT(nullptr != pNumbers);
 
             const Identifier theNotaryID(strNotaryID);
             const String OTstrNotaryID(theNotaryID);
 
-            if (!(pDeque->empty()) && (theNotaryID == GetPurportedNotaryID())) {
+            if (!(pNumbers->empty()) &&
+                (theNotaryID == GetPurportedNotaryID())) {
                 nNumberOfTransactionNumbers2 +=
-                    static_cast<int32_t>(pDeque->size());
+                    static_cast<int32_t>(pNumbers->size());
 
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    int64_t lTransactionNumber = pDeque->at(i);
+                for (const int64_t lTransactionNumber : *pNumbers) {
                     if (false ==
                         THE_NYM.VerifyIssuedNum(OTstrNotaryID,
                                                 lTransactionNumber)) // FAILURE
@@ -804,16 +803,14 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
                         case OTTransaction::deposit:
                         case OTTransaction::payDividend:
                         case OTTransaction::cancelCronItem:
-                        case OTTransaction::exchangeBasket:
+                        case OTTransaction::exchangeBasket: {
                             // Should only actually iterate once, in this case.
-                            for (int32_t j = 0;
-                                 j < theRemovedNym.GetIssuedNumCount(
-                                         GetPurportedNotaryID());
-                                 j++) {
-                                int64_t lTemp = theRemovedNym.GetIssuedNum(
-                                    GetPurportedNotaryID(), j);
-
-                                if (j > 0)
+                            int32_t j = 0;
+
+                            for (const int64_t& lTemp :
+                                 theRemovedNym.GetIssuedNums(
+                                     GetPurportedNotaryID())) {
+                                if (0 < j++)
                                     otErr << "OTItem::" << __FUNCTION__
                                           << ": THIS SHOULD NOT HAPPEN.\n";
                                 else if (false ==
@@ -824,6 +821,7 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
                                              "back to THE_NYM.\n";
                             }
                             break;
+                        }
 
                         case OTTransaction::transfer:
                         case OTTransaction::marketOffer:
@@ -861,15 +859,13 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
         case OTTransaction::deposit:
         case OTTransaction::payDividend:
         case OTTransaction::cancelCronItem:
-        case OTTransaction::exchangeBasket:
+        case OTTransaction::exchangeBasket: {
             // Should only actually iterate once, in this case.
-            for (int32_t i = 0;
-                 i < theRemovedNym.GetIssuedNumCount(GetPurportedNotaryID());
-                 i++) {
-                int64_t lTemp =
-                    theRemovedNym.GetIssuedNum(GetPurportedNotaryID(), i);
+            int32_t i = 0;
 
-                if (i > 0)
+            for (const int64_t& lTemp :
+                 theRemovedNym.GetIssuedNums(GetPurportedNotaryID())) {
+                if (0 < i++)
                     otErr << "OTItem::" << __FUNCTION__
                           << ": THIS SHOULD NOT HAPPEN.\n";
                 else if (false ==
@@ -879,6 +875,7 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
                           << ": Failed adding issued number back to THE_NYM.\n";
             }
             break;
+        }
 
         case OTTransaction::transfer:
         case OTTransaction::marketOffer:
@@ -922,14 +919,13 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
     case OTTransaction::deposit:
     case OTTransaction::payDividend:
     case OTTransaction::cancelCronItem:
-    case OTTransaction::exchangeBasket:
+    case OTTransaction::exchangeBasket: {
         // Should only actually iterate once, in this case.
-        for (int32_t i = 0;
-             i < theRemovedNym.GetIssuedNumCount(GetPurportedNotaryID()); i++) {
-            int64_t lTemp =
-                theRemovedNym.GetIssuedNum(GetPurportedNotaryID(), i);
+        int32_t i = 0;
 
-            if (i > 0)
+        for (const int64_t& lTemp :
+             theRemovedNym.GetIssuedNums(GetPurportedNotaryID())) {
+            if (0 < i++)
                 otErr << "OTItem::" << __FUNCTION__
                       << ": THIS SHOULD NOT HAPPEN.\n";
             else if (false ==
@@ -938,6 +934,7 @@ bool Item::VerifyBalanceStatement(int64_t lActualAdjustment, Nym& THE_NYM,
                       << ": Failed adding issued number back to THE_NYM.\n";
         }
         break;
+    }
 
     case OTTransaction::transfer:
     case OTTransaction::marketOffer:
@@ -967,18 +964,12 @@ void Item::AddItem(Item& theItem)
 // certain type.
 Item* Item::GetItem(int32_t nIndex)
 {
-    int32_t nTempIndex = (-1);
+    if ((nIndex < 0) || (nIndex >= GetItemCount())) return nullptr;
 
-    for (auto& it : m_listItems) {
-        Item* pItem = it;
-        OT_ASSERT(nullptr != pItem);
+    Item* pItem = m_listItems[nIndex];
+    OT_ASSERT(nullptr != pItem);
 
-        nTempIndex++; // first iteration this becomes 0 here.
-
-        if (nTempIndex == nIndex) return pItem;
-    }
-
-    return nullptr;
+    return pItem;
 }
 
 // While processing an item, you may wish to query it for sub-items
@@ -1521,11 +1512,8 @@ void Item::Release_Item()
 void Item::ReleaseItems()
 {
 
-    while (!m_listItems.empty()) {
-        Item* pItem = m_listItems.front();
-        m_listItems.pop_front();
-        delete pItem;
-    }
+    for (auto& it : m_listItems) delete it;
+    m_listItems.clear();
 }
 
 Item::itemType Item::GetItemTypeFromString(const String& strType)
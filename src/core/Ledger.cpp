@@ -57,20 +57,125 @@
 #include "opentxs/core/util/Common.hpp"
 #include "opentxs/core/util/OTFolders.hpp"
 #include "opentxs/core/util/Tag.hpp"
+#include "opentxs/storage/StoragePool.hpp"
 
 #include <stdlib.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <irrxml/irrXML.hpp>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
+
+// Threads shared by every ledger for loading box receipts
+#define OT_BOX_RECEIPT_LOADERS 8
+// Fewest box receipts worth handing another loader thread
+#define OT_BOX_RECEIPT_BATCH 16
 
 namespace opentxs
 {
 
+namespace
+{
+// Box receipts being loaded for one call to Ledger::LoadBoxReceipts(). The
+// queued jobs hold on to it, since they can start after the caller has
+// loaded everything by itself and returned.
+struct BoxReceiptLoad {
+    int64_t ledger_type_{0};
+    bool all_{false};
+    std::vector<OTTransaction*> abbreviated_;
+    std::vector<OTTransaction*> receipts_;
+    std::atomic<std::size_t> next_{0};
+    std::atomic<bool> failed_{false};
+    std::mutex lock_;
+    std::condition_variable done_;
+    std::size_t active_{0};
+    // Set once the caller stops waiting for help
+    bool closed_{false};
+
+    void Load()
+    {
+        const std::size_t count = abbreviated_.size();
+
+        while (true) {
+            const std::size_t position = next_++;
+
+            if (position >= count) { break; }
+
+            // If not building a list of all failures, then we can stop at
+            // the first sign of failure.
+            if (!all_ && failed_.load()) { break; }
+
+            receipts_[position] = ::opentxs::LoadBoxReceipt(
+                *abbreviated_[position], ledger_type_);
+
+            if (nullptr == receipts_[position]) { failed_.store(true); }
+        }
+    }
+
+    // Runs Load() on a pool thread
+    void Help()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        if (closed_) { return; }
+
+        ++active_;
+        lock.unlock();
+
+        Load();
+
+        lock.lock();
+        --active_;
+        lock.unlock();
+        done_.notify_all();
+    }
+};
+
+StoragePool& box_receipt_loaders()
+{
+    static StoragePool pool(OT_BOX_RECEIPT_LOADERS);
+
+    return pool;
+}
+
+void EraseFromIndex(multimapOfTransactions& theIndex, int64_t lKey,
+                    const OTTransaction* pTransaction)
+{
+    auto range = theIndex.equal_range(lKey);
+
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == pTransaction) {
+            theIndex.erase(it);
+            return;
+        }
+    }
+
+    // The key changed after the transaction was indexed. Don't leave a
+    // dangling pointer behind.
+    for (auto it = theIndex.begin(); it != theIndex.end(); ++it) {
+        if (it->second == pTransaction) {
+            theIndex.erase(it);
+            return;
+        }
+    }
+}
+
+bool CompareTransactionNum(const OTTransaction* pFirst,
+                           const OTTransaction* pSecond)
+{
+    return pFirst->GetTransactionNum() < pSecond->GetTransactionNum();
+}
+
+} // namespace
+
 char const* const __TypeStringsLedger[] = {
     "nymbox",  // the nymbox is per user account (versus per asset account) and
                // is used to receive new transaction numbers (and messages.)
@@ -247,66 +352,88 @@ bool Ledger::DeleteBoxReceipt(const int64_t& lTransactionNum)
 // if psetUnloaded passed in, then use it to return the #s that weren't there.
 bool Ledger::LoadBoxReceipts(std::set<int64_t>* psetUnloaded)
 {
-    // Grab a copy of all the transaction #s stored inside this ledger.
+    // Grab the abbreviated transactions stored inside this ledger.
     //
-    std::set<int64_t> the_set;
+    std::shared_ptr<BoxReceiptLoad> load(new BoxReceiptLoad);
+    std::vector<OTTransaction*>& abbreviated = load->abbreviated_;
 
     for (auto& it : m_mapTransactions) {
         OTTransaction* pTransaction = it.second;
         OT_ASSERT(nullptr != pTransaction);
-        the_set.insert(pTransaction->GetTransactionNum());
+
+        if (pTransaction->IsAbbreviated()) {
+            abbreviated.push_back(pTransaction);
+        }
+    }
+
+    // Each box receipt is a separate file read, parse and hash check, and
+    // none of them touch this ledger, so the threads of a pool shared by all
+    // ledgers help load them. Below OT_BOX_RECEIPT_BATCH receipts per
+    // thread, queueing the work costs more than it saves. The loaders log
+    // through otOut, otErr and friends, which is safe because OTLogStream
+    // assembles each thread's lines separately.
+    //
+    const std::size_t count = abbreviated.size();
+    load->ledger_type_ = static_cast<int64_t>(GetType());
+    load->all_ = (nullptr != psetUnloaded);
+    load->receipts_.assign(count, nullptr);
+    const std::size_t helpers = std::min<std::size_t>(
+        OT_BOX_RECEIPT_LOADERS, count / OT_BOX_RECEIPT_BATCH);
+
+    for (std::size_t i = 1; i < helpers; ++i) {
+        box_receipt_loaders().Run([load]() { load->Help(); });
     }
 
-    // Now iterate through those numbers and for each, load the box receipt.
+    // This thread works through the receipts as well, so the call never
+    // waits for a busy pool. It only waits for helpers which are still
+    // loading a receipt. Helpers which start later do nothing.
+    load->Load();
+
+    std::unique_lock<std::mutex> lock(load->lock_);
+    load->closed_ = true;
+    load->done_.wait(lock, [&load]() { return 0 == load->active_; });
+    lock.unlock();
+
+    const std::vector<OTTransaction*>& receipts = load->receipts_;
+
+    // Now replace the abbreviated transactions with the box receipts, all
+    // at once on this thread.
     //
     bool bRetVal = true;
 
-    for (auto& it : the_set) {
-        int64_t lSetNum = it;
+    for (std::size_t i = 0; i < count; ++i) {
+        const int64_t lSetNum = abbreviated[i]->GetTransactionNum();
 
-        OTTransaction* pTransaction = GetTransaction(lSetNum);
-        OT_ASSERT(nullptr != pTransaction);
+        if (nullptr != receipts[i]) {
+            //  Remove the existing, abbreviated receipt, and replace it with
+            // the actual receipt.
+            //
+            RemoveTransaction(lSetNum);  // this deletes abbreviated[i]
+            abbreviated[i] = nullptr;
+            AddTransaction(*receipts[i]);  // takes ownership.
+
+            continue;
+        }
+
+        // Receipts after the first failure may not have been attempted at
+        // all, unless psetUnloaded was passed in.
+        if (!bRetVal && (nullptr == psetUnloaded)) { continue; }
 
         // Failed loading the boxReceipt
         //
-        if ((true == pTransaction->IsAbbreviated()) &&
-            (false == LoadBoxReceipt(lSetNum))) {
-            // WARNING: pTransaction must be re-Get'd below this point if
-            // needed, since pointer
-            // is bad if success on LoadBoxReceipt() call.
-            //
-            pTransaction = nullptr;
-            bRetVal = false;
-            OTLogStream* pLog = &otOut;
+        bRetVal = false;
+        OTLogStream* pLog = &otOut;
 
-            if (nullptr != psetUnloaded) {
-                psetUnloaded->insert(lSetNum);
-                pLog = &otLog3;
-            }
-            *pLog << "OTLedger::LoadBoxReceipts: Failed calling LoadBoxReceipt "
-                     "on "
-                     "abbreviated transaction number:"
-                  << lSetNum << ".\n";
-            // If psetUnloaded is passed in, then we don't want to break,
-            // because we want to
-            // populate it with the conmplete list of IDs that wouldn't load as
-            // a Box Receipt.
-            // Thus, we only break if psetUnloaded is nullptr, which is better
-            // optimization in that case.
-            // (If not building a list of all failures, then we can return at
-            // first sign of failure.)
-            //
-            if (nullptr == psetUnloaded) break;
+        if (nullptr != psetUnloaded) {
+            psetUnloaded->insert(lSetNum);
+            pLog = &otLog3;
         }
-        // else (success), no need for a block in that case.
+        *pLog << "OTLedger::LoadBoxReceipts: Failed calling LoadBoxReceipt "
+                 "on "
+                 "abbreviated transaction number:"
+              << lSetNum << ".\n";
     }
 
-    // You might ask, why didn't I just iterate through the transactions
-    // directly and just call
-    // LoadBoxReceipt on each one? Answer: Because that function actually
-    // deletes the transaction
-    // and replaces it with a different object, if successful.
-
     return bRetVal;
 }
 
@@ -1104,6 +1231,7 @@ bool Ledger::RemoveTransaction(int64_t lTransactionNum, bool bDeleteIt)
         OTTransaction* pTransaction = it->second;
         OT_ASSERT(nullptr != pTransaction);
         m_mapTransactions.erase(it);
+        UnindexTransaction(*pTransaction);
 
         if (bDeleteIt) {
             delete pTransaction;
@@ -1121,7 +1249,7 @@ bool Ledger::AddTransaction(OTTransaction& theTransaction)
 
     // If it's not already on the list, then add it...
     if (it == m_mapTransactions.end()) {
-        m_mapTransactions[theTransaction.GetTransactionNum()] = &theTransaction;
+        InsertTransaction(theTransaction);
         theTransaction.SetParent(*this);  // for convenience
         return true;
     }
@@ -1135,6 +1263,78 @@ bool Ledger::AddTransaction(OTTransaction& theTransaction)
     return false;
 }
 
+// Every path that puts a transaction into m_mapTransactions goes through
+// here, so the secondary indexes stay in step with it.
+void Ledger::InsertTransaction(OTTransaction& theTransaction)
+{
+    OTTransaction*& pSlot =
+        m_mapTransactions[theTransaction.GetTransactionNum()];
+
+    if (nullptr != pSlot) UnindexTransaction(*pSlot);
+
+    pSlot = &theTransaction;
+    IndexTransaction(theTransaction);
+}
+
+void Ledger::IndexTransaction(OTTransaction& theTransaction)
+{
+    m_mapByRequestNum.insert(
+        std::make_pair(theTransaction.GetRequestNum(), &theTransaction));
+    m_mapByNumberOfOrigin.insert(std::make_pair(
+        theTransaction.GetRawNumberOfOrigin(), &theTransaction));
+    m_mapByInRefTo.insert(
+        std::make_pair(theTransaction.GetReferenceToNum(), &theTransaction));
+    m_vecTransactions.clear();
+}
+
+void Ledger::UnindexTransaction(OTTransaction& theTransaction)
+{
+    EraseFromIndex(m_mapByRequestNum, theTransaction.GetRequestNum(),
+                   &theTransaction);
+    EraseFromIndex(m_mapByNumberOfOrigin,
+                   theTransaction.GetRawNumberOfOrigin(), &theTransaction);
+    EraseFromIndex(m_mapByInRefTo, theTransaction.GetReferenceToNum(),
+                   &theTransaction);
+    m_vecTransactions.clear();
+}
+
+// Collects the transactions filed under lKey, plus any filed under 0 (the
+// key was never set on them, so they might still match), in transaction
+// number order. Callers still verify each candidate.
+void Ledger::GetIndexedTransactions(const multimapOfTransactions& theIndex,
+                                    int64_t lKey,
+                                    vectorOfTransactions& theOutput) const
+{
+    theOutput.clear();
+
+    auto range = theIndex.equal_range(lKey);
+    for (auto it = range.first; it != range.second; ++it)
+        theOutput.push_back(it->second);
+
+    if (0 != lKey) {
+        range = theIndex.equal_range(0);
+        for (auto it = range.first; it != range.second; ++it)
+            theOutput.push_back(it->second);
+    }
+
+    std::sort(theOutput.begin(), theOutput.end(), CompareTransactionNum);
+}
+
+const vectorOfTransactions& Ledger::GetTransactionVector() const
+{
+    if (m_vecTransactions.size() != m_mapTransactions.size()) {
+        m_vecTransactions.clear();
+        m_vecTransactions.reserve(m_mapTransactions.size());
+
+        for (auto& it : m_mapTransactions) {
+            OT_ASSERT(nullptr != it.second);
+            m_vecTransactions.push_back(it.second);
+        }
+    }
+
+    return m_vecTransactions;
+}
+
 OTTransaction* Ledger::GetTransaction(OTTransaction::transactionType theType)
 {
     // loop through the items that make up this transaction
@@ -1155,36 +1355,29 @@ int32_t Ledger::GetTransactionIndex(int64_t lTransactionNum)
     // loop through the transactions inside this ledger
     // If a specific transaction is found, returns its index inside the ledger
     //
-    int32_t nIndex = -1;
+    auto it = m_mapTransactions.find(lTransactionNum);
 
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    if (it == m_mapTransactions.end()) return -1;
 
-        ++nIndex;  // 0 on first iteration.
+    const vectorOfTransactions& theTransactions = GetTransactionVector();
+    auto found =
+        std::lower_bound(theTransactions.begin(), theTransactions.end(),
+                         it->second, CompareTransactionNum);
 
-        if (pTransaction->GetTransactionNum() == lTransactionNum) {
-            return nIndex;
-        }
-    }
-    return -1;
+    return static_cast<int32_t>(found - theTransactions.begin());
 }
 
 // Look up a transaction by transaction number and see if it is in the ledger.
 // If it is, return a pointer to it, otherwise return nullptr.
 OTTransaction* Ledger::GetTransaction(int64_t lTransactionNum) const
 {
-    // loop through the transactions inside this ledger
+    auto it = m_mapTransactions.find(lTransactionNum);
 
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT(nullptr != pTransaction);
+    if (it == m_mapTransactions.end()) return nullptr;
 
-        if (pTransaction->GetTransactionNum() == lTransactionNum) {
-            return pTransaction;
-        }
-    }
-    return nullptr;
+    OT_ASSERT(nullptr != it->second);
+
+    return it->second;
 }
 
 // Return a count of all the transactions in this ledger that are IN REFERENCE
@@ -1196,8 +1389,9 @@ int32_t Ledger::GetTransactionCountInRefTo(int64_t lReferenceNum) const
 {
     int32_t nCount = 0;
 
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
+    auto range = m_mapByInRefTo.equal_range(lReferenceNum);
+    for (auto it = range.first; it != range.second; ++it) {
+        OTTransaction* pTransaction = it->second;
         OT_ASSERT(nullptr != pTransaction);
 
         if (pTransaction->GetReferenceToNum() == lReferenceNum) nCount++;
@@ -1213,20 +1407,10 @@ OTTransaction* Ledger::GetTransactionByIndex(int32_t nIndex) const
     // Out of bounds.
     if ((nIndex < 0) || (nIndex >= GetTransactionCount())) return nullptr;
 
-    int32_t nIndexCount = -1;
-
-    for (auto& it : m_mapTransactions) {
-        nIndexCount++;  // On first iteration, this is now 0, same as nIndex.
-        OTTransaction* pTransaction = it.second;
-        OT_ASSERT((nullptr != pTransaction));  // Should always be good.
+    OTTransaction* pTransaction = GetTransactionVector()[nIndex];
+    OT_ASSERT((nullptr != pTransaction));  // Should always be good.
 
-        // If this transaction is the one at the requested index
-        if (nIndexCount == nIndex) return pTransaction;
-    }
-
-    return nullptr;  // Should never reach this point, since bounds are checked
-                     // at
-                     // the top.
+    return pTransaction;
 }
 
 // Nymbox-only.
@@ -1234,9 +1418,10 @@ OTTransaction* Ledger::GetTransactionByIndex(int32_t nIndex) const
 //
 OTTransaction* Ledger::GetReplyNotice(const int64_t& lRequestNum)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
+    vectorOfTransactions theCandidates;
+    GetIndexedTransactions(m_mapByRequestNum, lRequestNum, theCandidates);
+
+    for (auto& pTransaction : theCandidates) {
         OT_ASSERT(nullptr != pTransaction);
 
         if (OTTransaction::replyNotice != pTransaction->GetType())  // <=======
@@ -1250,9 +1435,13 @@ OTTransaction* Ledger::GetReplyNotice(const int64_t& lRequestNum)
 
 OTTransaction* Ledger::GetTransferReceipt(int64_t lNumberOfOrigin)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
+    // The transferReceipt carries the number of origin of its acceptPending,
+    // so only those filed under it need their original item loaded.
+    vectorOfTransactions theCandidates;
+    GetIndexedTransactions(m_mapByNumberOfOrigin, lNumberOfOrigin,
+                           theCandidates);
+
+    for (auto& pTransaction : theCandidates) {
         OT_ASSERT(nullptr != pTransaction);
 
         if (OTTransaction::transferReceipt == pTransaction->GetType()) {
@@ -1329,8 +1518,12 @@ OTTransaction* Ledger::GetChequeReceipt(
                            // RESPONSIBLE
                            // TO DELETE.
 {
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pCurrentReceipt = it.second;
+    // The receipt's number of origin is the cheque number, so only those
+    // filed under it need their cheque loaded.
+    vectorOfTransactions theCandidates;
+    GetIndexedTransactions(m_mapByNumberOfOrigin, lChequeNum, theCandidates);
+
+    for (auto& pCurrentReceipt : theCandidates) {
         OT_ASSERT(nullptr != pCurrentReceipt);
 
         if ((pCurrentReceipt->GetType() != OTTransaction::chequeReceipt) &&
@@ -1431,9 +1624,9 @@ OTTransaction* Ledger::GetChequeReceipt(
 //
 OTTransaction* Ledger::GetFinalReceipt(int64_t lReferenceNum)
 {
-    // loop through the transactions that make up this ledger.
-    for (auto& it : m_mapTransactions) {
-        OTTransaction* pTransaction = it.second;
+    auto range = m_mapByInRefTo.equal_range(lReferenceNum);
+    for (auto it = range.first; it != range.second; ++it) {
+        OTTransaction* pTransaction = it->second;
         OT_ASSERT(nullptr != pTransaction);
 
         if (OTTransaction::finalReceipt != pTransaction->GetType())  // <=======
@@ -2132,8 +2325,7 @@ int32_t Ledger::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
                     if (pTransaction->VerifyContractID()) {
                         // Add it to the ledger...
                         //
-                        m_mapTransactions[pTransaction->GetTransactionNum()] =
-                            pTransaction;
+                        InsertTransaction(*pTransaction);
                         pTransaction->SetParent(*this);
                         //                      otLog5 << "Loaded abbreviated
                         // transaction and adding to m_mapTransactions in
@@ -2300,8 +2492,7 @@ int32_t Ledger::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
                 // (Below this point, no need to delete pTransaction upon
                 // returning.)
                 //
-                m_mapTransactions[pTransaction->GetTransactionNum()] =
-                    pTransaction;
+                InsertTransaction(*pTransaction);
                 pTransaction->SetParent(*this);
                 //                otLog5 << "Loaded full transaction and adding
                 // to m_mapTransactions in OTLedger\n");
@@ -2399,6 +2590,11 @@ void Ledger::ReleaseTransactions()
 {
     // If there were any dynamically allocated objects, clean them up here.
 
+    m_mapByRequestNum.clear();
+    m_mapByNumberOfOrigin.clear();
+    m_mapByInRefTo.clear();
+    m_vecTransactions.clear();
+
     while (!m_mapTransactions.empty()) {
         OTTransaction* pTransaction = m_mapTransactions.begin()->second;
         m_mapTransactions.erase(m_mapTransactions.begin());
@@ -72,6 +72,7 @@
 #include <sys/types.h>
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
@@ -84,6 +85,9 @@
 #include <typeinfo>
 
 #define LOG_DEQUE_SIZE 1024
+#define LOG_BUFFER_MAX_SIZE 4194304 // Loggers wait beyond 4MB queued.
+#define LOG_FILE_MAX_SIZE 67108864  // Rotate the log file beyond 64MB.
+#define LOG_FILE_ROTATED_EXT ".1"
 
 extern "C" {
 
@@ -158,34 +162,54 @@ OTLOG_IMPORT OTLogStream otLog5(5); // logs using OTLog::vOutput(5)
 OTLogStream::OTLogStream(int _logLevel)
     : std::ostream(this)
     , logLevel(_logLevel)
-    , next(0)
-    , pBuffer(new char[1024])
 {
+    SetLogLevel(0); // Log::LogLevel() until Init() says otherwise.
 }
 
 OTLogStream::~OTLogStream()
 {
-    delete[] pBuffer;
-    pBuffer = nullptr;
+}
+
+void OTLogStream::SetLogLevel(int32_t nLogLevel)
+{
+    // Errors always log. (See Log::Error.) Otherwise this matches the check
+    // in Log::Output.
+    if ((logLevel < 0) || ((nLogLevel >= 0) && (logLevel <= nLogLevel)))
+        clear();
+    else
+        setstate(std::ios::badbit);
 }
 
 int OTLogStream::overflow(int c)
 {
-    pBuffer[next++] = c;
-    if (c != '\n' && next < 1000) {
-        return 0;
+    typedef std::char_traits<char> traits;
+
+    if (traits::eq_int_type(c, traits::eof())) {
+        return traits::not_eof(c);
     }
 
-    pBuffer[next++] = '\0';
-    next = 0;
+    std::string line;
+
+    {
+        std::lock_guard<std::mutex> lock(bufferLock);
+        auto it = buffers.emplace(std::this_thread::get_id(), "").first;
+        it->second.push_back(static_cast<char>(c));
+
+        if (c != '\n' && it->second.size() < 1000) {
+            return c;
+        }
+
+        line.swap(it->second);
+        buffers.erase(it);
+    }
 
     if (logLevel < 0) {
-        Log::Error(pBuffer);
-        return 0;
+        Log::Error(line.c_str());
+        return c;
     }
 
-    Log::Output(logLevel, pBuffer);
-    return 0;
+    Log::Output(logLevel, line.c_str());
+    return c;
 }
 
 //  OTLog Init, must run this before using any OTLog function.
@@ -247,6 +271,8 @@ bool Log::Init(const String& strThreadContext, const int32_t& nLogLevel)
             };
 
         pLogger->m_bInitialized = true;
+        UpdateStreams(nLogLevel);
+        pLogger->m_writer = std::thread(&Log::WriteLoop, pLogger);
 
         // Set the new log-assert function pointer.
         Assert* pLogAssert = new Assert(Log::logAssert);
@@ -261,6 +287,29 @@ bool Log::Init(const String& strThreadContext, const int32_t& nLogLevel)
     }
 }
 
+Log::Log()
+    : m_nLogLevel(0)
+    , m_bInitialized(false)
+    , m_bWriting(false)
+    , m_bShutdown(false)
+{
+}
+
+Log::~Log()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_bufferLock);
+        m_bShutdown = true;
+    }
+
+    m_bufferSignal.notify_all();
+
+    // The writer empties the buffer before it exits.
+    if (m_writer.joinable()) m_writer.join();
+
+    for (auto& it : logDeque) delete it;
+}
+
 // static
 bool Log::IsInitialized()
 {
@@ -341,10 +390,22 @@ bool Log::SetLogLevel(const int32_t& nLogLevel)
     }
     else {
         pLogger->m_nLogLevel = nLogLevel;
+        UpdateStreams(nLogLevel);
         return true;
     }
 }
 
+// static
+void Log::UpdateStreams(const int32_t& nLogLevel)
+{
+    otInfo.SetLogLevel(nLogLevel);
+    otOut.SetLogLevel(nLogLevel);
+    otWarn.SetLogLevel(nLogLevel);
+    otLog3.SetLogLevel(nLogLevel);
+    otLog4.SetLogLevel(nLogLevel);
+    otLog5.SetLogLevel(nLogLevel);
+}
+
 //  OTLog Functions
 
 // If there's no logfile, then send it to stderr.
@@ -355,38 +416,111 @@ bool Log::SetLogLevel(const int32_t& nLogLevel)
 // static
 bool Log::LogToFile(const String& strOutput)
 {
-    // We now do this either way.
-    {
+    bool bHaveLogger(false);
+    if (nullptr != pLogger)
+        if (pLogger->IsInitialized()) bHaveLogger = true;
+
+    if (bHaveLogger) CheckLogger(Log::pLogger);
+
+    if (!bHaveLogger || !pLogger->m_strLogFilePath.Exists()) {
         std::cerr << strOutput;
         std::cerr.flush();
+
+        return false;
     }
 
-    // now log to file, if we can.
+    if (!strOutput.Exists()) return false;
 
-    bool bHaveLogger(false);
-    if (nullptr != pLogger)
-        if (pLogger->IsInitialized()) bHaveLogger = true;
+    pLogger->Enqueue(strOutput);
 
-    // lets check if we are Initialized in this context
-    if (bHaveLogger) CheckLogger(Log::pLogger);
+    return true;
+}
+
+// static
+void Log::Flush()
+{
+    if (!IsInitialized()) return;
+
+    std::unique_lock<std::mutex> lock(pLogger->m_bufferLock);
+
+    pLogger->m_bufferSignal.wait(lock, [] {
+        return pLogger->m_bShutdown ||
+               (pLogger->m_strBuffer.empty() && !pLogger->m_bWriting);
+    });
+}
+
+void Log::Enqueue(const String& strOutput)
+{
+    std::unique_lock<std::mutex> lock(m_bufferLock);
 
-    bool bSuccess = false;
+    // If the writer has fallen this far behind, wait for it rather than let
+    // the buffer grow without bound.
+    m_bufferSignal.wait(lock, [this] {
+        return m_bShutdown || (LOG_BUFFER_MAX_SIZE > m_strBuffer.size());
+    });
 
-    if (bHaveLogger) {
-        // Append to logfile
-        if ((strOutput.Exists()) && (Log::pLogger->m_strLogFilePath.Exists())) {
-            std::ofstream logfile;
-            logfile.open(Log::LogFilePath(), std::ios::app);
+    m_strBuffer.append(strOutput.Get(), strOutput.GetLength());
+    m_bufferSignal.notify_all();
+}
+
+// Runs on m_writer. Anything it needs to report goes straight to stderr,
+// since logging from here could end up waiting on itself.
+void Log::WriteLoop()
+{
+    const std::string strPath(m_strLogFilePath.Get());
+    const std::string strRotatedPath(strPath + LOG_FILE_ROTATED_EXT);
+    std::ofstream logfile;
+    int64_t lFileSize = 0;
+    std::string strBatch;
+
+    std::unique_lock<std::mutex> lock(m_bufferLock);
+
+    while (true) {
+        m_bufferSignal.wait(
+            lock, [this] { return m_bShutdown || !m_strBuffer.empty(); });
+
+        if (m_strBuffer.empty()) break; // Shutting down, nothing left.
+
+        strBatch.swap(m_strBuffer);
+        m_bWriting = true;
+        m_bufferSignal.notify_all(); // There's room in the buffer again.
+        lock.unlock();
+
+        std::cerr.write(strBatch.data(), strBatch.size());
+        std::cerr.flush();
+
+        if (!logfile.is_open()) {
+            logfile.open(strPath.c_str(), std::ios::app);
+
+            if (logfile.is_open()) {
+                logfile.seekp(0, std::ios::end);
+                lFileSize = static_cast<int64_t>(logfile.tellp());
+            }
+        }
 
-            if (!logfile.fail()) {
-                logfile << strOutput;
+        if (logfile.is_open()) {
+            logfile.write(strBatch.data(), strBatch.size());
+            logfile.flush();
+            lFileSize += static_cast<int64_t>(strBatch.size());
+
+            if (logfile.fail()) {
+                std::cerr << "Log::" << __FUNCTION__ << ": Failed writing to "
+                          << strPath << "\n";
+                logfile.close();
+                logfile.clear();
+            }
+            else if (LOG_FILE_MAX_SIZE <= lFileSize) {
                 logfile.close();
-                bSuccess = true;
+                std::remove(strRotatedPath.c_str());
+                std::rename(strPath.c_str(), strRotatedPath.c_str());
             }
         }
-    }
 
-    return bSuccess;
+        strBatch.clear();
+        lock.lock();
+        m_bWriting = false;
+        m_bufferSignal.notify_all(); // Wake Flush().
+    }
 }
 
 String Log::GetMemlogAtIndex(int32_t nIndex)
@@ -395,18 +529,33 @@ String Log::GetMemlogAtIndex(int32_t nIndex)
     CheckLogger(Log::pLogger);
 
     uint32_t uIndex = static_cast<uint32_t>(nIndex);
+    bool bInBounds = false;
+    bool bIsNull = false;
+    String strLogEntry;
 
-    if ((nIndex < 0) || (uIndex >= Log::pLogger->logDeque.size())) {
-        otErr << __FUNCTION__ << ": index out of bounds: " << nIndex << "\n";
-        return "";
+    {
+        std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
+
+        if ((nIndex >= 0) && (uIndex < Log::pLogger->logDeque.size())) {
+            const String* pEntry = Log::pLogger->logDeque.at(uIndex);
+
+            if (nullptr == pEntry)
+                bIsNull = true;
+            else
+                strLogEntry = *pEntry;
+
+            bInBounds = true;
+        }
     }
 
-    if (nullptr != Log::pLogger->logDeque.at(uIndex))
-        ; // check for null
-    else
-        OT_FAIL;
+    // Not while holding m_memlogLock, since logging (and so OT_FAIL) takes
+    // it too.
+    if (bIsNull) OT_FAIL;
 
-    const String strLogEntry = *Log::pLogger->logDeque.at(uIndex);
+    if (!bInBounds) {
+        otErr << __FUNCTION__ << ": index out of bounds: " << nIndex << "\n";
+        return "";
+    }
 
     if (strLogEntry.Exists())
         return strLogEntry;
@@ -420,6 +569,7 @@ int32_t Log::GetMemlogSize()
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
+    std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
 
     return static_cast<int32_t>(Log::pLogger->logDeque.size());
 }
@@ -428,15 +578,24 @@ String Log::PeekMemlogFront()
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
+    String strLogEntry;
+    bool bIsNull = false;
 
-    if (Log::pLogger->logDeque.size() <= 0) return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
 
-    if (nullptr != Log::pLogger->logDeque.front())
-        ; // check for null
-    else
-        OT_FAIL;
+        if (Log::pLogger->logDeque.size() <= 0) return nullptr;
+
+        const String* pEntry = Log::pLogger->logDeque.front();
+
+        if (nullptr == pEntry)
+            bIsNull = true;
+        else
+            strLogEntry = *pEntry;
+    }
 
-    const String strLogEntry = *Log::pLogger->logDeque.front();
+    // Not while holding m_memlogLock, as in GetMemlogAtIndex.
+    if (bIsNull) OT_FAIL;
 
     if (strLogEntry.Exists())
         return strLogEntry;
@@ -448,15 +607,24 @@ String Log::PeekMemlogBack()
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
+    String strLogEntry;
+    bool bIsNull = false;
+
+    {
+        std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
 
-    if (Log::pLogger->logDeque.size() <= 0) return nullptr;
+        if (Log::pLogger->logDeque.size() <= 0) return nullptr;
 
-    if (nullptr != Log::pLogger->logDeque.back())
-        ; // check for null
-    else
-        OT_FAIL;
+        const String* pEntry = Log::pLogger->logDeque.back();
 
-    const String strLogEntry = *Log::pLogger->logDeque.back();
+        if (nullptr == pEntry)
+            bIsNull = true;
+        else
+            strLogEntry = *pEntry;
+    }
+
+    // Not while holding m_memlogLock, as in GetMemlogAtIndex.
+    if (bIsNull) OT_FAIL;
 
     if (strLogEntry.Exists())
         return strLogEntry;
@@ -469,6 +637,7 @@ bool Log::PopMemlogFront()
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
+    std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
 
     if (Log::pLogger->logDeque.size() <= 0) return false;
 
@@ -486,6 +655,7 @@ bool Log::PopMemlogBack()
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
+    std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
 
     if (Log::pLogger->logDeque.size() <= 0) return false;
 
@@ -503,14 +673,18 @@ bool Log::PushMemlogFront(const String& strLog)
 {
     // lets check if we are Initialized in this context
     CheckLogger(Log::pLogger);
-
+    // Before taking m_memlogLock, since a failed assert logs.
     OT_ASSERT(strLog.Exists());
 
+    std::lock_guard<std::mutex> lock(Log::pLogger->m_memlogLock);
+
     Log::pLogger->logDeque.push_front(new String(strLog));
 
     if (Log::pLogger->logDeque.size() > LOG_DEQUE_SIZE) {
-        Log::PopMemlogBack(); // We start removing from the back when it
-                              // reaches this size.
+        // We start removing from the back when it reaches this size. (Not
+        // via PopMemlogBack, since we already hold m_memlogLock.)
+        delete Log::pLogger->logDeque.back();
+        Log::pLogger->logDeque.pop_back();
     }
 
     return true;
@@ -569,6 +743,11 @@ size_t Log::logAssert(const char* szFilename, size_t nLinenumber,
 #endif
     }
 
+#ifndef ANDROID
+    // The caller is about to terminate, so nothing may stay queued.
+    Flush();
+#endif
+
     print_stacktrace();
 
     return 1; // normal
@@ -646,8 +825,9 @@ void Log::vOutput(int32_t nVerbosity, const char* szOutput, ...)
 
     // If log level is 0, and verbosity of this message is 2, don't bother
     // logging it.
-    if (((0 != LogLevel()) && (nVerbosity > LogLevel())) ||
-        (nullptr == szOutput))
+    // Same check as in Output(), but before paying for the formatting.
+    if ((nVerbosity > LogLevel()) || (nullptr == szOutput) ||
+        (LogLevel() == (-1)))
         return;
 
     va_list args;
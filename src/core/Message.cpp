@@ -196,17 +196,16 @@ void Message::SetAcknowledgments(Nym& theNym)
 
     for (auto& it : theNym.GetMapAcknowledgedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID = strNotaryID.c_str();
         const Identifier theTempID(OTstrNotaryID);
 
-        if (!(pDeque->empty()) &&
+        if (!(pNumbers->empty()) &&
             (theNotaryID == theTempID))  // only for the matching notaryID.
         {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                const int64_t lAckRequestNumber = pDeque->at(i);
+            for (const int64_t lAckRequestNumber : *pNumbers) {
 
                 m_AcknowledgedReplies.Add(lAckRequestNumber);
             }
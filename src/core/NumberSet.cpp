@@ -0,0 +1,231 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/core/NumberSet.hpp"
+
+#include "opentxs/core/String.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace opentxs
+{
+
+NumberSet::const_iterator::const_iterator(
+    Ranges::const_iterator range,
+    Ranges::const_iterator end)
+    : range_(range)
+    , end_(end)
+{
+    if (range_ != end_) {
+        value_ = range_->first;
+    }
+}
+
+NumberSet::const_iterator& NumberSet::const_iterator::operator++()
+{
+    if (value_ == range_->second) {
+        ++range_;
+
+        if (range_ != end_) {
+            value_ = range_->first;
+        }
+    } else {
+        ++value_;
+    }
+
+    return *this;
+}
+
+NumberSet::const_iterator NumberSet::const_iterator::operator++(int)
+{
+    const_iterator output(*this);
+    ++(*this);
+
+    return output;
+}
+
+bool NumberSet::const_iterator::operator==(const const_iterator& rhs) const
+{
+    if (range_ != rhs.range_) return false;
+
+    return (range_ == end_) || (value_ == rhs.value_);
+}
+
+bool NumberSet::Add(const int64_t& theValue)
+{
+    // The first run which starts above theValue.
+    auto next = m_ranges.upper_bound(theValue);
+    auto previous = m_ranges.end();
+
+    if (m_ranges.begin() != next) {
+        previous = std::prev(next);
+
+        if (previous->second >= theValue) return false;  // already there.
+    }
+
+    // previous->second < theValue and next->first > theValue, so neither of
+    // these can overflow.
+    const bool bJoinPrevious =
+        (m_ranges.end() != previous) && (previous->second + 1 == theValue);
+    const bool bJoinNext =
+        (m_ranges.end() != next) && (next->first - 1 == theValue);
+
+    if (bJoinPrevious && bJoinNext) {
+        previous->second = next->second;
+        m_ranges.erase(next);
+    } else if (bJoinPrevious) {
+        previous->second = theValue;
+    } else if (bJoinNext) {
+        const int64_t lLast = next->second;
+        m_ranges.erase(next++);
+        m_ranges.emplace_hint(next, theValue, lLast);
+    } else {
+        m_ranges.emplace_hint(next, theValue, theValue);
+    }
+
+    m_size++;
+
+    return true;
+}
+
+bool NumberSet::Remove(const int64_t& theValue)
+{
+    auto it = m_ranges.upper_bound(theValue);
+
+    if (m_ranges.begin() == it) return false;
+
+    --it;
+
+    if (it->second < theValue) return false;  // NOT already there.
+
+    const int64_t lFirst = it->first;
+    const int64_t lLast = it->second;
+
+    if (lFirst == lLast) {
+        m_ranges.erase(it);
+    } else if (theValue == lFirst) {
+        auto next = m_ranges.erase(it);
+        m_ranges.emplace_hint(next, theValue + 1, lLast);
+    } else if (theValue == lLast) {
+        it->second = theValue - 1;
+    } else {
+        // Split the run in two.
+        it->second = theValue - 1;
+        m_ranges.emplace_hint(std::next(it), theValue + 1, lLast);
+    }
+
+    m_size--;
+
+    return true;
+}
+
+bool NumberSet::Verify(const int64_t& theValue) const
+{
+    auto it = m_ranges.upper_bound(theValue);
+
+    if (m_ranges.begin() == it) return false;
+
+    return (std::prev(it)->second >= theValue);
+}
+
+int64_t NumberSet::At(std::size_t nIndex) const
+{
+    for (auto& it : m_ranges) {
+        const uint64_t lLength =
+            static_cast<uint64_t>(it.second - it.first) + 1;
+
+        if (nIndex < lLength) {
+            return it.first + static_cast<int64_t>(nIndex);
+        }
+
+        nIndex -= static_cast<std::size_t>(lLength);
+    }
+
+    return 0;
+}
+
+int64_t NumberSet::Lowest() const
+{
+    if (m_ranges.empty()) return 0;
+
+    return m_ranges.begin()->first;
+}
+
+int64_t NumberSet::Highest() const
+{
+    if (m_ranges.empty()) return 0;
+
+    return m_ranges.rbegin()->second;
+}
+
+bool NumberSet::Output(String& strOutput) const
+{
+    // Built up in a std::string first, since concatenating to a String one
+    // number at a time copies the whole list every time.
+    std::string strNumbers;
+
+    for (const auto& lNumber : *this) {
+        if (!strNumbers.empty()) strNumbers += ",";
+
+        strNumbers += std::to_string(lNumber);
+    }
+
+    if (!strNumbers.empty()) strOutput.Concatenate(String(strNumbers));
+
+    return !empty();
+}
+
+NumberSet::const_iterator NumberSet::begin() const
+{
+    return const_iterator(m_ranges.begin(), m_ranges.end());
+}
+
+NumberSet::const_iterator NumberSet::end() const
+{
+    return const_iterator(m_ranges.end(), m_ranges.end());
+}
+
+void NumberSet::clear()
+{
+    m_ranges.clear();
+    m_size = 0;
+}
+
+}  // namespace opentxs
@@ -72,9 +72,11 @@
 #include <sys/types.h>
 #include <array>
 #include <fstream>
+#include <functional>
 #include <irrxml/irrXML.hpp>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -507,9 +509,9 @@ Item* Nym::GenerateTransactionStatement(const OTTransaction& theOwner)
 #define CLEAR_MAP_AND_DEQUE(the_map)                                           \
     for (auto& it : the_map) {                                                 \
         if ((nullptr != pstrNotaryID) && (str_NotaryID != it.first)) continue; \
-        dequeOfTransNums* pDeque = (it.second);                                \
-        OT_ASSERT(nullptr != pDeque);                                          \
-        if (!(pDeque->empty())) pDeque->clear();                               \
+        NumberSet* pNumbers = (it.second);                                     \
+        OT_ASSERT(nullptr != pNumbers);                                        \
+        if (!(pNumbers->empty())) pNumbers->clear();                           \
     }
 #endif  // CLEAR_MAP_AND_DEQUE
 
@@ -836,11 +838,11 @@ bool Nym::UnRegisterAtServer(const String& strNotaryID)
 #ifndef WIPE_MAP_AND_DEQUE
 #define WIPE_MAP_AND_DEQUE(the_map)                                            \
     while (!the_map.empty()) {                                                 \
-        dequeOfTransNums* pDeque = the_map.begin()->second;                    \
-        OT_ASSERT(nullptr != pDeque);                                          \
+        NumberSet* pNumbers = the_map.begin()->second;                         \
+        OT_ASSERT(nullptr != pNumbers);                                        \
         the_map.erase(the_map.begin());                                        \
-        delete pDeque;                                                         \
-        pDeque = nullptr;                                                      \
+        delete pNumbers;                                                       \
+        pNumbers = nullptr;                                                    \
     }
 #endif  // WIPE_MAP_AND_DEQUE
 
@@ -986,11 +988,6 @@ bool Nym::ResyncWithServer(const Ledger& theNymbox, const Nym& theMessageNym)
     const String strNotaryID(theNotaryID);
     const String strNymID(m_nymID);
 
-    const int32_t nIssuedNumCount =
-        theMessageNym.GetIssuedNumCount(theNotaryID);
-    const int32_t nTransNumCount =
-        theMessageNym.GetTransactionNumCount(theNotaryID);
-
     // Remove all issued, transaction, and tentative numbers for a specific
     // server ID,
     // as well as all acknowledgedNums, and the highest transaction number for
@@ -1018,8 +1015,7 @@ bool Nym::ResyncWithServer(const Ledger& theNymbox, const Nym& theMessageNym)
     //
     // Copy the issued and transaction numbers from theMessageNym onto *this.
     //
-    for (int32_t n1 = 0; n1 < nIssuedNumCount; ++n1) {
-        const int64_t lNum = theMessageNym.GetIssuedNum(theNotaryID, n1);
+    for (const int64_t& lNum : theMessageNym.GetIssuedNums(theNotaryID)) {
 
         if (!AddIssuedNum(strNotaryID, lNum))  // Add to list of
                                                // numbers that
@@ -1040,8 +1036,7 @@ bool Nym::ResyncWithServer(const Ledger& theNymbox, const Nym& theMessageNym)
         }
     }
 
-    for (int32_t n2 = 0; n2 < nTransNumCount; ++n2) {
-        const int64_t lNum = theMessageNym.GetTransactionNum(theNotaryID, n2);
+    for (const int64_t& lNum : theMessageNym.GetTransactionNums(theNotaryID)) {
 
         if (!AddTransactionNum(strNotaryID, lNum))  // Add to list of
                                                     // available-to-use
@@ -1146,11 +1141,6 @@ bool Nym::ResyncWithServer(const Ledger& theNymbox, const Nym& theMessageNym)
     return (SaveSignedNymfile(*this) && bSuccess);
 }
 
-/*
-typedef std::deque<int64_t>                            dequeOfTransNums;
-typedef std::map<std::string, dequeOfTransNums *>    mapOfTransNums;
-*/
-
 // Verify whether a certain transaction number appears on a certain list.
 //
 bool Nym::VerifyGenericNum(
@@ -1158,39 +1148,17 @@ bool Nym::VerifyGenericNum(
     const String& strNotaryID,
     const int64_t& lTransNum) const
 {
-    std::string strID = strNotaryID.Get();
-
-    // The Pseudonym has a deque of transaction numbers for each servers.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then find the transaction
-    // number on
-    // that list, and then return true. Else return false.
+    // The Pseudonym has a set of transaction numbers for each server.
+    // These sets are mapped by Notary ID.
     //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty()))  // there are some numbers for that server
-                                     // ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (lTransNum == pDeque->at(i)) {
-                        return true;
-                    }
-                }
-            }
-            break;
-        }
-    }
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    return false;
+    if (THE_MAP.end() == it) return false;
+
+    NumberSet* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return pNumbers->Verify(lTransNum);
 }
 
 // On the server side: A user has submitted a specific transaction number.
@@ -1220,43 +1188,14 @@ bool Nym::RemoveGenericNum(
     const String& strNotaryID,
     const int64_t& lTransNum)
 {
-    bool bRetVal = false;
-    std::string strID = strNotaryID.Get();
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of transaction numbers for each servers.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then find the transaction
-    // number on
-    // that list, and then remove it, and return true. Else return false.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty()))  // there are some numbers for that server
-                                     // ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (lTransNum == pDeque->at(i)) {
-                        pDeque->erase(pDeque->begin() + i);
-                        bRetVal = true;
-                        break;
-                    }
-                }
-            }
-            break;
-        }
-    }
+    if (THE_MAP.end() == it) return false;
 
-    return bRetVal;
+    NumberSet* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return pNumbers->Remove(lTransNum);
 }
 
 // No signer needed for this one, and save is false.
@@ -1266,51 +1205,18 @@ bool Nym::AddGenericNum(
     const String& strNotaryID,
     int64_t lTransNum)
 {
-    bool bSuccessFindingNotaryID = false, bSuccess = false;
-    std::string strID = strNotaryID.Get();
-
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then add the transaction
-    // number.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            auto iter = std::find(pDeque->begin(), pDeque->end(), lTransNum);
+    NumberSet*& pNumbers = THE_MAP[strNotaryID.Get()];
 
-            if (iter ==
-                pDeque->end())  // Only add it if it's not already there.
-                                // No duplicates!
-                pDeque->push_front(lTransNum);
-
-            bSuccess = true;
-            bSuccessFindingNotaryID = true;
-
-            break;
-        }
+    // Apparently there is not yet a set stored for this specific notaryID.
+    // Fine. Let's create it then.
+    if (nullptr == pNumbers) {
+        pNumbers = new NumberSet;
+        OT_ASSERT(nullptr != pNumbers);
     }
 
-    // Apparently there is not yet a deque stored for this specific notaryID.
-    // Fine. Let's create it then, and then add the transaction num to that new
-    // deque.
-    if (!bSuccessFindingNotaryID) {
-        dequeOfTransNums* pDeque = new dequeOfTransNums;
-
-        OT_ASSERT(nullptr != pDeque);
-
-        THE_MAP[strID] = pDeque;
-        pDeque->push_front(lTransNum);
-        bSuccess = true;
-    }
+    pNumbers->Add(lTransNum);  // No duplicates! (It's a set.)
 
-    return bSuccess;
+    return true;
 }
 
 // Returns count of transaction numbers available for a given server.
@@ -1319,36 +1225,15 @@ int32_t Nym::GetGenericNumCount(
     const mapOfTransNums& THE_MAP,
     const Identifier& theNotaryID) const
 {
-    int32_t nReturnValue = 0;
-
     const String strNotaryID(theNotaryID);
-    std::string strID = strNotaryID.Get();
-
-    dequeOfTransNums* pDeque = nullptr;
-
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then we found the right server.
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-            break;
-        }
-    }
+    if (THE_MAP.end() == it) return 0;
 
-    // We found the right server, so let's count the transaction numbers
-    // that this nym has already stored for it.
-    if (nullptr != pDeque) {
-        nReturnValue = static_cast<int32_t>(pDeque->size());
-    }
+    NumberSet* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
 
-    return nReturnValue;
+    return static_cast<int32_t>(pNumbers->size());
 }
 
 // by index.
@@ -1357,41 +1242,31 @@ int64_t Nym::GetGenericNum(
     const Identifier& theNotaryID,
     int32_t nIndex) const
 {
-    int64_t lRetVal = 0;
+    const String strNotaryID(theNotaryID);
+    auto it = THE_MAP.find(strNotaryID.Get());
+
+    if ((THE_MAP.end() == it) || (0 > nIndex)) return 0;
+
+    NumberSet* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return pNumbers->At(static_cast<std::size_t>(nIndex));
+}
 
+const NumberSet& Nym::GetGenericNums(
+    const mapOfTransNums& THE_MAP,
+    const Identifier& theNotaryID) const
+{
+    static const NumberSet empty;
     const String strNotaryID(theNotaryID);
-    std::string strID = strNotaryID.Get();
+    auto it = THE_MAP.find(strNotaryID.Get());
 
-    // The Pseudonym has a deque of numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // maps matches the Notary ID that was passed in, then find the number on
-    // that list, and then return it.
-    //
-    for (auto& it : THE_MAP) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            if (!(pDeque->empty()))  // there are some numbers for that server
-                                     // ID
-            {
-                // Let's loop through them and see if the culprit is there
-                for (uint32_t i = 0; i < pDeque->size(); i++) {
-                    // Found it!
-                    if (static_cast<uint32_t>(nIndex) == i) {
-                        lRetVal = pDeque->at(i);  // <==== Got the number here.
-                        break;
-                    }
-                }
-            }
-            break;
-        }
-    }
+    if (THE_MAP.end() == it) return empty;
 
-    return lRetVal;
+    NumberSet* pNumbers = it->second;
+    OT_ASSERT(nullptr != pNumbers);
+
+    return *pNumbers;
 }
 
 // by index.
@@ -1414,6 +1289,21 @@ int64_t Nym::GetAcknowledgedNum(const Identifier& theNotaryID, int32_t nIndex)
     return GetGenericNum(m_mapAcknowledgedNum, theNotaryID, nIndex);
 }
 
+const NumberSet& Nym::GetIssuedNums(const Identifier& theNotaryID) const
+{
+    return GetGenericNums(m_mapIssuedNum, theNotaryID);
+}
+
+const NumberSet& Nym::GetTransactionNums(const Identifier& theNotaryID) const
+{
+    return GetGenericNums(m_mapTransNum, theNotaryID);
+}
+
+const NumberSet& Nym::GetAcknowledgedNums(const Identifier& theNotaryID) const
+{
+    return GetGenericNums(m_mapAcknowledgedNum, theNotaryID);
+}
+
 // TRANSACTION NUM
 
 // On the server side: A user has submitted a specific transaction number.
@@ -1608,32 +1498,22 @@ bool Nym::AddAcknowledgedNum(
     // total
     // number of ackNums allowed...
     //
-    std::string strID = strNotaryID.Get();
-
-    // The Pseudonym has a deque of transaction numbers for each server.
-    // These deques are mapped by Notary ID.
-    //
-    // So let's loop through all the deques I have, and if the server ID on the
-    // map
-    // matches the Notary ID that was passed in, then we'll pop the size of the
-    // deque
-    // down to our max size (off the back) before then calling AddGenericNum
-    // which will
-    // push the new request number onto the front.
-    //
-    for (auto& it : m_mapAcknowledgedNum) {
-        // if the NotaryID passed in matches the notaryID for the current deque
-        if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
-
-            while (pDeque->size() > OT_MAX_ACK_NUMS) {
-                pDeque->pop_back();  // This fixes knotwork's issue where he had
-                                     // thousands of ack nums somehow never
-                                     // getting cleared out. Now we have a MAX
-                                     // and always keep it clean otherwise.
-            }
-            break;
+    auto it = m_mapAcknowledgedNum.find(strNotaryID.Get());
+
+    if (m_mapAcknowledgedNum.end() != it) {
+        NumberSet* pNumbers = it->second;
+        OT_ASSERT(nullptr != pNumbers);
+
+        // Drop the oldest (lowest) request numbers down to our max size before
+        // calling AddGenericNum.
+        while (pNumbers->size() > OT_MAX_ACK_NUMS) {
+            pNumbers->Remove(pNumbers->Lowest());  // This fixes knotwork's
+                                                   // issue where he had
+                                                   // thousands of ack nums
+                                                   // somehow never getting
+                                                   // cleared out. Now we have
+                                                   // a MAX and always keep it
+                                                   // clean otherwise.
         }
     }
 
@@ -1778,18 +1658,18 @@ void Nym::HarvestTransactionNumbers(
 
     for (auto& it : theOtherNym.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID = strNotaryID.c_str();
         const Identifier theTempID(OTstrNotaryID);
 
-        if (!(pDeque->empty()) &&
+        if (!(pNumbers->empty()) &&
             (theNotaryID == theTempID))  // only for the matching notaryID.
         {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+            for (const int64_t lNumber : *pNumbers) {
+                lTransactionNumber = lNumber;
 
                 // If number wasn't already on issued list, then add to BOTH
                 // lists.
@@ -1920,17 +1800,17 @@ void Nym::HarvestIssuedNumbers(
 
     for (auto& it : theOtherNym.GetMapIssuedNum()) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID =
             ((strNotaryID.size()) > 0 ? strNotaryID.c_str() : "");
         const Identifier theTempID(OTstrNotaryID);
 
-        if (!(pDeque->empty()) && (theNotaryID == theTempID)) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty()) && (theNotaryID == theTempID)) {
+            for (const int64_t lNumber : *pNumbers) {
+                lTransactionNumber = lNumber;
 
                 // If number wasn't already on issued list, then add to BOTH
                 // lists.
@@ -2013,13 +1893,13 @@ bool Nym::GetNextTransactionNum(
     for (auto& it : m_mapTransNum) {
         // if the NotaryID passed in matches the notaryID for the current deque
         if (strID == it.first) {
-            dequeOfTransNums* pDeque = (it.second);
-            OT_ASSERT(nullptr != pDeque);
+            NumberSet* pNumbers = (it.second);
+            OT_ASSERT(nullptr != pNumbers);
 
-            if (!(pDeque->empty())) {
-                lTransNum = pDeque->back();
+            if (!(pNumbers->empty())) {
+                lTransNum = pNumbers->Lowest();
 
-                pDeque->pop_back();
+                pNumbers->Remove(lTransNum);
 
                 // The call has succeeded
                 bRetVal = true;
@@ -2640,20 +2520,21 @@ void Nym::DisplayStatistics(String& strOutput)
 
     for (auto& it : m_mapIssuedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate(
                 "---- Transaction numbers still signed out from server: %s\n",
                 strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lTransactionNumber = pDeque->at(i);
+            bool bFirst = true;
 
+            for (const int64_t lTransactionNumber : *pNumbers) {
                 strOutput.Concatenate(
-                    0 == i ? "%" PRId64 : ", %" PRId64, lTransactionNumber);
+                    bFirst ? "%" PRId64 : ", %" PRId64, lTransactionNumber);
+                bFirst = false;
             }
             strOutput.Concatenate("\n");
         }
@@ -2661,19 +2542,21 @@ void Nym::DisplayStatistics(String& strOutput)
 
     for (auto& it : m_mapTransNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate(
                 "---- Transaction numbers still usable on server: %s\n",
                 strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lTransactionNumber = pDeque->at(i);
+            bool bFirst = true;
+
+            for (const int64_t lTransactionNumber : *pNumbers) {
                 strOutput.Concatenate(
-                    0 == i ? "%" PRId64 : ", %" PRId64, lTransactionNumber);
+                    bFirst ? "%" PRId64 : ", %" PRId64, lTransactionNumber);
+                bFirst = false;
             }
             strOutput.Concatenate("\n");
         }
@@ -2681,20 +2564,22 @@ void Nym::DisplayStatistics(String& strOutput)
 
     for (auto& it : m_mapAcknowledgedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             strOutput.Concatenate(
                 "---- Request numbers for which Nym has "
                 "already received a reply from server: %s\n",
                 strNotaryID.c_str());
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                int64_t lRequestNumber = pDeque->at(i);
+            bool bFirst = true;
+
+            for (const int64_t lRequestNumber : *pNumbers) {
                 strOutput.Concatenate(
-                    0 == i ? "%" PRId64 : ", %" PRId64, lRequestNumber);
+                    bFirst ? "%" PRId64 : ", %" PRId64, lRequestNumber);
+                bFirst = false;
             }
             strOutput.Concatenate("\n");
         }
@@ -2924,7 +2809,7 @@ bool Nym::LoadCredentials(
 
     String strNymID;
     GetIdentifier(strNymID);
-    std::shared_ptr<proto::CredentialIndex> index;
+    std::shared_ptr<const proto::CredentialIndex> index;
 
     if (App::Me().DB().Load(strNymID.Get(), index)) {
         return LoadCredentialIndex(*index);
@@ -3126,24 +3011,16 @@ bool Nym::SavePseudonym(String& strNym)
             "FOR DELETION AT ITS OWN REQUEST");
     }
 
-    int64_t lTransactionNumber = 0;
-
     for (auto& it : m_mapTransNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
-
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
+            // Same comma-separated form as NumList, in the same order.
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3155,24 +3032,16 @@ bool Nym::SavePseudonym(String& strNym)
         }
     }  // for
 
-    lTransactionNumber = 0;
-
     for (auto& it : m_mapIssuedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
+        OT_ASSERT(nullptr != pNumbers);
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
+            // Same comma-separated form as NumList, in the same order.
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3184,24 +3053,16 @@ bool Nym::SavePseudonym(String& strNym)
         }
     }  // for
 
-    lTransactionNumber = 0;
-
     for (auto& it : m_mapTentativeNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
+        OT_ASSERT(nullptr != pNumbers);
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
-                theList.Add(lTransactionNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
+            // Same comma-separated form as NumList, in the same order.
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -3222,20 +3083,14 @@ bool Nym::SavePseudonym(String& strNym)
     //
     for (auto& it : m_mapAcknowledgedNum) {
         std::string strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
 
-        if (!(pDeque->empty()) && (strNotaryID.size() > 0)) {
-            NumList theList;
+        OT_ASSERT(nullptr != pNumbers);
 
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                const int64_t lRequestNumber = pDeque->at(i);
-                theList.Add(lRequestNumber);
-            }
+        if (!(pNumbers->empty()) && (strNotaryID.size() > 0)) {
+            // Same comma-separated form as NumList, in the same order.
             String strTemp;
-            if ((theList.Count() > 0) && theList.Output(strTemp) &&
-                strTemp.Exists()) {
+            if (pNumbers->Output(strTemp) && strTemp.Exists()) {
                 const OTASCIIArmor ascTemp(strTemp);
 
                 if (ascTemp.Exists()) {
@@ -4344,6 +4199,15 @@ bool Nym::LoadSignedNymfile(Nym& SIGNER_NYM)
     return false;
 }
 
+std::mutex Nym::nymfile_callback_lock_;
+NymfileCallback Nym::nymfile_callback_;
+
+void Nym::SetNymfileCallback(const NymfileCallback& callback)
+{
+    std::lock_guard<std::mutex> lock(nymfile_callback_lock_);
+    nymfile_callback_ = callback;
+}
+
 bool Nym::SaveSignedNymfile(Nym& SIGNER_NYM)
 {
     // Get the Nym's ID in string form
@@ -4376,6 +4240,19 @@ bool Nym::SaveSignedNymfile(Nym& SIGNER_NYM)
                   << strNymID << " using Signer Nym " << strSignerNymID << "\n";
         }
 
+        NymfileCallback callback;
+
+        {
+            std::lock_guard<std::mutex> lock(nymfile_callback_lock_);
+            callback = nymfile_callback_;
+        }
+
+        // A failed write may have left anything on disk
+        if (callback) {
+            callback(
+                strNymID, bSaved ? theNymfile.GetFilePayload() : String());
+        }
+
         return bSaved;
     } else {
         String strSignerNymID;
@@ -4403,12 +4280,12 @@ bool Nym::VerifyIssuedNumbersOnNym(Nym& THE_NYM)
     // numbers total he has...
     //
     for (auto& it : GetMapIssuedNum()) {
-        dequeOfTransNums* pDeque = (it.second);
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = (it.second);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
+        if (!(pNumbers->empty())) {
             nNumberOfTransactionNumbers1 +=
-                static_cast<int32_t>(pDeque->size());
+                static_cast<int32_t>(pNumbers->size());
         }
     }  // for
 
@@ -4418,14 +4295,14 @@ bool Nym::VerifyIssuedNumbersOnNym(Nym& THE_NYM)
     //
     for (auto& it : THE_NYM.GetMapIssuedNum()) {
         strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
-        OT_ASSERT(nullptr != pDeque);
+        NumberSet* pNumbers = it.second;
+        OT_ASSERT(nullptr != pNumbers);
 
         String OTstrNotaryID = strNotaryID.c_str();
 
-        if (!(pDeque->empty())) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty())) {
+            for (const int64_t lNumber : *pNumbers) {
+                lTransactionNumber = lNumber;
 
                 //                if ()
                 {
@@ -4489,15 +4366,15 @@ bool Nym::VerifyTransactionStatementNumbersOnNym(Nym& THE_NYM)  // THE_NYM is
     //
     for (auto& it : GetMapIssuedNum()) {
         strNotaryID = it.first;
-        dequeOfTransNums* pDeque = it.second;
+        NumberSet* pNumbers = it.second;
 
         String OTstrNotaryID = strNotaryID.c_str();
 
-        OT_ASSERT(nullptr != pDeque);
+        OT_ASSERT(nullptr != pNumbers);
 
-        if (!(pDeque->empty())) {
-            for (uint32_t i = 0; i < pDeque->size(); i++) {
-                lTransactionNumber = pDeque->at(i);
+        if (!(pNumbers->empty())) {
+            for (const int64_t lNumber : *pNumbers) {
+                lTransactionNumber = lNumber;
 
                 if (false ==
                     THE_NYM.VerifyIssuedNum(
@@ -3393,20 +3393,14 @@ OTTransaction* OTTransaction::GenerateTransaction(
 
 OTTransaction::~OTTransaction()
 {
-    while (!m_listItems.empty()) {
-        Item* pItem = m_listItems.front();
-        m_listItems.pop_front();
-        delete pItem;
-    }
+    for (auto& it : m_listItems) delete it;
+    m_listItems.clear();
 }
 
 void OTTransaction::Release()
 {
-    while (!m_listItems.empty()) {
-        Item* pItem = m_listItems.front();
-        m_listItems.pop_front();
-        delete pItem;
-    }
+    for (auto& it : m_listItems) delete it;
+    m_listItems.clear();
 
     OTTransactionType::Release();
 }
@@ -145,6 +145,34 @@ void App::Init_Storage()
         config.gc_interval_,
         config.gc_interval_,
         notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "gc_slice_keys",
+        config.gc_slice_keys_,
+        config.gc_slice_keys_,
+        notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "gc_slice_pause",
+        config.gc_slice_pause_,
+        config.gc_slice_pause_,
+        notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "cache_bytes",
+        config.cache_bytes_,
+        config.cache_bytes_,
+        notUsed);
+
+    // A negative size would wrap around to a huge limit. Disable the cache.
+    if (0 > config.cache_bytes_) { config.cache_bytes_ = 0; }
+
+    Config().CheckSet_long(
+        "storage",
+        "map_threads",
+        config.map_threads_,
+        config.map_threads_,
+        notUsed);
     Config().CheckSet_str(
         "storage", "path", String(config.path_), config.path_, notUsed);
 #ifdef OT_STORAGE_FS
@@ -199,6 +227,38 @@ void App::Init_Storage()
         config.sqlite3_db_file_,
         notUsed);
 #endif
+#ifdef OT_STORAGE_LMDB
+    Config().CheckSet_str(
+        "storage",
+        "lmdb_primary",
+        String(config.lmdb_primary_bucket_),
+        config.lmdb_primary_bucket_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "lmdb_secondary",
+        String(config.lmdb_secondary_bucket_),
+        config.lmdb_secondary_bucket_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "lmdb_control",
+        String(config.lmdb_control_table_),
+        config.lmdb_control_table_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "lmdb_root_key",
+        String(config.lmdb_root_key_),
+        config.lmdb_root_key_,
+        notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "lmdb_map_size",
+        config.lmdb_map_size_,
+        config.lmdb_map_size_,
+        notUsed);
+#endif
 
     if (nullptr != dht_) {
         config.dht_callback_ = std::bind(
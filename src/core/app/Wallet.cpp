@@ -65,7 +65,7 @@ ConstNym Wallet::Nym(
     bool valid = false;
 
     if (!inMap) {
-        std::shared_ptr<proto::CredentialIndex> serialized;
+        std::shared_ptr<const proto::CredentialIndex> serialized;
 
         std::string alias;
         bool loaded = App::Me().DB().Load(nym, serialized, alias, true);
@@ -148,12 +148,12 @@ ConstNym Wallet::Nym(const proto::CredentialIndex& publicNym)
     return Nym(Identifier(nym));
 }
 
-std::shared_ptr<proto::PeerReply> Wallet::PeerReply(
+std::shared_ptr<const proto::PeerReply> Wallet::PeerReply(
     const Identifier& nym,
     const Identifier& reply,
     const StorageBox& box) const
 {
-    std::shared_ptr<proto::PeerReply> output;
+    std::shared_ptr<const proto::PeerReply> output;
 
     App::Me().DB().Load(
         String(nym).Get(),
@@ -169,7 +169,7 @@ bool Wallet::PeerReplyComplete(
     const Identifier& replyID)
 {
     const std::string nymID = String(nym).Get();
-    std::shared_ptr<proto::PeerReply> reply;
+    std::shared_ptr<const proto::PeerReply> reply;
     const bool haveReply =
         App::Me().DB().Load(
             nymID,
@@ -196,7 +196,7 @@ bool Wallet::PeerReplyCreate(
     const proto::PeerReply& reply)
 {
     const std::string nymID = String(nym).Get();
-    std::shared_ptr<proto::PeerRequest> request;
+    std::shared_ptr<const proto::PeerRequest> request;
     const bool haveRequest =
         App::Me().DB().Load(
             nymID,
@@ -243,7 +243,7 @@ bool Wallet::PeerReplyCreateRollback(
     const std::string nymID = String(nym).Get();
     const std::string requestID = String(request).Get();
     const std::string replyID = String(reply).Get();
-    std::shared_ptr<proto::PeerRequest> requestItem;
+    std::shared_ptr<const proto::PeerRequest> requestItem;
     const bool loadedRequest = App::Me().DB().Load(
         nymID, requestID, StorageBox::PROCESSEDPEERREQUEST, requestItem);
 
@@ -275,7 +275,7 @@ bool Wallet::PeerReplyReceive(
     const proto::PeerReply& reply)
 {
     const std::string nymID = String(nym).Get();
-    std::shared_ptr<proto::PeerRequest> request;
+    std::shared_ptr<const proto::PeerRequest> request;
     const bool haveRequest =
         App::Me().DB().Load(
             nymID,
@@ -300,12 +300,12 @@ bool Wallet::PeerReplyReceive(
         nymID, StorageBox::SENTPEERREQUEST, String(requestID).Get());
 }
 
-std::shared_ptr<proto::PeerRequest> Wallet::PeerRequest(
+std::shared_ptr<const proto::PeerRequest> Wallet::PeerRequest(
     const Identifier& nym,
     const Identifier& request,
     const StorageBox& box) const
 {
-    std::shared_ptr<proto::PeerRequest> output;
+    std::shared_ptr<const proto::PeerRequest> output;
 
     App::Me().DB().Load(
         String(nym).Get(),
@@ -321,7 +321,7 @@ bool Wallet::PeerRequestComplete(
     const Identifier& replyID)
 {
     const std::string nymID = String(nym).Get();
-    std::shared_ptr<proto::PeerReply> reply;
+    std::shared_ptr<const proto::PeerReply> reply;
     const bool haveReply =
         App::Me().DB().Load(
             nymID,
@@ -409,7 +409,7 @@ ConstServerContract Wallet::Server(
     bool valid = false;
 
     if (!inMap) {
-        std::shared_ptr<proto::ServerContract> serialized;
+        std::shared_ptr<const proto::ServerContract> serialized;
 
         std::string alias;
         bool loaded = App::Me().DB().Load(server, serialized, alias, true);
@@ -578,7 +578,7 @@ ConstUnitDefinition Wallet::UnitDefinition(
     bool valid = false;
 
     if (!inMap) {
-        std::shared_ptr<proto::UnitDefinition> serialized;
+        std::shared_ptr<const proto::UnitDefinition> serialized;
 
         std::string alias;
         bool loaded = App::Me().DB().Load(unit, serialized, alias, true);
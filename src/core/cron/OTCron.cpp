@@ -47,6 +47,7 @@
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/cron/OTCronItem.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
+#include "opentxs/core/crypto/OTSignedFile.hpp"
 #include "opentxs/core/trade/OTMarket.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/Common.hpp"
@@ -55,12 +56,16 @@
 #include "opentxs/core/util/Tag.hpp"
 #include "opentxs/core/util/Timer.hpp"
 
+#include <inttypes.h>
 #include <irrxml/irrXML.hpp>
 #include <string.h>
 #include <cstdint>
+#include <fstream>
+#include <list>
 #include <map>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <utility>
 
@@ -92,10 +97,17 @@ bool OTCron::LoadCron()
 
     OT_ASSERT(nullptr != GetServerNym());
 
+    // Loading the cron file also reads the journal. (See ProcessXMLNode.)
     bool bSuccess = LoadContract(szFoldername, szFilename);
 
     if (bSuccess) bSuccess = VerifySignature(*(GetServerNym()));
 
+    if (bSuccess) ReplayJournal();
+
+    m_mapJournalItems.clear();
+    m_setJournalRemovals.clear();
+    m_listJournalNumbers.clear();
+
     return bSuccess;
 }
 
@@ -103,21 +115,271 @@ bool OTCron::SaveCron()
 {
     const char* szFoldername = OTFolders::Cron().Get();
     const char* szFilename = "OT-CRON.crn"; // todo stop hardcoding filenames.
+    const char* szJournal = "OT-CRON.jrn";
 
     OT_ASSERT(nullptr != GetServerNym());
 
     ReleaseSignatures();
 
+    // Everything in the journal is about to be in the cron file, so the
+    // journal starts a new generation. (If we crash before emptying it below,
+    // the old records are ignored next time, since their generation is stale.)
+    m_lJournalGeneration++;
+
     // Sign it, save it internally to string, and then save that out to the
     // file.
     if (!SignContract(*m_pServerNym) || !SaveContract() ||
         !SaveContract(szFoldername, szFilename)) {
         otErr << "Error saving main Cronfile:\n" << szFoldername
               << Log::PathSeparator() << szFilename << "\n";
+        m_lJournalGeneration--;
         return false;
     }
-    else
-        return true;
+
+    std::string strPath;
+
+    if (0 <= OTDB::FormPathString(strPath, szFoldername, szJournal)) {
+        std::ofstream ofs(strPath.c_str(),
+                          std::ios::out | std::ios::trunc | std::ios::binary);
+    }
+
+    m_nJournalRecords = 0;
+
+    return true;
+}
+
+bool OTCron::SaveCronItem(OTCronItem& theItem)
+{
+    auto it = m_mapItemPositions.find(theItem.GetTransactionNum());
+
+    if (m_mapItemPositions.end() == it) {
+        otErr << __FUNCTION__ << ": Item is not on Cron: "
+              << theItem.GetTransactionNum() << "\n";
+        return false;
+    }
+
+    const time64_t tDateAdded = it->second.added_->first;
+    String strItem(theItem);
+    OTASCIIArmor ascItem;
+    ascItem.SetString(strItem, false);
+
+    String strData;
+    strData.Format("%" PRId64 " %" PRId64 "\n%s", theItem.GetTransactionNum(),
+                   OTTimeGetSecondsFromTime(tDateAdded), ascItem.Get());
+
+    return AppendJournal("item", strData);
+}
+
+bool OTCron::SaveTransactionNumbers()
+{
+    String strData;
+
+    for (auto& lTransactionNumber : m_listTransactionNumbers) {
+        strData.Concatenate("%" PRId64 " ", lTransactionNumber);
+    }
+
+    return AppendJournal("numbers", strData);
+}
+
+bool OTCron::SaveCronRemovals(const listOfLongNumbers& theRemovals)
+{
+    String strData;
+
+    for (auto& lTransactionNumber : theRemovals) {
+        strData.Concatenate("%" PRId64 " ", lTransactionNumber);
+    }
+
+    return AppendJournal("remove", strData);
+}
+
+// Each journal record is one line: a signed file, armored without line
+// breaks. Its payload is "generation action nextNumber", a newline, and then
+// the action's data. nextNumber is the transaction number at the front of
+// m_listTransactionNumbers (0 if empty), since Cron uses up numbers without
+// saving.
+//
+bool OTCron::AppendJournal(const char* szAction, const String& strData)
+{
+    const char* szFoldername = OTFolders::Cron().Get();
+    const char* szFilename = "OT-CRON.crn";
+    const char* szJournal = "OT-CRON.jrn";
+
+    OT_ASSERT(nullptr != GetServerNym());
+
+    // Without a cron file, there's nothing to append to. And once the
+    // journal is as big as the cron file would be, it's time to compact.
+    const int32_t nCompactAt =
+        (100 > static_cast<int32_t>(m_mapCronItems.size()))
+            ? 100
+            : static_cast<int32_t>(m_mapCronItems.size());
+
+    if (!OTDB::Exists(szFoldername, szFilename) ||
+        (m_nJournalRecords >= nCompactAt)) {
+        return SaveCron();
+    }
+
+    String strPayload;
+    strPayload.Format("%" PRId64 " %s %" PRId64 "\n%s", m_lJournalGeneration,
+                      szAction, m_listTransactionNumbers.empty()
+                                    ? static_cast<int64_t>(0)
+                                    : m_listTransactionNumbers.front(),
+                      strData.Get());
+
+    OTSignedFile theRecord(szFoldername, szJournal);
+    theRecord.SetFilePayload(strPayload);
+
+    if (!theRecord.SignContract(*m_pServerNym) || !theRecord.SaveContract()) {
+        otErr << __FUNCTION__ << ": Error signing cron journal record.\n";
+        return false;
+    }
+
+    String strRecord;
+    theRecord.SaveContractRaw(strRecord);
+    OTASCIIArmor ascRecord;
+    ascRecord.SetString(strRecord, false);
+
+    std::string strPath;
+
+    if (0 > OTDB::FormPathString(strPath, szFoldername, szJournal)) {
+        otErr << __FUNCTION__ << ": Error forming path for cron journal.\n";
+        return false;
+    }
+
+    std::ofstream ofs(strPath.c_str(),
+                      std::ios::out | std::ios::app | std::ios::binary);
+    ofs << ascRecord.Get() << "\n";
+    ofs.flush();
+
+    if (!ofs.good()) {
+        otErr << __FUNCTION__ << ": Error writing cron journal: " << strPath
+              << "\n";
+        return false;
+    }
+
+    m_nJournalRecords++;
+
+    return true;
+}
+
+// Reads the journal records of the current generation, so ProcessXMLNode can
+// use the newest version of each cron item while loading the cron file.
+//
+void OTCron::ReadJournal()
+{
+    const char* szFoldername = OTFolders::Cron().Get();
+    const char* szJournal = "OT-CRON.jrn";
+
+    m_mapJournalItems.clear();
+    m_setJournalRemovals.clear();
+    m_listJournalNumbers.clear();
+    m_bJournalHasNumbers = false;
+    m_lJournalNextNumber = -1;
+    m_nJournalRecords = 0;
+
+    if (!OTDB::Exists(szFoldername, szJournal)) return;
+
+    std::string strPath;
+
+    if (0 > OTDB::FormPathString(strPath, szFoldername, szJournal)) return;
+
+    std::ifstream ifs(strPath.c_str(), std::ios::in | std::ios::binary);
+    std::string strLine;
+
+    while (std::getline(ifs, strLine)) {
+        if (strLine.empty()) continue;
+
+        // A torn write at the end of the journal stops the replay there.
+        OTASCIIArmor ascRecord(strLine.c_str());
+        String strRecord;
+        OTSignedFile theRecord(szFoldername, szJournal);
+
+        if (!ascRecord.GetString(strRecord) ||
+            !theRecord.LoadContractFromString(strRecord) ||
+            !theRecord.VerifyFile() ||
+            !theRecord.VerifySignature(*m_pServerNym)) {
+            otErr << __FUNCTION__ << ": Bad record in cron journal. Ignoring "
+                                     "it and the rest of the journal.\n";
+            break;
+        }
+
+        std::istringstream issRecord(theRecord.GetFilePayload().Get());
+        int64_t lGeneration = 0, lNextNumber = 0;
+        std::string strAction;
+        issRecord >> lGeneration >> strAction >> lNextNumber;
+
+        if (lGeneration != m_lJournalGeneration) continue;
+
+        m_nJournalRecords++;
+        m_lJournalNextNumber = lNextNumber;
+
+        if ("item" == strAction) {
+            int64_t lTransactionNum = 0, lDateAdded = 0;
+            std::string strItem;
+            issRecord >> lTransactionNum >> lDateAdded >> strItem;
+
+            m_mapJournalItems[lTransactionNum] = std::make_pair(
+                OTTimeGetTimeFromSeconds(lDateAdded), String(strItem));
+        }
+        else if ("remove" == strAction) {
+            int64_t lTransactionNum = 0;
+
+            while (issRecord >> lTransactionNum) {
+                m_mapJournalItems.erase(lTransactionNum);
+                m_setJournalRemovals.insert(lTransactionNum);
+            }
+        }
+        else if ("numbers" == strAction) {
+            int64_t lTransactionNum = 0;
+            m_listJournalNumbers.clear();
+            m_bJournalHasNumbers = true;
+
+            while (issRecord >> lTransactionNum) {
+                m_listJournalNumbers.push_back(lTransactionNum);
+            }
+        }
+    }
+}
+
+// After the cron file is loaded, adds the items which only exist in the
+// journal, and brings the transaction numbers up to date.
+//
+void OTCron::ReplayJournal()
+{
+    for (auto& it : m_mapJournalItems) {
+        const time64_t& tDateAdded = it.second.first;
+        const OTASCIIArmor ascItem(it.second.second.Get());
+        String strItem;
+        OTCronItem* pItem = nullptr;
+
+        if (ascItem.GetString(strItem))
+            pItem = OTCronItem::NewCronItem(strItem);
+
+        if (nullptr == pItem) {
+            otErr << __FUNCTION__ << ": Unable to create cron item from data "
+                                     "in cron journal: " << it.first << "\n";
+            continue;
+        }
+
+        if (!pItem->VerifySignature(*m_pServerNym) ||
+            !AddCronItem(*pItem, nullptr, false, tDateAdded)) {
+            otErr << __FUNCTION__ << ": Unable to verify or add cron item from "
+                                     "cron journal: " << it.first << "\n";
+            delete pItem;
+            pItem = nullptr;
+        }
+    }
+
+    if (m_bJournalHasNumbers) m_listTransactionNumbers = m_listJournalNumbers;
+
+    // Drop any numbers which were used up before the last record was written.
+    if (0 == m_lJournalNextNumber)
+        m_listTransactionNumbers.clear();
+    else if (0 < m_lJournalNextNumber) {
+        while (!m_listTransactionNumbers.empty() &&
+               (m_listTransactionNumbers.front() != m_lJournalNextNumber)) {
+            m_listTransactionNumbers.pop_front();
+        }
+    }
 }
 
 // Loops through ALL markets, and calls pMarket->GetNym_OfferList(NYM_ID,
@@ -380,8 +642,14 @@ int32_t OTCron::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
 
         m_NOTARY_ID.SetString(strNotaryID);
 
+        const String strGeneration(xml->getAttributeValue("journalGeneration"));
+        m_lJournalGeneration =
+            strGeneration.Exists() ? strGeneration.ToLong() : 0;
+
         otOut << "\n\nLoading OTCron for NotaryID: " << strNotaryID << "\n";
 
+        ReadJournal();
+
         nReturnVal = 1;
     }
     else if (!strcmp("transactionNum", xml->getNodeName())) {
@@ -420,6 +688,40 @@ int32_t OTCron::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
                 return (-1);
             }
 
+            // The journal may have removed this item, or have a newer version
+            // of it, since the cron file was saved.
+            const int64_t lTransactionNum = pItem->GetTransactionNum();
+            auto it_journal = m_mapJournalItems.find(lTransactionNum);
+
+            if (m_setJournalRemovals.end() !=
+                m_setJournalRemovals.find(lTransactionNum)) {
+                otInfo << "Cron item was removed since the cron file was "
+                          "saved: " << lTransactionNum << "\n";
+                delete pItem;
+                pItem = nullptr;
+                return 1;
+            }
+            else if (m_mapJournalItems.end() != it_journal) {
+                const OTASCIIArmor ascItem(it_journal->second.second.Get());
+                String strItem;
+                OTCronItem* pNewerItem = nullptr;
+
+                if (ascItem.GetString(strItem))
+                    pNewerItem = OTCronItem::NewCronItem(strItem);
+
+                if (nullptr == pNewerItem) {
+                    otErr << "Unable to create cron item from data in cron "
+                             "journal.\n";
+                    delete pItem;
+                    pItem = nullptr;
+                    return (-1);
+                }
+
+                delete pItem;
+                pItem = pNewerItem;
+                m_mapJournalItems.erase(it_journal);
+            }
+
             // Why not do this here (when loading from storage), as well as when
             // first adding the item to cron,
             // and thus save myself the trouble of verifying the signature EVERY
@@ -522,6 +824,7 @@ void OTCron::UpdateContents()
 
     tag.add_attribute("version", m_strVersion.Get());
     tag.add_attribute("notaryID", NOTARY_ID.Get());
+    tag.add_attribute("journalGeneration", formatLong(m_lJournalGeneration));
 
     // Save the Market entries (the markets themselves are saved in a markets
     // folder.)
@@ -609,13 +912,23 @@ void OTCron::ProcessCronItems()
                  "ROUND!!!\n\n";
         return;
     }
-    bool bNeedToSave = false;
+    listOfLongNumbers listRemovedItems;
+
+    // Only the items which are due get processed this round. (The others
+    // would just return true without doing anything.) They are collected
+    // first, since processing an item reschedules it.
+    const time64_t tNow = OTTimeGetCurrentTime();
+    std::list<int64_t> listDueItems;
+
+    for (auto it = m_multimapDueItems.begin();
+         (m_multimapDueItems.end() != it) && (it->first <= tNow); ++it) {
+        listDueItems.push_back(it->second->GetTransactionNum());
+    }
 
     // loop through the cron items and tell each one to ProcessCron().
     // If the item returns true, that means leave it on the list. Otherwise,
     // if it returns false, that means "it's done: remove it."
-    for (auto it = m_multimapCronItems.begin();
-         it != m_multimapCronItems.end();) {
+    for (const auto& lTransactionNum : listDueItems) {
         if (GetTransactionCount() <= nTwentyPercent) {
             otErr << "WARNING: Cron has fewer than 20 percent of its normal "
                      "transaction "
@@ -630,30 +943,32 @@ void OTCron::ProcessCronItems()
                      "SCHEDULED FOR THIS ROUND!!!\n\n";
             break;
         }
-        OTCronItem* pItem = it->second;
+        auto it_map = FindItemOnMap(lTransactionNum);
+
+        if (m_mapCronItems.end() == it_map) continue;  // Already removed.
+
+        OTCronItem* pItem = it_map->second;
         OT_ASSERT(nullptr != pItem);
         otInfo << "OTCron::" << __FUNCTION__
                << ": Processing item number: " << pItem->GetTransactionNum()
                << " \n";
 
         if (pItem->ProcessCron()) {
-            it++;
+            ScheduleCronItem(*pItem);
             continue;
         }
         pItem->HookRemovalFromCron(nullptr, GetNextTransactionNumber());
         otOut << "OTCron::" << __FUNCTION__
               << ": Removing cron item: " << pItem->GetTransactionNum() << "\n";
-        it = m_multimapCronItems.erase(it);
-        auto it_map = FindItemOnMap(pItem->GetTransactionNum());
-        OT_ASSERT(m_mapCronItems.end() != it_map);
+        EraseItemPosition(lTransactionNum);
         m_mapCronItems.erase(it_map);
 
         delete pItem;
         pItem = nullptr;
 
-        bNeedToSave = true;
+        listRemovedItems.push_back(lTransactionNum);
     }
-    if (bNeedToSave) SaveCron();
+    if (!listRemovedItems.empty()) SaveCronRemovals(listRemovedItems);
 }
 
 // OTCron IS responsible for cleaning up theItem, and takes ownership.
@@ -702,11 +1017,15 @@ bool OTCron::AddCronItem(OTCronItem& theItem, Nym* pActivator,
 
         // Insert to the MULTIMAP (by Date)
         //
-        m_multimapCronItems.insert(
+        ItemPosition& thePosition =
+            m_mapItemPositions[theItem.GetTransactionNum()];
+        thePosition.added_ = m_multimapCronItems.insert(
             m_multimapCronItems.upper_bound(tDateAdded),
             std::pair<time64_t, OTCronItem*>(tDateAdded, &theItem));
+        thePosition.due_ = m_multimapDueItems.end();
 
         theItem.SetCronPointer(*this);
+        ScheduleCronItem(theItem);
         theItem.setServerNym(m_pServerNym);
         theItem.setNotaryID(&m_NOTARY_ID);
 
@@ -743,7 +1062,7 @@ bool OTCron::AddCronItem(OTCronItem& theItem, Nym* pActivator,
             //            theItem.SaveContract();
 
             // Since we added an item to the Cron, we SAVE it.
-            bSuccess = SaveCron();
+            bSuccess = SaveCronItem(theItem);
 
             if (bSuccess)
                 otOut << __FUNCTION__
@@ -794,12 +1113,12 @@ bool OTCron::RemoveCronItem(int64_t lTransactionNum,
         pItem->HookRemovalFromCron(&theRemover, GetNextTransactionNumber());
 
         m_mapCronItems.erase(it_map);           // Remove from MAP.
-        m_multimapCronItems.erase(it_multimap); // Remove from MULTIMAP.
+        EraseItemPosition(lTransactionNum);     // Remove from MULTIMAP.
 
         delete pItem;
 
         // An item has been removed from Cron. SAVE.
-        return SaveCron();
+        return SaveCronRemovals(listOfLongNumbers(1, lTransactionNum));
     }
 
     return false;
@@ -844,18 +1163,48 @@ mapOfCronItems::iterator OTCron::FindItemOnMap(int64_t lTransactionNum)
 multimapOfCronItems::iterator OTCron::FindItemOnMultimap(
     int64_t lTransactionNum)
 {
-    auto itt = m_multimapCronItems.begin();
+    auto itt = m_mapItemPositions.find(lTransactionNum);
 
-    while (m_multimapCronItems.end() != itt) {
-        OTCronItem* pItem = itt->second;
-        OT_ASSERT((nullptr != pItem));
+    if (m_mapItemPositions.end() == itt) return m_multimapCronItems.end();
 
-        if (pItem->GetTransactionNum() == lTransactionNum) break;
+    return itt->second.added_;
+}
 
-        ++itt;
-    }
+// Moves theItem to wherever its GetNextDueDate() now puts it on
+// m_multimapDueItems. Does nothing if theItem isn't on this Cron.
+//
+void OTCron::ScheduleCronItem(OTCronItem& theItem)
+{
+    auto itt = m_mapItemPositions.find(theItem.GetTransactionNum());
 
-    return itt;
+    if (m_mapItemPositions.end() == itt) return;
+
+    ItemPosition& thePosition = itt->second;
+
+    if (&theItem != thePosition.added_->second) return;
+
+    if (m_multimapDueItems.end() != thePosition.due_)
+        m_multimapDueItems.erase(thePosition.due_);
+
+    thePosition.due_ = m_multimapDueItems.insert(
+        std::pair<time64_t, OTCronItem*>(theItem.GetNextDueDate(),
+                                         &theItem));
+}
+
+// Removes the item from both multimaps. (Not from m_mapCronItems.)
+//
+void OTCron::EraseItemPosition(int64_t lTransactionNum)
+{
+    auto itt = m_mapItemPositions.find(lTransactionNum);
+
+    if (m_mapItemPositions.end() == itt) return;
+
+    m_multimapCronItems.erase(itt->second.added_);
+
+    if (m_multimapDueItems.end() != itt->second.due_)
+        m_multimapDueItems.erase(itt->second.due_);
+
+    m_mapItemPositions.erase(itt);
 }
 
 // Look up a transaction by transaction number and see if it is in the map.
@@ -1114,6 +1463,11 @@ OTCron::~OTCron()
 void OTCron::InitCron()
 {
     m_strContractType = "CRON";
+
+    m_lJournalGeneration = 0;
+    m_nJournalRecords = 0;
+    m_bJournalHasNumbers = false;
+    m_lJournalNextNumber = -1;
 }
 
 void OTCron::Release()
@@ -1135,6 +1489,9 @@ void OTCron::Release_Cron()
         // same pItems being deleted in the next block.
     }
 
+    m_multimapDueItems.clear();
+    m_mapItemPositions.clear();
+
     while (!m_mapCronItems.empty()) {
         OTCronItem* pItem = m_mapCronItems.begin()->second;
         auto it = m_mapCronItems.begin();
@@ -49,6 +49,7 @@
 #include "opentxs/core/OTStorage.hpp"
 #include "opentxs/core/OTTransaction.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/cron/OTCron.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/recurring/OTPaymentPlan.hpp"
 #include "opentxs/core/script/OTSmartContract.hpp"
@@ -706,6 +707,26 @@ bool OTCronItem::ProcessCron()
     return true;
 }
 
+void OTCronItem::FlagForRemoval()
+{
+    m_bRemovalFlag = true;
+
+    // Have Cron look at this item on its next round, instead of waiting for
+    // the process interval to pass.
+    if (nullptr != m_pCron) m_pCron->ScheduleCronItem(*this);
+}
+
+time64_t OTCronItem::GetNextDueDate() const
+{
+    if (IsFlaggedForRemoval() || (OT_TIME_ZERO == GetLastProcessDate()))
+        return OT_TIME_ZERO;
+
+    // ProcessCron() only does something once MORE than the interval has
+    // passed.
+    return OTTimeAddTimeInterval(GetLastProcessDate(),
+                                 GetProcessInterval() + 1);
+}
+
 // OTCron calls this when a cron item is added.
 // bForTheFirstTime=true means that this cron item is being
 // activated for the very first time. (Versus being re-added
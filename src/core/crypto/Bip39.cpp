@@ -264,9 +264,12 @@ std::shared_ptr<proto::Seed> Bip39::SerializedSeed(
         }
 
     } else { // want an explicitly identified seed
-        const bool loaded = App::Me().DB().Load(fingerprint, serialized);
+        std::shared_ptr<const proto::Seed> stored;
+        const bool loaded = App::Me().DB().Load(fingerprint, stored);
 
-        if (loaded && serialized) {
+        if (loaded && stored) {
+            // Storage shares the object it loads, so decrypt a copy
+            serialized.reset(new proto::Seed(*stored));
             DecryptSeed(*serialized);
         }
     }
@@ -522,7 +522,7 @@ bool CredentialSet::Load_Master(
     const String& strMasterCredID,
     __attribute__((unused)) const OTPasswordData* pPWData)
 {
-    std::shared_ptr<proto::Credential> master;
+    std::shared_ptr<const proto::Credential> master;
     bool loaded = App::Me().DB().Load(strMasterCredID.Get(), master);
 
     if (!loaded) {
@@ -592,7 +592,7 @@ bool CredentialSet::LoadChildKeyCredential(const String& strSubID)
 
     OT_ASSERT(GetNymID().Exists());
 
-    std::shared_ptr<proto::Credential> child;
+    std::shared_ptr<const proto::Credential> child;
     bool loaded = App::Me().DB().Load(strSubID.Get(), child);
 
     if (!loaded) {
@@ -75,6 +75,149 @@ std::string CryptoUtil::BreakLines(const std::string& input)
     return output;
 }
 
+std::string CryptoUtil::Base64Encode(
+    const std::uint8_t* inputStart,
+    const size_t& size,
+    const bool& breakLines)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string output;
+    const size_t encodedSize = 4 * ((size + 2) / 3);
+    output.reserve(
+        breakLines ? encodedSize + (encodedSize / LineWidth) + 1
+                   : encodedSize);
+
+    size_t width = 0;
+    auto append = [&](const char character) {
+        output.push_back(character);
+
+        if (breakLines && (++width >= LineWidth)) {
+            output.push_back('\n');
+            width = 0;
+        }
+    };
+
+    size_t i = 0;
+
+    for (; (i + 2) < size; i += 3) {
+        const std::uint32_t block = (std::uint32_t(inputStart[i]) << 16) |
+                                    (std::uint32_t(inputStart[i + 1]) << 8) |
+                                    std::uint32_t(inputStart[i + 2]);
+        append(alphabet[(block >> 18) & 0x3f]);
+        append(alphabet[(block >> 12) & 0x3f]);
+        append(alphabet[(block >> 6) & 0x3f]);
+        append(alphabet[block & 0x3f]);
+    }
+
+    const size_t remaining = size - i;
+
+    if (0 < remaining) {
+        std::uint32_t block = std::uint32_t(inputStart[i]) << 16;
+
+        if (2 == remaining) {
+            block |= std::uint32_t(inputStart[i + 1]) << 8;
+        }
+
+        append(alphabet[(block >> 18) & 0x3f]);
+        append(alphabet[(block >> 12) & 0x3f]);
+        append((2 == remaining) ? alphabet[(block >> 6) & 0x3f] : '=');
+        append('=');
+    }
+
+    if (breakLines && (0 != width)) {
+        output.push_back('\n');
+    }
+
+    return output;
+}
+
+bool CryptoUtil::Base64Decode(
+    const char* inputStart,
+    const size_t& size,
+    std::string& output)
+{
+    // 0x40 marks whitespace, 0x80 marks invalid characters
+    static const std::uint8_t* table = [] {
+        static std::uint8_t lookup[256];
+
+        for (auto& entry : lookup) {
+            entry = 0x80;
+        }
+
+        const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        for (std::uint8_t n = 0; n < 64; ++n) {
+            lookup[static_cast<std::uint8_t>(alphabet[n])] = n;
+        }
+
+        for (const char whitespace : {' ', '\t', '\r', '\n'}) {
+            lookup[static_cast<std::uint8_t>(whitespace)] = 0x40;
+        }
+
+        return lookup;
+    }();
+
+    output.clear();
+    output.reserve(3 * (size / 4));
+
+    std::uint32_t block = 0;
+    std::uint8_t count = 0;
+    std::uint8_t padding = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        const auto character = static_cast<std::uint8_t>(inputStart[i]);
+
+        if ('=' == character) {
+            ++padding;
+            continue;
+        }
+
+        const std::uint8_t value = table[character];
+
+        if (0x40 == value) {
+            continue;
+        }
+
+        // Data after padding, or a character outside the alphabet
+        if ((0 < padding) || (0x80 == value)) {
+            return false;
+        }
+
+        block = (block << 6) | value;
+
+        if (4 == ++count) {
+            output.push_back(static_cast<char>((block >> 16) & 0xff));
+            output.push_back(static_cast<char>((block >> 8) & 0xff));
+            output.push_back(static_cast<char>(block & 0xff));
+            block = 0;
+            count = 0;
+        }
+    }
+
+    switch (count) {
+        case 0: {
+            return (0 == padding);
+        }
+        case 2: {
+            output.push_back(static_cast<char>((block >> 4) & 0xff));
+
+            return (2 >= padding);
+        }
+        case 3: {
+            output.push_back(static_cast<char>((block >> 10) & 0xff));
+            output.push_back(static_cast<char>((block >> 2) & 0xff));
+
+            return (1 >= padding);
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
 std::string CryptoUtil::Sanatize(const std::string& input)
 {
     return std::regex_replace(input, std::regex("[^1-9A-HJ-NP-Za-km-z]"), "");
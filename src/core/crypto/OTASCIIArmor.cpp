@@ -52,6 +52,9 @@
 #include <sys/types.h>
 #include <zconf.h>
 #include <zlib.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <sstream>
@@ -70,6 +73,10 @@ const char* OT_END_ARMORED_escaped = "- -----END OT ARMORED";
 const char* OT_BEGIN_SIGNED = "-----BEGIN SIGNED";
 const char* OT_BEGIN_SIGNED_escaped = "- -----BEGIN SIGNED";
 
+// ':' is not in the Base58 alphabet, so legacy payloads never start with this.
+const char* OT_ARMOR_VERSION_2 = "2:";
+const std::size_t OT_ARMOR_CHECKSUM_SIZE = 4;
+
 // Let's say you don't know if the input string is raw base64, or if it has
 // bookends
 // on it like -----BEGIN BLAH BLAH ...
@@ -277,6 +284,94 @@ std::string OTASCIIArmor::decompress_string(const std::string& str) const
     return outstring;
 }
 
+// static
+std::string OTASCIIArmor::encode(
+    const std::uint8_t* input,
+    const std::size_t size,
+    const bool lineBreaks)
+{
+    const uLong checksum =
+        crc32(crc32(0L, Z_NULL, 0), input, static_cast<uInt>(size));
+
+    std::string payload;
+    payload.reserve(size + OT_ARMOR_CHECKSUM_SIZE);
+    payload.append(reinterpret_cast<const char*>(input), size);
+    payload.push_back(static_cast<char>((checksum >> 24) & 0xff));
+    payload.push_back(static_cast<char>((checksum >> 16) & 0xff));
+    payload.push_back(static_cast<char>((checksum >> 8) & 0xff));
+    payload.push_back(static_cast<char>(checksum & 0xff));
+
+    return OT_ARMOR_VERSION_2 +
+           CryptoUtil::Base64Encode(
+               reinterpret_cast<const std::uint8_t*>(payload.data()),
+               payload.size(),
+               lineBreaks);
+}
+
+// static
+bool OTASCIIArmor::decode(
+    const char* input,
+    const std::size_t size,
+    std::string& output)
+{
+    output.clear();
+
+    std::size_t start = 0;
+
+    while ((start < size) &&
+           std::isspace(static_cast<unsigned char>(input[start]))) {
+        ++start;
+    }
+
+    const std::size_t tagSize = std::strlen(OT_ARMOR_VERSION_2);
+
+    if ((tagSize > (size - start)) ||
+        (0 != std::memcmp(input + start, OT_ARMOR_VERSION_2, tagSize))) {
+        // Written before the versioned format existed.
+        output = CryptoUtil::Base58CheckDecode(std::string(input, size));
+
+        return !output.empty();
+    }
+
+    start += tagSize;
+    std::string decoded;
+
+    if (!CryptoUtil::Base64Decode(input + start, size - start, decoded)) {
+        otErr << __FUNCTION__ << ": Base64Decode failed." << std::endl;
+
+        return false;
+    }
+
+    if (OT_ARMOR_CHECKSUM_SIZE > decoded.size()) {
+        otErr << __FUNCTION__ << ": Missing checksum." << std::endl;
+
+        return false;
+    }
+
+    const std::size_t payloadSize = decoded.size() - OT_ARMOR_CHECKSUM_SIZE;
+    const auto* checksumBytes =
+        reinterpret_cast<const std::uint8_t*>(decoded.data()) + payloadSize;
+    const uLong expected = (uLong(checksumBytes[0]) << 24) |
+                           (uLong(checksumBytes[1]) << 16) |
+                           (uLong(checksumBytes[2]) << 8) |
+                           uLong(checksumBytes[3]);
+    const uLong actual = crc32(
+        crc32(0L, Z_NULL, 0),
+        reinterpret_cast<const Bytef*>(decoded.data()),
+        static_cast<uInt>(payloadSize));
+
+    if (expected != actual) {
+        otErr << __FUNCTION__ << ": Checksum mismatch." << std::endl;
+
+        return false;
+    }
+
+    decoded.resize(payloadSize);
+    output.swap(decoded);
+
+    return true;
+}
+
 // Base64-decode
 bool OTASCIIArmor::GetData(
     OTData& theData,
@@ -286,9 +381,11 @@ bool OTASCIIArmor::GetData(
 
     if (GetLength() < 1) return true;
 
-    auto decoded =
-        App::Me().Crypto().Util().Base58CheckDecode(
-            std::string(Get(), GetLength()));
+    std::string decoded;
+
+    if (!decode(Get(), GetLength(), decoded)) {
+        return false;
+    }
 
     theData.Assign(decoded.c_str(), decoded.size());
 
@@ -302,8 +399,10 @@ bool OTASCIIArmor::SetData(const OTData& theData, bool bLineBreaks)
 
     if (theData.GetSize() < 1) return true;
 
-    auto string =
-        App::Me().Crypto().Util().Base58CheckEncode(theData, bLineBreaks);
+    auto string = encode(
+        static_cast<const std::uint8_t*>(theData.GetPointer()),
+        theData.GetSize(),
+        bLineBreaks);
 
     if (1 > string.size()) {
         otErr << __FUNCTION__ << "Base64Encode failed" << std::endl;
@@ -325,11 +424,10 @@ bool OTASCIIArmor::GetString(String& strData, bool bLineBreaks) const
         return true;
     }
 
-    std::string str_decoded =
-        App::Me().Crypto().Util().Base58CheckDecode(Get());
+    std::string str_decoded;
 
-    if (str_decoded.empty()) {
-        otErr << __FUNCTION__ << "Base58CheckDecode failed." << std::endl;
+    if (!decode(Get(), GetLength(), str_decoded) || str_decoded.empty()) {
+        otErr << __FUNCTION__ << ": decode failed." << std::endl;
 
         return false;
     }
@@ -365,8 +463,10 @@ bool OTASCIIArmor::SetString(const String& strData, bool bLineBreaks)  //=true
         return false;
     }
 
-    auto pString = App::Me().Crypto().Util().Base58CheckEncode(
-        str_compressed, bLineBreaks);
+    auto pString = encode(
+        reinterpret_cast<const std::uint8_t*>(str_compressed.data()),
+        str_compressed.size(),
+        bLineBreaks);
 
     if (pString.empty()) {
         otErr << "OTASCIIArmor::" << __FUNCTION__ << ": Base64Encode failed."
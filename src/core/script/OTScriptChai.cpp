@@ -43,6 +43,7 @@
 #include "opentxs/core/script/OTParty.hpp"
 #include "opentxs/core/script/OTPartyAccount.hpp"
 #include "opentxs/core/script/OTScript.hpp"
+#include "opentxs/core/script/OTScriptable.hpp"
 #include "opentxs/core/script/OTVariable.hpp"
 #include "opentxs/core/stdafx.hpp"
 #include "opentxs/core/util/Assert.hpp"
@@ -55,7 +56,11 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace opentxs
 {
@@ -353,75 +358,138 @@ bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
     return true;
 }
 
-#if !defined(OT_USE_CHAI_STDLIB)
-
-OTScriptChai::OTScriptChai()
-    : OTScript()
-    , chai(new chaiscript::ChaiScript())
+namespace
 {
+// Engines kept idle beyond this many are destroyed when they come back.
+const std::size_t MAX_IDLE_ENGINES = 8;
+
+std::mutex engine_pool_lock_;
 }
 
-OTScriptChai::OTScriptChai(const OTString& strValue)
-    : OTScript(strValue)
-    , chai(new chaiscript::ChaiScript())
+class OTScriptChai::Engine
 {
-}
+public:
+    Engine()
+#if defined(OT_USE_CHAI_STDLIB)
+        : chai_(chaiscript::Std_Lib::library())
+#endif
+    {
+        // These don't depend on any particular contract, so they are
+        // registered once per engine instead of once per script.
+        chai_.add(chaiscript::fun(&OTScriptable::GetTime), "get_time");
 
-OTScriptChai::OTScriptChai(const char* new_string)
-    : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript())
+        state_ = chai_.get_state();
+        locals_ = chai_.get_locals();
+    }
+
+    // Throws if ChaiScript can't restore the snapshot, in which case the
+    // engine shouldn't be reused.
+    void Reset()
+    {
+        chai_.set_state(state_);
+        chai_.set_locals(locals_);
+    }
+
+    chaiscript::ChaiScript chai_;
+
+private:
+    chaiscript::ChaiScript::State state_;
+    std::map<std::string, chaiscript::Boxed_Value> locals_;
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+};
+
+// static
+std::vector<std::unique_ptr<OTScriptChai::Engine>>&
+OTScriptChai::IdleEngines()
 {
+    static std::vector<std::unique_ptr<Engine>> engines;
+
+    return engines;
 }
 
-OTScriptChai::OTScriptChai(const char* new_string, size_t sizeLength)
-    : OTScript(new_string, sizeLength)
-    , chai(new chaiscript::ChaiScript())
+// static
+OTScriptChai::Engine* OTScriptChai::CheckoutEngine()
 {
+    {
+        std::lock_guard<std::mutex> lock(engine_pool_lock_);
+        auto& engines = IdleEngines();
+
+        if (!engines.empty()) {
+            Engine* pEngine = engines.back().release();
+            engines.pop_back();
+
+            return pEngine;
+        }
+    }
+
+    return new Engine;
 }
 
-OTScriptChai::OTScriptChai(const std::string& new_string)
-    : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript())
+// static
+void OTScriptChai::ReturnEngine(Engine* pEngine)
 {
-}
+    if (nullptr == pEngine) return;
 
-#else
+    std::unique_ptr<Engine> engine(pEngine);
+
+    try {
+        engine->Reset();
+    }
+    catch (...) {
+        otErr << "OTScriptChai::" << __FUNCTION__
+              << ": Failed to reset script engine. Discarding it.\n";
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(engine_pool_lock_);
+    auto& engines = IdleEngines();
+
+    if (MAX_IDLE_ENGINES > engines.size()) {
+        engines.push_back(std::move(engine));
+    }
+}
 
 OTScriptChai::OTScriptChai()
     : OTScript()
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+    , engine_(CheckoutEngine())
+    , chai(&engine_->chai_)
 {
 }
 
 OTScriptChai::OTScriptChai(const String& strValue)
     : OTScript(strValue)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+    , engine_(CheckoutEngine())
+    , chai(&engine_->chai_)
 {
 }
 
 OTScriptChai::OTScriptChai(const char* new_string)
     : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+    , engine_(CheckoutEngine())
+    , chai(&engine_->chai_)
 {
 }
 
 OTScriptChai::OTScriptChai(const char* new_string, size_t sizeLength)
     : OTScript(new_string, sizeLength)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+    , engine_(CheckoutEngine())
+    , chai(&engine_->chai_)
 {
 }
 
 OTScriptChai::OTScriptChai(const std::string& new_string)
     : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+    , engine_(CheckoutEngine())
+    , chai(&engine_->chai_)
 {
 }
 
-#endif // OT_USE_CHAI_STDLIB
-
 OTScriptChai::~OTScriptChai()
 {
-    if (nullptr != chai) delete chai;
+    ReturnEngine(engine_);
 }
 
 } // namespace opentxs
@@ -332,8 +332,8 @@ void OTScriptable::RegisterOTNativeCallsWithScript(
     if (nullptr != pScript) {
         OT_ASSERT(nullptr != pScript->chai)
 
-        pScript->chai->add(fun(&OTScriptable::GetTime), "get_time");
-
+        // get_time is already registered on every pooled engine. (See
+        // OTScriptChai::Engine.)
         pScript->chai->add(fun(&OTScriptable::CanExecuteClause, this),
                            "party_may_execute_clause");
     }
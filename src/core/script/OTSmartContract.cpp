@@ -3000,7 +3000,7 @@ bool OTSmartContract::StashFunds(const mapOfNyms& map_NymsAlreadyLoaded,
     // and re-sign it and save it, no matter what. So I just
     // call this here to keep it simple:
 
-    pCron->SaveCron(); // TODO No need to call this here if I can make sure it's
+    pCron->SaveCronItem(*this); // TODO No need to call this here if I can make sure it's
                        // being called higher up somewhere
     // (Imagine a script that has 10 account moves in it -- maybe don't need to
     // save cron until
@@ -6541,7 +6541,7 @@ bool OTSmartContract::MoveFunds(
     // and re-sign it and save it, no matter what. So I just
     // call this here to keep it simple:
 
-    GetCron()->SaveCron();
+    GetCron()->SaveCronItem(*this);
 
     return bSuccess;
 }
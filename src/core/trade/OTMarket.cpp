@@ -69,6 +69,7 @@
 #include <map>
 #include <memory>
 #include <ostream>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -895,14 +896,255 @@ int64_t OTMarket::GetLowestAskPrice()
     return lPrice;
 }
 
-// This utility function is used directly below (only).
-void OTMarket::cleanup_four_accounts(Account* p1, Account* p2, Account* p3,
-                                     Account* p4)
+// One sweep of the book matches the same trade (and therefore the same Nym,
+// accounts and inboxes) against offer after offer. Cron holds everything
+// still during the sweep, so rather than loading, verifying and re-signing
+// those objects once per match, they are kept here until the sweep ends.
+class OTMarket::MatchSession
+{
+public:
+    MatchSession(OTMarket& market, OTCron& cron)
+        : market_(market)
+        , cron_(cron)
+        , server_nym_(cron.GetServerNym())
+        , notary_id_(cron.GetNotaryID())
+        , market_changed_(false)
+    {
+    }
+    ~MatchSession() { Flush(); }
+
+    // These return nullptr on failure. Failures are remembered as well, so
+    // a missing Nym or account is only looked for once per sweep.
+    Nym* GetNym(const Identifier& nymID);
+    Account* GetAccount(const Identifier& acctID);
+    Ledger* GetInbox(const Identifier& nymID, const Identifier& acctID);
+
+    // Verify the server's signature on the first call only. Trades and
+    // offers can be deleted during the sweep, and a new one can reuse the
+    // address, so they are remembered by transaction number.
+    bool VerifyContract(const OTTrade& trade);
+    bool VerifyContract(const OTOffer& offer);
+    bool VerifyContract(const Account& account);
+
+    void SetChanged(Account& account) { changed_accounts_.insert(&account); }
+    void SetChanged(Account& account, Ledger& inbox)
+    {
+        changed_accounts_.insert(&account);
+        changed_inboxes_[&account] = &inbox;
+    }
+    void SetChanged(const OTTrade& trade)
+    {
+        changed_trades_.insert(trade.GetTransactionNum());
+    }
+    void SetMarketChanged() { market_changed_ = true; }
+
+    // Signs and saves everything that changed since the last flush: the
+    // inboxes, then the accounts, then the cron items and the market. Stops
+    // at the first failure, so that a trade is never saved as filled unless
+    // the accounts and receipts for the fill were saved first. Whatever was
+    // not saved stays queued.
+    bool Flush();
+
+private:
+    OTMarket& market_;
+    OTCron& cron_;
+    Nym* server_nym_;
+    const Identifier notary_id_;
+    std::map<Identifier, std::unique_ptr<Nym>> nyms_;
+    std::map<Identifier, std::unique_ptr<Account>> accounts_;
+    std::map<Identifier, std::unique_ptr<Ledger>> inboxes_;
+    std::set<int64_t> verified_trades_;
+    std::set<int64_t> verified_offers_;
+    std::set<Identifier> verified_accounts_;
+    std::set<Account*> changed_accounts_;
+    std::map<Account*, Ledger*> changed_inboxes_;
+    // By transaction number, since a trade can be removed from Cron during
+    // the sweep.
+    std::set<int64_t> changed_trades_;
+    bool market_changed_;
+
+    bool VerifyContract(const Contract& contract, std::set<int64_t>& verified,
+                        int64_t lTransactionNum);
+
+    MatchSession(const MatchSession&) = delete;
+    MatchSession& operator=(const MatchSession&) = delete;
+};
+
+Nym* OTMarket::MatchSession::GetNym(const Identifier& nymID)
+{
+    auto it = nyms_.find(nymID);
+
+    if (nyms_.end() != it) return it->second.get();
+
+    OT_ASSERT(nullptr != server_nym_);
+
+    std::unique_ptr<Nym> pNym(new Nym);
+    pNym->SetIdentifier(nymID);
+
+    if (!pNym->LoadPublicKey()) {
+        otErr << "OTMarket::MatchSession::" << __FUNCTION__
+              << ": Failure loading Nym public key: " << String(nymID)
+              << "\n";
+        pNym.reset();
+    }
+    else if (!pNym->VerifyPseudonym() ||
+             !pNym->LoadSignedNymfile(*server_nym_)) {
+        otErr << "OTMarket::MatchSession::" << __FUNCTION__
+              << ": Failure verifying Nym or loading signed Nymfile: "
+              << String(nymID) << "\n";
+        pNym.reset();
+    }
+
+    Nym* pOutput = pNym.get();
+    nyms_[nymID] = std::move(pNym);
+
+    return pOutput;
+}
+
+Account* OTMarket::MatchSession::GetAccount(const Identifier& acctID)
+{
+    auto it = accounts_.find(acctID);
+
+    if (accounts_.end() != it) return it->second.get();
+
+    Account* pAccount = Account::LoadExistingAccount(acctID, notary_id_);
+    accounts_[acctID].reset(pAccount);
+
+    return pAccount;
+}
+
+Ledger* OTMarket::MatchSession::GetInbox(const Identifier& nymID,
+                                         const Identifier& acctID)
+{
+    auto it = inboxes_.find(acctID);
+
+    if (inboxes_.end() != it) return it->second.get();
+
+    OT_ASSERT(nullptr != server_nym_);
+
+    std::unique_ptr<Ledger> pInbox(new Ledger(nymID, acctID, notary_id_));
+
+    // Inbox is created if it doesn't already exist.
+    bool bSuccess = pInbox->LoadInbox();
+
+    if (bSuccess)
+        bSuccess = pInbox->VerifyAccount(*server_nym_);
+    else
+        bSuccess = pInbox->GenerateLedger(acctID, notary_id_, Ledger::inbox,
+                                          true); // bGenerateFile=true
+
+    if (!bSuccess) pInbox.reset();
+
+    Ledger* pOutput = pInbox.get();
+    inboxes_[acctID] = std::move(pInbox);
+
+    return pOutput;
+}
+
+bool OTMarket::MatchSession::VerifyContract(const Contract& contract,
+                                            std::set<int64_t>& verified,
+                                            int64_t lTransactionNum)
+{
+    if (verified.end() != verified.find(lTransactionNum)) return true;
+
+    OT_ASSERT(nullptr != server_nym_);
+
+    if (!contract.VerifySignature(*server_nym_)) return false;
+
+    verified.insert(lTransactionNum);
+
+    return true;
+}
+
+bool OTMarket::MatchSession::VerifyContract(const OTTrade& trade)
+{
+    return VerifyContract(trade, verified_trades_, trade.GetTransactionNum());
+}
+
+bool OTMarket::MatchSession::VerifyContract(const OTOffer& offer)
+{
+    return VerifyContract(offer, verified_offers_, offer.GetTransactionNum());
+}
+
+bool OTMarket::MatchSession::VerifyContract(const Account& account)
+{
+    Identifier theAccountID;
+    account.GetIdentifier(theAccountID);
+
+    if (verified_accounts_.end() != verified_accounts_.find(theAccountID))
+        return true;
+
+    OT_ASSERT(nullptr != server_nym_);
+
+    if (!account.VerifySignature(*server_nym_)) return false;
+
+    verified_accounts_.insert(theAccountID);
+
+    return true;
+}
+
+bool OTMarket::MatchSession::Flush()
 {
-    if (p1) delete p1;
-    if (p2) delete p2;
-    if (p3) delete p3;
-    if (p4) delete p4;
+    // Inboxes first, since saving an inbox updates the inbox hash on its
+    // account.
+    while (!changed_inboxes_.empty()) {
+        auto it = changed_inboxes_.begin();
+        Account& theAccount = *it->first;
+        Ledger& theInbox = *it->second;
+
+        theInbox.ReleaseSignatures();
+
+        if (!theInbox.SignContract(*server_nym_) || !theInbox.SaveContract() ||
+            !theAccount.SaveInbox(theInbox)) {
+            otErr << "OTMarket::MatchSession::" << __FUNCTION__
+                  << ": Failed saving an inbox. Stopping here.\n";
+            return false;
+        }
+
+        changed_inboxes_.erase(it);
+    }
+
+    while (!changed_accounts_.empty()) {
+        auto it = changed_accounts_.begin();
+        Account* pAccount = *it;
+
+        pAccount->ReleaseSignatures();
+
+        if (!pAccount->SignContract(*server_nym_) ||
+            !pAccount->SaveContract() || !pAccount->SaveAccount()) {
+            otErr << "OTMarket::MatchSession::" << __FUNCTION__
+                  << ": Failed saving an account. Stopping here.\n";
+            return false;
+        }
+
+        changed_accounts_.erase(it);
+    }
+
+    while (!changed_trades_.empty()) {
+        auto it = changed_trades_.begin();
+        OTCronItem* pItem = cron_.GetItemByOfficialNum(*it);
+
+        // Not on Cron anymore, and its removal is saved by Cron.
+        if ((nullptr != pItem) && !cron_.SaveCronItem(*pItem)) {
+            otErr << "OTMarket::MatchSession::" << __FUNCTION__
+                  << ": Failed saving trade " << *it << ". Stopping here.\n";
+            return false;
+        }
+
+        changed_trades_.erase(it);
+    }
+
+    if (market_changed_) {
+        if (!market_.SaveMarket()) {
+            otErr << "OTMarket::MatchSession::" << __FUNCTION__
+                  << ": Failed saving the market.\n";
+            return false;
+        }
+
+        market_changed_ = false;
+    }
+
+    return true;
 }
 
 // This utility function is used directly below (only).
@@ -955,8 +1197,8 @@ void OTMarket::rollback_four_accounts(Account& p1, bool b1, const int64_t& a1,
 // doesn't actually have enough money to do the trade... that failure would
 // occur here.)
 //
-void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
-                            OTOffer& theOtherOffer)
+void OTMarket::ProcessTrade(MatchSession& session, OTTrade& theTrade,
+                            OTOffer& theOffer, OTOffer& theOtherOffer)
 {
     OTTrade* pOtherTrade = theOtherOffer.GetTrade();
     OTCron* pCron = theTrade.GetCron();
@@ -978,8 +1220,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                   "there is no Server Nym on the Cron "
                   "object authorizing the trades.");
 
-    const Identifier NOTARY_ID(pCron->GetNotaryID());
-
     if (pCron->GetTransactionCount() < 1) {
         otOut << "Failed to process trades: Out of transaction numbers!\n";
         return;
@@ -1041,8 +1281,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
         NOTARY_NYM_ID(
             *pServerNym); // The Server Nym (could be one or both of the above.)
 
-    Nym theNym, theOtherNym; // We MIGHT use ONE, OR BOTH, of these, or none.
-
     // Find out if either Nym is actually also the server.
     bool bFirstNymIsServerNym =
         ((FIRST_NYM_ID == NOTARY_NYM_ID) ? true : false);
@@ -1064,28 +1302,12 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
     {
         pFirstNym = pServerNym;
     }
-    else // Else load the First Nym from storage.
+    else // Else load the First Nym from storage (once per sweep.)
     {
-        theNym.SetIdentifier(FIRST_NYM_ID); // theNym is pFirstNym
+        pFirstNym = session.GetNym(FIRST_NYM_ID); //  <=====
 
-        if (!theNym.LoadPublicKey()) {
-            String strNymID(FIRST_NYM_ID);
-            otErr << "Failure loading First Nym public key in OTMarket::"
-                  << __FUNCTION__ << ": " << strNymID << "\n";
-            theTrade.FlagForRemoval();
-            return;
-        }
-
-        if (theNym.VerifyPseudonym() && theTrade.VerifySignature(*pServerNym) &&
-            theOffer.VerifySignature(*pServerNym) &&
-            theNym.LoadSignedNymfile(*pServerNym)) // ServerNym here is not
-                                                   // theNym's identity, but
-                                                   // merely the signer on this
-                                                   // file.
-        {
-            pFirstNym = &theNym; //  <=====
-        }
-        else {
+        if ((nullptr == pFirstNym) || !session.VerifyContract(theTrade) ||
+            !session.VerifyContract(theOffer)) {
             String strNymID(FIRST_NYM_ID);
             otErr << "OTMarket::" << __FUNCTION__
                   << ": Failure verifying trade, offer, or nym, or loading "
@@ -1107,23 +1329,10 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
     }
     else // Otherwise load the Other Nym from Disk and point to that.
     {
-        theOtherNym.SetIdentifier(OTHER_NYM_ID);
+        pOtherNym = session.GetNym(OTHER_NYM_ID); //  <=====
 
-        if (!theOtherNym.LoadPublicKey()) {
-            String strNymID(OTHER_NYM_ID);
-            otErr << "Failure loading Other Nym public key in OTMarket::"
-                  << __FUNCTION__ << ": " << strNymID << "\n";
-            pOtherTrade->FlagForRemoval();
-            return;
-        }
-
-        if (theOtherNym.VerifyPseudonym() &&
-            pOtherTrade->VerifySignature(*pServerNym) &&
-            theOtherOffer.VerifySignature(*pServerNym) &&
-            theOtherNym.LoadSignedNymfile(*pServerNym)) {
-            pOtherNym = &theOtherNym; //  <=====
-        }
-        else {
+        if ((nullptr == pOtherNym) || !session.VerifyContract(*pOtherTrade) ||
+            !session.VerifyContract(theOtherOffer)) {
             String strNymID(OTHER_NYM_ID);
             otErr << "Failure loading or verifying Other Nym public key in "
                      "OTMarket::" << __FUNCTION__ << ": " << strNymID << "\n";
@@ -1160,21 +1369,20 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
     // Make sure have ALL FOUR accounts loaded and checked out.
     // (first nym's asset/currency, and other nym's asset/currency.)
 
-    Account* pFirstAssetAcct =
-        Account::LoadExistingAccount(theTrade.GetSenderAcctID(), NOTARY_ID);
+    // The session owns these. The first trader's are only loaded and
+    // verified on its first match in this sweep.
+    Account* pFirstAssetAcct = session.GetAccount(theTrade.GetSenderAcctID());
     Account* pFirstCurrencyAcct =
-        Account::LoadExistingAccount(theTrade.GetCurrencyAcctID(), NOTARY_ID);
+        session.GetAccount(theTrade.GetCurrencyAcctID());
 
     Account* pOtherAssetAcct =
-        Account::LoadExistingAccount(pOtherTrade->GetSenderAcctID(), NOTARY_ID);
-    Account* pOtherCurrencyAcct = Account::LoadExistingAccount(
-        pOtherTrade->GetCurrencyAcctID(), NOTARY_ID);
+        session.GetAccount(pOtherTrade->GetSenderAcctID());
+    Account* pOtherCurrencyAcct =
+        session.GetAccount(pOtherTrade->GetCurrencyAcctID());
 
     if ((nullptr == pFirstAssetAcct) || (nullptr == pFirstCurrencyAcct)) {
         otOut << "ERROR verifying existence of one of the first trader's "
                  "accounts during attempted Market trade.\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         theTrade.FlagForRemoval(); // Removes from Cron.
         return;
     }
@@ -1182,8 +1390,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                (nullptr == pOtherCurrencyAcct)) {
         otOut << "ERROR verifying existence of one of the second trader's "
                  "accounts during attempted Market trade.\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         pOtherTrade->FlagForRemoval(); // Removes from Cron.
         return;
     }
@@ -1204,8 +1410,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
              ) {
         otErr << "ERROR - First Trader has accounts of wrong "
                  "instrument definitions in OTMarket::" << __FUNCTION__ << "\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         theTrade.FlagForRemoval(); // Removes from Cron.
         return;
     }
@@ -1219,8 +1423,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
     {
         otErr << "ERROR - Other Trader has accounts of wrong "
                  "instrument definitions in OTMarket::" << __FUNCTION__ << "\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         pOtherTrade->FlagForRemoval(); // Removes from Cron.
         return;
     }
@@ -1231,24 +1433,20 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
     // I call VerifySignature here since VerifyContractID was already called in
     // LoadExistingAccount().
     else if ((!pFirstAssetAcct->VerifyOwner(*pFirstNym) ||
-              !pFirstAssetAcct->VerifySignature(*pServerNym)) ||
+              !session.VerifyContract(*pFirstAssetAcct)) ||
              (!pFirstCurrencyAcct->VerifyOwner(*pFirstNym) ||
-              !pFirstCurrencyAcct->VerifySignature(*pServerNym))) {
+              !session.VerifyContract(*pFirstCurrencyAcct))) {
         otErr << "ERROR verifying ownership or signature on one of first "
                  "trader's accounts in OTMarket::" << __FUNCTION__ << "\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         theTrade.FlagForRemoval(); // Removes from Cron.
         return;
     }
     else if ((!pOtherAssetAcct->VerifyOwner(*pOtherNym) ||
-                !pOtherAssetAcct->VerifySignature(*pServerNym)) ||
+                !session.VerifyContract(*pOtherAssetAcct)) ||
                (!pOtherCurrencyAcct->VerifyOwner(*pOtherNym) ||
-                !pOtherCurrencyAcct->VerifySignature(*pServerNym))) {
+                !session.VerifyContract(*pOtherCurrencyAcct))) {
         otErr << "ERROR verifying ownership or signature on one of other "
                  "trader's accounts in OTMarket::" << __FUNCTION__ << "\n";
-        cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                              pOtherAssetAcct, pOtherCurrencyAcct);
         pOtherTrade->FlagForRemoval(); // Removes from Cron.
         return;
     }
@@ -1266,63 +1464,30 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
         // outbox and the recipient's inbox.
         // IF they can be loaded up from file, or generated, that is.
 
-        // Load the inbox/outbox in case they already exist
-        Ledger theFirstAssetInbox(FIRST_NYM_ID, theTrade.GetSenderAcctID(),
-                                  NOTARY_ID),
-            theFirstCurrencyInbox(FIRST_NYM_ID, theTrade.GetCurrencyAcctID(),
-                                  NOTARY_ID),
-            theOtherAssetInbox(OTHER_NYM_ID, pOtherTrade->GetSenderAcctID(),
-                               NOTARY_ID),
-            theOtherCurrencyInbox(OTHER_NYM_ID,
-                                  pOtherTrade->GetCurrencyAcctID(), NOTARY_ID);
-
+        // Load the inboxes in case they already exist, or generate them
+        // otherwise. (The session keeps them for the rest of the sweep.)
         // ALL inboxes -- no outboxes. All will receive notification of
         // something ALREADY DONE.
-        bool bSuccessLoadingFirstAsset = theFirstAssetInbox.LoadInbox();
-        bool bSuccessLoadingFirstCurrency = theFirstCurrencyInbox.LoadInbox();
-        bool bSuccessLoadingOtherAsset = theOtherAssetInbox.LoadInbox();
-        bool bSuccessLoadingOtherCurrency = theOtherCurrencyInbox.LoadInbox();
-
-        // ...or generate them otherwise...
-
-        if (true == bSuccessLoadingFirstAsset)
-            bSuccessLoadingFirstAsset =
-                theFirstAssetInbox.VerifyAccount(*pServerNym);
-        else
-            bSuccessLoadingFirstAsset = theFirstAssetInbox.GenerateLedger(
-                theTrade.GetSenderAcctID(), NOTARY_ID, Ledger::inbox,
-                true); // bGenerateFile=true
-
-        if (true == bSuccessLoadingFirstCurrency)
-            bSuccessLoadingFirstCurrency =
-                theFirstCurrencyInbox.VerifyAccount(*pServerNym);
-        else
-            bSuccessLoadingFirstCurrency = theFirstCurrencyInbox.GenerateLedger(
-                theTrade.GetCurrencyAcctID(), NOTARY_ID, Ledger::inbox,
-                true); // bGenerateFile=true
-
-        if (true == bSuccessLoadingOtherAsset)
-            bSuccessLoadingOtherAsset =
-                theOtherAssetInbox.VerifyAccount(*pServerNym);
-        else
-            bSuccessLoadingOtherAsset = theOtherAssetInbox.GenerateLedger(
-                pOtherTrade->GetSenderAcctID(), NOTARY_ID, Ledger::inbox,
-                true); // bGenerateFile=true
-
-        if (true == bSuccessLoadingOtherCurrency)
-            bSuccessLoadingOtherCurrency =
-                theOtherCurrencyInbox.VerifyAccount(*pServerNym);
-        else
-            bSuccessLoadingOtherCurrency = theOtherCurrencyInbox.GenerateLedger(
-                pOtherTrade->GetCurrencyAcctID(), NOTARY_ID, Ledger::inbox,
-                true); // bGenerateFile=true
+        Ledger* pFirstAssetInbox =
+            session.GetInbox(FIRST_NYM_ID, theTrade.GetSenderAcctID());
+        Ledger* pFirstCurrencyInbox =
+            session.GetInbox(FIRST_NYM_ID, theTrade.GetCurrencyAcctID());
+        Ledger* pOtherAssetInbox =
+            session.GetInbox(OTHER_NYM_ID, pOtherTrade->GetSenderAcctID());
+        Ledger* pOtherCurrencyInbox =
+            session.GetInbox(OTHER_NYM_ID, pOtherTrade->GetCurrencyAcctID());
+
+        const bool bSuccessLoadingFirstAsset = (nullptr != pFirstAssetInbox);
+        const bool bSuccessLoadingFirstCurrency =
+            (nullptr != pFirstCurrencyInbox);
+        const bool bSuccessLoadingOtherAsset = (nullptr != pOtherAssetInbox);
+        const bool bSuccessLoadingOtherCurrency =
+            (nullptr != pOtherCurrencyInbox);
 
         if ((false == bSuccessLoadingFirstAsset) ||
             (false == bSuccessLoadingFirstCurrency)) {
             otErr << "ERROR loading or generating an inbox for first trader in "
                      "OTMarket::" << __FUNCTION__ << ".\n";
-            cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                                  pOtherAssetAcct, pOtherCurrencyAcct);
             theTrade.FlagForRemoval(); // Removes from Cron.
             return;
         }
@@ -1330,12 +1495,15 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                    (false == bSuccessLoadingOtherCurrency)) {
             otErr << "ERROR loading or generating an inbox for other trader in "
                      "OTMarket::" << __FUNCTION__ << ".\n";
-            cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                                  pOtherAssetAcct, pOtherCurrencyAcct);
             pOtherTrade->FlagForRemoval(); // Removes from Cron.
             return;
         }
         else {
+            Ledger& theFirstAssetInbox = *pFirstAssetInbox;
+            Ledger& theFirstCurrencyInbox = *pFirstCurrencyInbox;
+            Ledger& theOtherAssetInbox = *pOtherAssetInbox;
+            Ledger& theOtherCurrencyInbox = *pOtherCurrencyInbox;
+
             // Generate new transaction numbers for these new transactions
             int64_t lNewTransactionNumber = pCron->GetNextTransactionNumber();
 
@@ -1344,8 +1512,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
             if (0 == lNewTransactionNumber) {
                 otOut << "WARNING: Market is unable to process because there "
                          "are no more transaction numbers available.\n";
-                cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct,
-                                      pOtherAssetAcct, pOtherCurrencyAcct);
                 // (Here I flag neither trade for removal.)
                 return;
             }
@@ -1708,14 +1874,22 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     otErr << "Very strange! Funds were available, yet debit or "
                              "credit failed while performing trade. "
                              "Attempting rollback!\n";
-                    // We won't save the files anyway, if this failed. So the
-                    // rollback is actually superfluous but somehow worthwhile.
+                    // The accounts stay loaded for the rest of the sweep and
+                    // may be saved after a later match, so the rounds that
+                    // already went through are rolled back as well.
                     rollback_four_accounts(
                         *pAssetAccountToDebit, bMove1, lMinIncrementPerRound,
                         *pCurrencyAccountToDebit, bMove2, lPrice,
                         *pAssetAccountToCredit, bMove3, lMinIncrementPerRound,
                         *pCurrencyAccountToCredit, bMove4, lPrice);
 
+                    if (lOfferFinished > 0)
+                        rollback_four_accounts(
+                            *pAssetAccountToDebit, true, lOfferFinished,
+                            *pCurrencyAccountToDebit, true, lTotalPaidOut,
+                            *pAssetAccountToCredit, true, lOfferFinished,
+                            *pCurrencyAccountToCredit, true, lTotalPaidOut);
+
                     bSuccess = false;
                     break;
                 }
@@ -1856,13 +2030,14 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                 // Account balances have changed based on these trades that we
                 // just processed.
                 // Make sure to save the Market since it contains those offers
-                // that have just updated.
-                SaveMarket();
+                // that have just updated. (Once, when the sweep is done.)
+                session.SetMarketChanged();
 
                 // The Trade has changed, and it is stored as a CronItem. So I
-                // save Cron as well, for
-                // the same reason I saved the Market.
-                pCron->SaveCron();
+                // save it as well, for the same reason I save the Market. (Once
+                // the accounts and inboxes have been saved.)
+                session.SetChanged(theTrade);
+                session.SetChanged(*pOtherTrade);
             }
 
             //
@@ -2069,34 +2244,15 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                 theOtherAssetInbox.AddTransaction(*pTrans3);
                 theOtherCurrencyInbox.AddTransaction(*pTrans4);
 
-                // Release any signatures that were there before (They won't
-                // verify anymore anyway, since the content has changed.)
-                theFirstAssetInbox.ReleaseSignatures();
-                theFirstCurrencyInbox.ReleaseSignatures();
-                theOtherAssetInbox.ReleaseSignatures();
-                theOtherCurrencyInbox.ReleaseSignatures();
-
-                // Sign all four of them.
-                theFirstAssetInbox.SignContract(*pServerNym);
-                theFirstCurrencyInbox.SignContract(*pServerNym);
-                theOtherAssetInbox.SignContract(*pServerNym);
-                theOtherCurrencyInbox.SignContract(*pServerNym);
-
-                // Save all four of them internally
-                theFirstAssetInbox.SaveContract();
-                theFirstCurrencyInbox.SaveContract();
-                theOtherAssetInbox.SaveContract();
-                theOtherCurrencyInbox.SaveContract();
-
                 // TODO: Better rollback capabilities in case of failures here:
 
-                // Save the four inboxes to storage. (File, DB, wherever it
-                // goes.)
-
-                pFirstAssetAcct->SaveInbox(theFirstAssetInbox);
-                pFirstCurrencyAcct->SaveInbox(theFirstCurrencyInbox);
-                pOtherAssetAcct->SaveInbox(theOtherAssetInbox);
-                pOtherCurrencyAcct->SaveInbox(theOtherCurrencyInbox);
+                // The four inboxes and the four accounts are signed and saved
+                // by the session when the sweep is done, however many matches
+                // touched them.
+                session.SetChanged(*pFirstAssetAcct, theFirstAssetInbox);
+                session.SetChanged(*pFirstCurrencyAcct, theFirstCurrencyInbox);
+                session.SetChanged(*pOtherAssetAcct, theOtherAssetInbox);
+                session.SetChanged(*pOtherCurrencyAcct, theOtherCurrencyInbox);
 
                 // These correspond to the AddTransaction() calls just above.
                 // The actual receipts are stored in separate files now.
@@ -2105,24 +2261,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                 pTrans2->SaveBoxReceipt(theFirstCurrencyInbox);
                 pTrans3->SaveBoxReceipt(theOtherAssetInbox);
                 pTrans4->SaveBoxReceipt(theOtherCurrencyInbox);
-
-                // Save the four accounts.
-                pFirstAssetAcct->ReleaseSignatures();
-                pFirstCurrencyAcct->ReleaseSignatures();
-                pOtherAssetAcct->ReleaseSignatures();
-                pOtherCurrencyAcct->ReleaseSignatures();
-                pFirstAssetAcct->SignContract(*pServerNym);
-                pFirstCurrencyAcct->SignContract(*pServerNym);
-                pOtherAssetAcct->SignContract(*pServerNym);
-                pOtherCurrencyAcct->SignContract(*pServerNym);
-                pFirstAssetAcct->SaveContract();
-                pFirstCurrencyAcct->SaveContract();
-                pOtherAssetAcct->SaveContract();
-                pOtherCurrencyAcct->SaveContract();
-                pFirstAssetAcct->SaveAccount();
-                pFirstCurrencyAcct->SaveAccount();
-                pOtherAssetAcct->SaveAccount();
-                pOtherCurrencyAcct->SaveAccount();
             }
             // If money was short, let's see WHO was short so we can remove his
             // trade.
@@ -2157,12 +2295,14 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     Item* pTempItem = nullptr;
                     OTTransaction* pTempTransaction = nullptr;
                     Ledger* pTempInbox = nullptr;
+                    Account* pTempAcct = nullptr;
 
                     if (pAssetAccountToDebit == pFirstAssetAcct) {
                         pTempItem = pItem1;
                         bFirstTraderIsBroke = true;
                         pTempTransaction = pTrans1;
                         pTempInbox = &theFirstAssetInbox;
+                        pTempAcct = pFirstAssetAcct;
 
                         delete pItem3;
                         pItem3 = nullptr;
@@ -2175,6 +2315,7 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                         bOtherTraderIsBroke = true;
                         pTempTransaction = pTrans3;
                         pTempInbox = &theOtherAssetInbox;
+                        pTempAcct = pOtherAssetAcct;
 
                         delete pItem1;
                         pItem1 = nullptr;
@@ -2191,11 +2332,7 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     pTempTransaction->SaveContract();
 
                     pTempInbox->AddTransaction(*pTempTransaction);
-
-                    pTempInbox->ReleaseSignatures();
-                    pTempInbox->SignContract(*pServerNym);
-                    pTempInbox->SaveContract();
-                    pTempInbox->SaveInbox();
+                    session.SetChanged(*pTempAcct, *pTempInbox);
 
                     pTempTransaction->SaveBoxReceipt(*pTempInbox);
                 }
@@ -2217,12 +2354,14 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     Item* pTempItem = nullptr;
                     OTTransaction* pTempTransaction = nullptr;
                     Ledger* pTempInbox = nullptr;
+                    Account* pTempAcct = nullptr;
 
                     if (pCurrencyAccountToDebit == pFirstCurrencyAcct) {
                         pTempItem = pItem2;
                         bFirstTraderIsBroke = true;
                         pTempTransaction = pTrans2;
                         pTempInbox = &theFirstCurrencyInbox;
+                        pTempAcct = pFirstCurrencyAcct;
 
                         delete pItem4;
                         pItem4 = nullptr;
@@ -2235,6 +2374,7 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                         bOtherTraderIsBroke = true;
                         pTempTransaction = pTrans4;
                         pTempInbox = &theOtherCurrencyInbox;
+                        pTempAcct = pOtherCurrencyAcct;
 
                         delete pItem2;
                         pItem2 = nullptr;
@@ -2251,11 +2391,7 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     pTempTransaction->SaveContract();
 
                     pTempInbox->AddTransaction(*pTempTransaction);
-
-                    pTempInbox->ReleaseSignatures();
-                    pTempInbox->SignContract(*pServerNym);
-                    pTempInbox->SaveContract();
-                    pTempInbox->SaveInbox();
+                    session.SetChanged(*pTempAcct, *pTempInbox);
 
                     pTempTransaction->SaveBoxReceipt(*pTempInbox);
                 }
@@ -2281,8 +2417,6 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
         }     // all four boxes were successfully loaded or generated.
     }         // "this entire function can be divided..."
 
-    cleanup_four_accounts(pFirstAssetAcct, pFirstCurrencyAcct, pOtherAssetAcct,
-                          pOtherCurrencyAcct);
 }
 // Let's say pBid->Price is $10. He's bidding $10 as his price limit.
 // If I was ALREADY selling at $11, then NOTHING HAPPENS. (If we're the only two
@@ -2421,6 +2555,13 @@ bool OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer)
     // in the market WITHIN THIS TRADE'S PRICE LIMITS. So we're going to go up
     // the list of what's available, and trade.
 
+    OTCron* pCron = theTrade.GetCron();
+    OT_ASSERT(nullptr != pCron);
+
+    // Whatever the matches below load is kept by the session until we return,
+    // and whatever they change is saved then, once.
+    MatchSession session(*this, *pCron);
+
     if (theOffer.IsAsk()) // If I'm selling,
     {
         // rbegin puts us on the upper bound of the highest bidder (any new
@@ -2487,7 +2628,8 @@ bool OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer)
                     (nullptr != pBid->GetTrade()) &&
                     !pBid->GetTrade()->IsFlaggedForRemoval())
 
-                    ProcessTrade(theTrade, theOffer, *pBid); // <========
+                    ProcessTrade(session, theTrade, theOffer,
+                                 *pBid); // <========
             }
 
             // Else, the bid is lower than I am willing to sell. (And all the
@@ -2574,7 +2716,8 @@ bool OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer)
                     (nullptr != pAsk->GetTrade()) &&
                     !pAsk->GetTrade()->IsFlaggedForRemoval())
 
-                    ProcessTrade(theTrade, theOffer, *pAsk); // <=======
+                    ProcessTrade(session, theTrade, theOffer,
+                                 *pAsk); // <=======
             }
             // Else, the ask price is higher than I am willing to pay. (And all
             // the remaining sellers are even HIGHER.)
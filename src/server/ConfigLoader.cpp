@@ -177,6 +177,50 @@ bool ConfigLoader::load(String& walletFilename)
             static_cast<int32_t>(lValue));
     }
 
+    // THREADS
+
+    {
+        const char* szComment = ";; THREADS\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("threads", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; worker_threads is the number of threads "
+                                "processing client requests in parallel.\n"
+                                "; 0 means one thread per CPU core.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("threads", "worker_threads", 0, lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetWorkerThreads(static_cast<int32_t>(lValue));
+    }
+
+    // CACHE
+
+    {
+        const char* szComment = ";; CACHE\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("cache", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; nym_cache_size is the number of client "
+                                "Nyms whose verified credentials and\n"
+                                "; nymfiles are kept in memory between "
+                                "requests. 0 turns the cache off.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cache", "nym_cache_size",
+                                ServerSettings::GetNymCacheSize(), lValue,
+                                bIsNewKey, szComment);
+        ServerSettings::SetNymCacheSize(static_cast<int32_t>(lValue));
+    }
+
     // PERMISSIONS
 
     {
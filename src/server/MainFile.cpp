@@ -61,6 +61,7 @@
 #include <irrxml/irrXML.hpp>
 #include <stdint.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -75,6 +76,8 @@ MainFile::MainFile(OTServer* server)
 
 bool MainFile::SaveMainFileToString(String& strMainFile)
 {
+    std::lock_guard<std::recursive_mutex> lock(server_->transactor_.lock_);
+
     Tag tag("notaryServer");
 
     // We're on version 2.0 since adding the master key.
@@ -83,7 +86,8 @@ bool MainFile::SaveMainFileToString(String& strMainFile)
     tag.add_attribute("notaryID", server_->m_strNotaryID.Get());
     tag.add_attribute("serverNymID", server_->m_strServerNymID.Get());
     tag.add_attribute("transactionNum",
-                      formatLong(server_->transactor_.transactionNumber()));
+                      formatLong(
+                          server_->transactor_.reservedTransactionNumber()));
 
     if (OTCachedKey::It()->IsGenerated()) // If it exists, then serialize it.
     {
@@ -47,6 +47,7 @@
 #include "opentxs/server/ClientConnection.hpp"
 #include "opentxs/server/OTServer.hpp"
 #include "opentxs/server/ServerLoader.hpp"
+#include "opentxs/server/ServerSettings.hpp"
 #include "opentxs/server/UserCommandProcessor.hpp"
 
 #include <czmq.h>
@@ -55,32 +56,48 @@
 #include <zactor.h>
 #include <zauth.h>
 #include <zcert.h>
+#include <zframe.h>
+#include <zmsg.h>
 #include <zpoller.h>
 #include <zsock.h>
 #include <zsock_option.h>
 #include <zstr.h>
 #include <zsys.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <ostream>
+#include <set>
 #include <string>
 
+#define OT_NOTARY_REPLY_ENDPOINT "inproc://opentxs/notary/replies"
+
 namespace opentxs
 {
 
 MessageProcessor::MessageProcessor(ServerLoader& loader)
     : server_(loader.getServer())
-    , zmqSocket_(zsock_new_rep(NULL))
+    , frontend_(zsock_new_router(NULL))
+    , backend_(zsock_new_pull(NULL))
     , zmqAuth_(zactor_new(zauth, NULL))
-    , zmqPoller_(zpoller_new(zmqSocket_, NULL))
+    , zmqPoller_(zpoller_new(frontend_, backend_, NULL))
+    , shutdown_(false)
+    , queues_()
+    , workers_()
+    , cron_()
 {
     init(loader.getPort(), loader.getTransportKey());
 }
 
 MessageProcessor::~MessageProcessor()
 {
-    zpoller_remove(zmqPoller_, zmqSocket_);
+    stopThreads();
+    zpoller_remove(zmqPoller_, backend_);
+    zpoller_remove(zmqPoller_, frontend_);
     zpoller_destroy(&zmqPoller_);
     zactor_destroy(&zmqAuth_);
-    zsock_destroy(&zmqSocket_);
+    zsock_destroy(&backend_);
+    zsock_destroy(&frontend_);
 }
 
 void MessageProcessor::init(int port, zcert_t* transportKey)
@@ -94,27 +111,88 @@ void MessageProcessor::init(int port, zcert_t* transportKey)
     }
     zstr_sendx(zmqAuth_, "CURVE", CURVE_ALLOW_ANY, NULL);
     zsock_wait(zmqAuth_);
-    zsock_set_zap_domain(zmqSocket_, "global");
-    zsock_set_curve_server(zmqSocket_, 1);
-    zcert_apply(transportKey, zmqSocket_);
+    zsock_set_zap_domain(frontend_, "global");
+    zsock_set_curve_server(frontend_, 1);
+    zcert_apply(transportKey, frontend_);
     zcert_destroy(&transportKey);
-    zsock_bind(zmqSocket_, "tcp://*:%d", port);
+    zsock_bind(frontend_, "tcp://*:%d", port);
+    zsock_bind(backend_, OT_NOTARY_REPLY_ENDPOINT);
+}
+
+void MessageProcessor::startThreads()
+{
+    std::size_t count = 0;
+
+    if (0 < ServerSettings::GetWorkerThreads()) {
+        count = static_cast<std::size_t>(ServerSettings::GetWorkerThreads());
+    } else {
+        count = std::thread::hardware_concurrency();
+    }
+
+    if (0 == count) {
+        count = 1;
+    }
+
+    Log::vOutput(0, "MessageProcessor: Starting %d worker threads.\n",
+                 static_cast<int32_t>(count));
+
+    for (std::size_t i = 0; i < count; ++i) {
+        queues_.emplace_back(new WorkQueue);
+    }
+
+    for (auto& queue : queues_) {
+        workers_.emplace_back(&MessageProcessor::worker, this, queue.get());
+    }
+
+    cron_.reset(new std::thread(&MessageProcessor::cron, this));
+}
+
+void MessageProcessor::stopThreads()
+{
+    shutdown_.store(true);
+
+    for (auto& queue : queues_) {
+        std::lock_guard<std::mutex> queueLock(queue->lock_);
+        queue->signal_.notify_all();
+    }
+
+    for (auto& thread : workers_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    if (cron_ && cron_->joinable()) {
+        cron_->join();
+    }
+
+    for (auto& queue : queues_) {
+        for (auto& request : queue->requests_) {
+            zmsg_destroy(&request);
+        }
+    }
+
+    workers_.clear();
+    queues_.clear();
+    cron_.reset();
 }
 
 void MessageProcessor::run()
 {
+    startThreads();
+
     for (;;) {
-        // timeout is the time left until the next cron should execute.
-        int64_t timeout = server_->computeTimeout();
-        if (timeout <= 0) {
-            server_->ProcessCron();
+        // Replies from the workers and requests from the clients both arrive
+        // here, since zmq sockets may only be used by the thread that polls
+        // them.
+        void* socket = zpoller_wait(zmqPoller_, 1000);
+
+        if (frontend_ == socket) {
+            processFrontend();
             continue;
         }
-
-        // wait for incoming message or up to timeout,
-        // i.e. stop polling in time for the next cron execution.
-        if (zpoller_wait(zmqPoller_, timeout)) {
-            processSocket();
+        if (backend_ == socket) {
+            processBackend();
             continue;
         }
         if (zpoller_terminated(zmqPoller_)) {
@@ -126,40 +204,208 @@ void MessageProcessor::run()
 
         if (!zpoller_expired(zmqPoller_)) {
             otErr << __FUNCTION__ << ": zpoller_wait error\n";
+            Log::Sleep(std::chrono::milliseconds(100));
         }
-
-        Log::Sleep(std::chrono::milliseconds(100));
     }
+
+    stopThreads();
 }
 
-void MessageProcessor::processSocket()
+void MessageProcessor::processFrontend()
 {
-    char* msg = zstr_recv(zmqSocket_);
-    if (msg == nullptr) {
+    // [identity][empty delimiter][request]
+    zmsg_t* msg = zmsg_recv(frontend_);
+
+    if (nullptr == msg) {
         Log::Error("zeromq recv() failed\n");
         return;
     }
-    std::string requestString(msg);
-    zstr_free(&msg);
 
-    std::string responseString;
+    zframe_t* identity = zmsg_first(msg);
+
+    if ((nullptr == identity) || (3 > zmsg_size(msg))) {
+        Log::Error("MessageProcessor: received malformed request\n");
+        zmsg_destroy(&msg);
+        return;
+    }
+
+    const std::string connection(
+        reinterpret_cast<const char*>(zframe_data(identity)),
+        zframe_size(identity));
+    WorkQueue& queue =
+        *queues_[std::hash<std::string>()(connection) % queues_.size()];
+
+    std::lock_guard<std::mutex> queueLock(queue.lock_);
+    queue.requests_.push_back(msg);
+    queue.signal_.notify_one();
+}
 
-    bool error = processMessage(requestString, responseString);
+void MessageProcessor::processBackend()
+{
+    zmsg_t* msg = zmsg_recv(backend_);
 
-    if (error) {
-        responseString = "";
+    if (nullptr == msg) {
+        Log::Error("zeromq recv() failed\n");
+        return;
     }
 
-    int rc = zstr_send(zmqSocket_, responseString.c_str());
+    int rc = zmsg_send(&msg, frontend_);
 
     if (rc != 0) {
-        Log::vError("MessageProcessor: failed to send response\n"
-                    "request:\n%s\n\n"
-                    "response:\n%s\n\n",
-                    requestString.c_str(), responseString.c_str());
+        Log::Error("MessageProcessor: failed to send response\n");
+        zmsg_destroy(&msg);
     }
 }
 
+void MessageProcessor::worker(WorkQueue* queue)
+{
+    OT_ASSERT(nullptr != queue);
+
+    zsock_t* replies = zsock_new_push(OT_NOTARY_REPLY_ENDPOINT);
+    OT_ASSERT(nullptr != replies);
+
+    for (;;) {
+        zmsg_t* msg = nullptr;
+
+        {
+            std::unique_lock<std::mutex> queueLock(queue->lock_);
+
+            while (!shutdown_.load() && queue->requests_.empty()) {
+                queue->signal_.wait(queueLock);
+            }
+
+            if (shutdown_.load()) {
+                break;
+            }
+
+            msg = queue->requests_.front();
+            queue->requests_.pop_front();
+        }
+
+        // The envelope stays on msg, and the reply is appended to it.
+        zframe_t* request = zmsg_last(msg);
+        std::string requestString(
+            reinterpret_cast<const char*>(zframe_data(request)),
+            zframe_size(request));
+        zmsg_remove(msg, request);
+        zframe_destroy(&request);
+
+        std::string responseString;
+
+        bool error = processMessage(requestString, responseString);
+
+        if (error) {
+            responseString = "";
+        }
+
+        zmsg_addmem(msg, responseString.data(), responseString.size());
+
+        if (0 != zmsg_send(&msg, replies)) {
+            Log::vError("MessageProcessor: failed to send response\n"
+                        "request:\n%s\n\n"
+                        "response:\n%s\n\n",
+                        requestString.c_str(), responseString.c_str());
+            zmsg_destroy(&msg);
+        }
+    }
+
+    zsock_destroy(&replies);
+}
+
+void MessageProcessor::cron()
+{
+    while (!shutdown_.load()) {
+        // timeout is the time left until the next cron should execute.
+        int64_t timeout = server_->computeTimeout();
+
+        if (timeout <= 0) {
+            // Cron touches the accounts and nymboxes of arbitrary Nyms.
+            auto stripeLocks = lockAllStripes();
+            server_->ProcessCron();
+
+            continue;
+        }
+
+        // Wake up periodically so shutdown isn't delayed for a full beat.
+        Log::Sleep(std::chrono::milliseconds(std::min<int64_t>(timeout, 100)));
+    }
+}
+
+std::set<std::size_t> MessageProcessor::getStripes(
+    const std::set<std::string>& keys)
+{
+    std::set<std::size_t> output;
+
+    for (const auto& key : keys) {
+        output.insert(std::hash<std::string>()(key) % LOCK_STRIPES);
+    }
+
+    return output;
+}
+
+std::vector<std::unique_lock<std::mutex>> MessageProcessor::lockStripes(
+    const Message& message)
+{
+    UserCommandProcessor& processor = server_->userCommandProcessor_;
+    std::set<std::size_t> stripes;
+
+    {
+        // The IDs named in the message. Finding the rest can mean reading
+        // the sender's inbox, which must not change while it is read.
+        std::set<std::string> keys;
+        const String* ids[] = {&message.m_strNymID, &message.m_strNymID2,
+                               &message.m_strAcctID};
+
+        for (const String* id : ids) {
+            if (id->Exists()) { keys.insert(id->Get()); }
+        }
+
+        stripes = getStripes(keys);
+    }
+
+    for (int attempt = 0; attempt < STRIPE_ATTEMPTS; ++attempt) {
+        // Locking in ascending stripe order prevents deadlocks between
+        // requests which touch more than one Nym or account.
+        std::vector<std::unique_lock<std::mutex>> output;
+
+        for (const auto& stripe : stripes) {
+            output.emplace_back(stripes_[stripe]);
+        }
+
+        std::set<std::string> keys;
+
+        if (!processor.LockKeys(message, keys)) {
+            output.clear();
+
+            return lockAllStripes();
+        }
+
+        const std::set<std::size_t> needed = getStripes(keys);
+
+        if (std::includes(stripes.begin(), stripes.end(), needed.begin(),
+                          needed.end())) {
+            return output;
+        }
+
+        // Start over holding every stripe found so far.
+        output.clear();
+        stripes.insert(needed.begin(), needed.end());
+    }
+
+    return lockAllStripes();
+}
+
+std::vector<std::unique_lock<std::mutex>> MessageProcessor::lockAllStripes()
+{
+    std::vector<std::unique_lock<std::mutex>> output;
+
+    for (std::size_t i = 0; i < LOCK_STRIPES; ++i) {
+        output.emplace_back(stripes_[i]);
+    }
+
+    return output;
+}
+
 bool MessageProcessor::processMessage(const std::string& messageString,
                                       std::string& reply)
 {
@@ -194,9 +440,13 @@ bool MessageProcessor::processMessage(const std::string& messageString,
 
     ClientConnection client;
     Nym nym(message.m_strNymID);
+    bool processedUserCmd = false;
 
-    bool processedUserCmd = server_->userCommandProcessor_.ProcessUserCommand(
-        message, replyMessage, &client, &nym);
+    {
+        auto stripeLocks = lockStripes(message);
+        processedUserCmd = server_->userCommandProcessor_.ProcessUserCommand(
+            message, replyMessage, &client, &nym);
+    }
 
     // By optionally passing in &client, the client Nym's public
     // key will be set on it whenever verification is complete. (So
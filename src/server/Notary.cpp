@@ -77,6 +77,7 @@
 #include <deque>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -92,6 +93,128 @@ Notary::Notary(OTServer* server)
 {
 }
 
+namespace
+{
+
+void insert_key(std::set<std::string>& keys, const Identifier& id)
+{
+    if (id.IsEmpty()) { return; }
+
+    keys.insert(String(id).Get());
+}
+
+void insert_unit_key(std::set<std::string>& keys, const Identifier& unitID)
+{
+    if (unitID.IsEmpty()) { return; }
+
+    keys.insert(std::string("unit ") + String(unitID).Get());
+}
+
+} // namespace
+
+bool Notary::LockKeys(
+    OTTransaction& transaction,
+    std::set<std::string>& keys) const
+{
+    const Identifier NOTARY_ID(server_->m_strNotaryID);
+    const Identifier& ACCOUNT_ID = transaction.GetPurportedAccountID();
+
+    insert_key(keys, ACCOUNT_ID);
+
+    // Transfers name the recipient account on the item.
+    for (auto& pItem : transaction.GetItemList()) {
+        OT_ASSERT(nullptr != pItem);
+
+        insert_key(keys, pItem->GetPurportedAccountID());
+        insert_key(keys, pItem->GetDestinationAcctID());
+    }
+
+    switch (transaction.GetType()) {
+        case OTTransaction::transfer:
+            return true;
+        case OTTransaction::processInbox: {
+            // Accepting a pending transfer updates the sender's inbox and
+            // outbox. The sender's account is only named on the original
+            // transfer item inside the pending receipt.
+            std::unique_ptr<Ledger> pInbox;
+
+            for (auto& pItem : transaction.GetItemList()) {
+                if ((Item::acceptPending != pItem->GetType()) &&
+                    (Item::rejectPending != pItem->GetType())) {
+                    continue;
+                }
+
+                if (!pInbox) {
+                    pInbox.reset(new Ledger(ACCOUNT_ID, NOTARY_ID));
+
+                    if (!pInbox->LoadInbox()) { return false; }
+                }
+
+                const int64_t lReceipt = pItem->GetReferenceToNum();
+                OTTransaction* pPending = pInbox->GetTransaction(lReceipt);
+
+                if (nullptr == pPending) { continue; }
+
+                if (pPending->IsAbbreviated()) {
+                    if (!pInbox->LoadBoxReceipt(lReceipt)) { return false; }
+
+                    pPending = pInbox->GetTransaction(lReceipt);
+
+                    if (nullptr == pPending) { return false; }
+                }
+
+                String strOriginalItem;
+                pPending->GetReferenceString(strOriginalItem);
+                std::unique_ptr<Item> pOriginalItem(Item::CreateItemFromString(
+                    strOriginalItem, NOTARY_ID, pPending->GetReferenceToNum()));
+
+                if (!pOriginalItem) { return false; }
+
+                insert_key(keys, pOriginalItem->GetPurportedAccountID());
+                insert_key(keys, pOriginalItem->GetDestinationAcctID());
+            }
+
+            return true;
+        }
+        case OTTransaction::withdrawal:
+        case OTTransaction::deposit: {
+            // Vouchers and cash move funds through the reserve accounts of
+            // the account's unit.
+            std::unique_ptr<Account> pAccount(
+                Account::LoadExistingAccount(ACCOUNT_ID, NOTARY_ID));
+
+            if (!pAccount) { return false; }
+
+            insert_unit_key(keys, pAccount->GetInstrumentDefinitionID());
+
+            Item* pItem = transaction.GetItem(Item::depositCheque);
+
+            if (nullptr == pItem) { return true; }
+
+            // A cheque deposit updates the drawer's Nym, account and inbox,
+            // and for a voucher the remitter's.
+            String strCheque;
+            pItem->GetAttachment(strCheque);
+            Cheque theCheque;
+
+            if (!theCheque.LoadContractFromString(strCheque)) { return false; }
+
+            insert_key(keys, theCheque.GetSenderNymID());
+            insert_key(keys, theCheque.GetSenderAcctID());
+            insert_unit_key(keys, theCheque.GetInstrumentDefinitionID());
+
+            if (theCheque.HasRemitter()) {
+                insert_key(keys, theCheque.GetRemitterNymID());
+                insert_key(keys, theCheque.GetRemitterAcctID());
+            }
+
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 void Notary::NotarizeTransfer(
     Nym& theNym,
     Account& theFromAccount,
@@ -4326,6 +4449,9 @@ void Notary::NotarizePaymentPlan(
     // paymentPlan request"
     tranOut.SetType(OTTransaction::atPaymentPlan);
 
+    // Cron items and markets are shared between all worker threads.
+    std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+
     Item* pItem = nullptr;
     Item* pBalanceItem = nullptr;
     Item* pResponseItem = nullptr;
@@ -5124,6 +5250,8 @@ void Notary::NotarizeSmartContract(
     // the smartContract request"
     tranOut.SetType(OTTransaction::atSmartContract);
 
+    std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+
     Item* pItem = nullptr;
     Item* pBalanceItem = nullptr;
     Item* pResponseItem = nullptr;
@@ -5904,6 +6032,8 @@ void Notary::NotarizeCancelCronItem(
     // the cancelCronItem request"
     tranOut.SetType(OTTransaction::atCancelCronItem);
 
+    std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+
     Item* pItem = nullptr;
     Item* pBalanceItem = nullptr;
     Item* pResponseItem = nullptr;
@@ -7028,6 +7158,8 @@ void Notary::NotarizeMarketOffer(
     // marketOffer request"
     tranOut.SetType(OTTransaction::atMarketOffer);
 
+    std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+
     Item* pItem = nullptr;
     Item* pBalanceItem = nullptr;
     Item* pResponseItem = nullptr;
@@ -8102,9 +8234,7 @@ void Notary::NotarizeProcessNymbox(
 
             // Remove all issued nums from theNym that are stored on theTempNym
             // HERE.
-            for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID);
-                 i++) {
-                int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+            for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
                 theNym.RemoveIssuedNum(server_->m_strNotaryID, lTemp);
             }
         }
@@ -8125,18 +8255,14 @@ void Notary::NotarizeProcessNymbox(
 
             // Remove all issued nums from theNym that are stored on theTempNym
             // HERE.
-            for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID);
-                 i++) {
-                int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+            for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
                 theNym.RemoveIssuedNum(server_->m_strNotaryID, lTemp);
             }
         } else  // TRANSACTION AGREEMENT WAS SUCCESSFUL.......
         {
             // Remove all issued nums from theNym that are stored on theTempNym
             // HERE.
-            for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID);
-                 i++) {
-                int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+            for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
                 theNym.RemoveIssuedNum(server_->m_strNotaryID, lTemp);
             }
 
@@ -9223,9 +9349,7 @@ void Notary::NotarizeProcessInbox(
             // they were really there.
             // Otherwise it'd be pretty stupid to "re-add" them, eh?
             //
-            for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID);
-                 i++) {
-                int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+            for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
                 theNym.RemoveIssuedNum(server_->m_strNotaryID, lTemp);
             }
 
@@ -9243,9 +9367,7 @@ void Notary::NotarizeProcessInbox(
             // Here, add all the issued nums back (that had been temporarily
             // removed from theNym) that were stored on theTempNym for
             // safe-keeping.
-            for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID);
-                 i++) {
-                int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+            for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
                 theNym.AddIssuedNum(server_->m_strNotaryID, lTemp);
             }
             // (They are removed for real at the bottom of this function, IF
@@ -10092,8 +10214,7 @@ void Notary::NotarizeProcessInbox(
         // Therefore, remove any relevant issued numbers from theNym (those he's
         // now officially no longer responsible for), and save.
         //
-        for (int32_t i = 0; i < theTempNym.GetIssuedNumCount(NOTARY_ID); i++) {
-            int64_t lTemp = theTempNym.GetIssuedNum(NOTARY_ID, i);
+        for (const int64_t& lTemp : theTempNym.GetIssuedNums(NOTARY_ID)) {
             theNym.RemoveIssuedNum(
                 server_->m_nymServer,
                 server_->m_strNotaryID,
@@ -10106,10 +10227,8 @@ void Notary::NotarizeProcessInbox(
         // list.
         //
         std::set<int64_t>& theIDSet = theNym.GetSetOpenCronItems();
-        for (int32_t i = 0;
-             i < theTempClosingNumNym.GetIssuedNumCount(NOTARY_ID);
-             i++) {
-            int64_t lTemp = theTempClosingNumNym.GetIssuedNum(NOTARY_ID, i);
+        for (const int64_t& lTemp :
+             theTempClosingNumNym.GetIssuedNums(NOTARY_ID)) {
             theIDSet.erase(lTemp);  // now it's erased from within the Nym.
         }
         theNym.SaveSignedNymfile(server_->m_nymServer);
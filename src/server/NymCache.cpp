@@ -0,0 +1,240 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/server/NymCache.hpp"
+
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/Nym.hpp"
+#include "opentxs/core/Proto.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/app/App.hpp"
+#include "opentxs/core/crypto/OTSignedFile.hpp"
+#include "opentxs/core/util/OTFolders.hpp"
+#include "opentxs/server/ServerSettings.hpp"
+#include "opentxs/storage/Storage.hpp"
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+NymCache::NymCache()
+{
+    // Every nymfile the server writes passes through here, so the cached
+    // copy never falls behind the file on disk.
+    Nym::SetNymfileCallback(
+        [this](const String& nymID, const String& payload) {
+            Update(nymID, payload);
+        });
+}
+
+NymCache::~NymCache() { Nym::SetNymfileCallback(NymfileCallback()); }
+
+bool NymCache::LoadCredentials(Nym& nym, bool& verified)
+{
+    verified = false;
+
+    const String nymID(nym.GetConstID());
+    std::shared_ptr<const proto::CredentialIndex> index;
+
+    if (!App::Me().DB().Load(nymID.Get(), index)) {
+        otErr << __FUNCTION__
+              << ": Failed trying to load credential list for nym: " << nymID
+              << "\n";
+
+        return false;
+    }
+
+    std::shared_ptr<const proto::CredentialIndex> credentials;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = entries_.find(nymID.Get());
+
+        if (entries_.end() != it) {
+            // Any change to the credentials bumps the stored revision.
+            if (it->second.revision_ == index->revision()) {
+                credentials = it->second.credentials_;
+            }
+
+            lru_.splice(lru_.begin(), lru_, it->second.position_);
+        }
+    }
+
+    if (credentials) {
+        verified = nym.LoadCredentialIndex(*credentials) &&
+                   (nym.GetMasterCredentialCount() > 0);
+
+        return verified;
+    }
+
+    return nym.LoadCredentialIndex(*index) &&
+           (nym.GetMasterCredentialCount() > 0);
+}
+
+void NymCache::SetVerified(const Nym& nym)
+{
+    const int32_t capacity = ServerSettings::GetNymCacheSize();
+
+    if (capacity <= 0) { return; }
+
+    const std::string nymID = String(nym.GetConstID()).Get();
+    std::shared_ptr<const proto::CredentialIndex> credentials(
+        new proto::CredentialIndex(nym.asPublicNym()));
+
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(nymID);
+
+    if (entries_.end() == it) {
+        it = entries_.insert(std::make_pair(nymID, Entry())).first;
+        it->second.generation_ = ++generation_;
+        lru_.push_front(nymID);
+        it->second.position_ = lru_.begin();
+    } else {
+        lru_.splice(lru_.begin(), lru_, it->second.position_);
+    }
+
+    it->second.revision_ = nym.Revision();
+    it->second.credentials_ = credentials;
+
+    while (lru_.size() > static_cast<std::size_t>(capacity)) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+bool NymCache::LoadNymfile(Nym& nym, Nym& signer)
+{
+    const String nymID(nym.GetConstID());
+    std::string cachedPayload;
+    std::uint64_t generation = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = entries_.find(nymID.Get());
+
+        if (entries_.end() != it) {
+            cachedPayload = it->second.payload_;
+            generation = it->second.generation_;
+        }
+    }
+
+    if (!cachedPayload.empty()) {
+        return nym.LoadNymFromString(String(cachedPayload));
+    }
+
+    OTSignedFile theNymfile(OTFolders::Nym(), nymID);
+
+    if (!theNymfile.LoadFile()) {
+        otWarn << __FUNCTION__ << ": Failed loading a signed nymfile: " << nymID
+               << "\n";
+
+        return false;
+    }
+
+    if (!theNymfile.VerifyFile()) {
+        otErr << __FUNCTION__ << ": Failed verifying nymfile: " << nymID
+              << "\n";
+
+        return false;
+    }
+
+    if (!theNymfile.VerifySignature(signer)) {
+        otErr << __FUNCTION__ << ": Failed verifying signature on nymfile: "
+              << nymID << "\n";
+
+        return false;
+    }
+
+    const String& strPayload = theNymfile.GetFilePayload();
+
+    if (!strPayload.Exists() || !nym.LoadNymFromString(strPayload)) {
+        otErr << __FUNCTION__ << ": Failed reading nymfile: " << nymID
+              << "\n";
+
+        return false;
+    }
+
+    setNymfile(nymID, generation, strPayload);
+
+    return true;
+}
+
+void NymCache::Update(const String& nymID, const String& payload)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(nymID.Get());
+
+    if (entries_.end() == it) { return; }
+
+    it->second.payload_ = payload.Get();
+    it->second.generation_ = ++generation_;
+}
+
+void NymCache::Invalidate(const String& nymID)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(nymID.Get());
+
+    if (entries_.end() == it) { return; }
+
+    lru_.erase(it->second.position_);
+    entries_.erase(it);
+}
+
+void NymCache::setNymfile(const String& nymID, const std::uint64_t generation,
+                          const String& payload)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(nymID.Get());
+
+    // Only Nyms with verified credentials get an entry.
+    if (entries_.end() == it) { return; }
+
+    // Saved again while this copy was read from disk
+    if (generation != it->second.generation_) { return; }
+
+    it->second.payload_ = payload.Get();
+}
+
+} // namespace opentxs
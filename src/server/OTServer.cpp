@@ -64,6 +64,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 #include <fstream>
+#include <mutex>
 #include <string>
 
 #define SERVER_PID_FILENAME "ot.pid"
@@ -100,6 +101,8 @@ void OTServer::ActivateCron()
 ///
 void OTServer::ProcessCron()
 {
+    std::lock_guard<std::recursive_mutex> cronLock(cron_lock_);
+
     if (!m_Cron.IsActivated()) return;
 
     bool bAddedNumbers = false;
@@ -119,7 +122,7 @@ void OTServer::ProcessCron()
     }
 
     if (bAddedNumbers) {
-        m_Cron.SaveCron();
+        m_Cron.SaveTransactionNumbers();
     }
 
     m_Cron.ProcessCronItems();  // This needs to be called regularly for trades,
@@ -43,6 +43,7 @@
 #include "opentxs/core/AccountList.hpp"
 #include "opentxs/core/Identifier.hpp"
 #include "opentxs/core/Log.hpp"
+#include "opentxs/core/NumList.hpp"
 #include "opentxs/core/Nym.hpp"
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/util/Assert.hpp"
@@ -54,6 +55,7 @@
 #include <stdint.h>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -62,6 +64,7 @@ namespace opentxs
 
 Transactor::Transactor(OTServer* server)
     : transactionNumber_(0)
+    , reservedTransactionNumber_(0)
     , server_(server)
 {
 }
@@ -88,28 +91,74 @@ Transactor::~Transactor()
 /// can be used in transaction requests.
 bool Transactor::issueNextTransactionNumber(int64_t& lTransactionNumber)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // transactionNumber_ stores the last VALID AND ISSUED transaction number.
-    // So first, we increment that, since we don't want to issue the same number
-    // twice.
+    // So first, we make sure the next one is already reserved in the main
+    // file, since we don't want to issue the same number twice (not even after
+    // a crash.)
+    if (!reserveTransactionNumbers(1)) { return false; }
+
     transactionNumber_++;
 
-    // Next, we save it to file.
+    // SUCCESS?
+    // Now the server main file has saved a number at least this high,
+    // NOW we set it onto the parameter and return true.
+    lTransactionNumber = transactionNumber_;
+    return true;
+}
+
+/// Same as issueNextTransactionNumber, for count numbers at once. They are
+/// added to txNumbers.
+bool Transactor::issueNextTransactionNumbers(int32_t count, NumList& txNumbers)
+{
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
+    if (!reserveTransactionNumbers(count)) { return false; }
+
+    for (int32_t i = 0; i < count; i++) {
+        transactionNumber_++;
+        txNumbers.Add(transactionNumber_);
+    }
+
+    return true;
+}
+
+// Makes sure at least count numbers after transactionNumber_ are reserved in
+// the main file. Saving the main file means re-signing the whole thing, so
+// instead of saving it for every number, a whole block is reserved at once
+// and then handed out from memory. If the server stops before the block is
+// used up, the rest of it is skipped. (MainFile only ever loads the reserved
+// number.)
+//
+// Caller must hold lock_.
+bool Transactor::reserveTransactionNumbers(int64_t count)
+{
+    if ((reservedTransactionNumber_ - transactionNumber_) >= count) {
+        return true;
+    }
+
+    int64_t block = TRANSACTION_NUMBER_BLOCK;
+
+    if (count > block) { block = count; }
+
+    const int64_t previous = reservedTransactionNumber_;
+    reservedTransactionNumber_ = transactionNumber_ + block;
+
     if (!server_->mainFile_.SaveMainFile()) {
         Log::Error("Error saving main server file.\n");
-        transactionNumber_--;
+        reservedTransactionNumber_ = previous;
         return false;
     }
 
-    // SUCCESS?
-    // Now the server main file has saved the latest transaction number,
-    // NOW we set it onto the parameter and return true.
-    lTransactionNumber = transactionNumber_;
     return true;
 }
 
 bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
                                                  int64_t& lTransactionNumber)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     Identifier NYM_ID(theNym), NOTARY_NYM_ID(server_->m_nymServer);
 
     // If theNym has the same ID as server_->m_nymServer, then we'll use
@@ -138,11 +187,9 @@ bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
     if (!pNym->AddTransactionNum(server_->m_nymServer, server_->m_strNotaryID,
                                  transactionNumber_, true)) {
         Log::Error("Error adding transaction number to Nym file.\n");
-        transactionNumber_--;
-        server_->mainFile_.SaveMainFile(); // Save it back how it was, since
-                                           // we're not
-                                           // issuing this
-                                           // number after all.
+        transactionNumber_--; // We're not issuing this number after all.
+                              // (It stays reserved, so it can be issued
+                              // next time.)
         return false;
     }
 
@@ -263,6 +310,8 @@ bool Transactor::addBasketAccountID(const Identifier& BASKET_ID,
                                     const Identifier& BASKET_ACCOUNT_ID,
                                     const Identifier& BASKET_CONTRACT_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     Identifier theBasketAcctID;
 
     if (lookupBasketAccountID(BASKET_ID, theBasketAcctID)) {
@@ -287,6 +336,8 @@ bool Transactor::addBasketAccountID(const Identifier& BASKET_ID,
 bool Transactor::lookupBasketAccountIDByContractID(
     const Identifier& BASKET_CONTRACT_ID, Identifier& BASKET_ACCOUNT_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // Server stores a map of BASKET_ID to BASKET_ACCOUNT_ID. Let's iterate
     // through that map...
     for (auto& it : contractIdToBasketAccountId_) {
@@ -314,6 +365,8 @@ bool Transactor::lookupBasketAccountIDByContractID(
 bool Transactor::lookupBasketContractIDByAccountID(
     const Identifier& BASKET_ACCOUNT_ID, Identifier& BASKET_CONTRACT_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // Server stores a map of BASKET_ID to BASKET_ACCOUNT_ID. Let's iterate
     // through that map...
     for (auto& it : contractIdToBasketAccountId_) {
@@ -341,6 +394,8 @@ bool Transactor::lookupBasketContractIDByAccountID(
 bool Transactor::lookupBasketAccountID(const Identifier& BASKET_ID,
                                        Identifier& BASKET_ACCOUNT_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     // Server stores a map of BASKET_ID to BASKET_ACCOUNT_ID. Let's iterate
     // through that map...
     for (auto& it : idToBasketMap_) {
@@ -367,6 +422,8 @@ bool Transactor::lookupBasketAccountID(const Identifier& BASKET_ID,
 std::shared_ptr<Account> Transactor::getVoucherAccount(
     const Identifier& INSTRUMENT_DEFINITION_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     std::shared_ptr<Account> pAccount;
     const Identifier NOTARY_NYM_ID(server_->m_nymServer),
         NOTARY_ID(server_->m_strNotaryID);
@@ -397,6 +454,8 @@ Mint* Transactor::getMint(const Identifier& INSTRUMENT_DEFINITION_ID,
                           int32_t nSeries) // Each asset contract has its own
                                            // Mint.
 {
+    std::lock_guard<std::recursive_mutex> lock(lock_);
+
     Mint* pMint = nullptr;
 
     for (auto& it : mintsMap_) {
@@ -75,6 +75,7 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -86,6 +87,72 @@ UserCommandProcessor::UserCommandProcessor(OTServer* server)
 {
 }
 
+bool UserCommandProcessor::LockKeys(
+    const Message& msgIn,
+    std::set<std::string>& keys) const
+{
+    const String* ids[] = {
+        &msgIn.m_strNymID, &msgIn.m_strNymID2, &msgIn.m_strAcctID};
+
+    for (const String* id : ids) {
+        if (id->Exists()) { keys.insert(id->Get()); }
+    }
+
+    // These commands only modify the Nyms and account named in the message:
+    // the sender's request and transaction numbers, its Nymbox, and the
+    // recipient's Nymbox for sendNymMessage / sendNymInstrument.
+    static const std::set<std::string> confined{
+        "pingNotary",
+        "registerNym",
+        "unregisterNym",
+        "getRequestNumber",
+        "getTransactionNumbers",
+        "checkNym",
+        "sendNymMessage",
+        "sendNymInstrument",
+        "registerAccount",
+        "unregisterAccount",
+        "getNymbox",
+        "getBoxReceipt",
+        "getAccountData",
+        "processNymbox",
+        "queryInstrumentDefinitions",
+        "getInstrumentDefinition",
+        "getMint",
+        "getMarketList",
+        "getMarketOffers",
+        "getMarketRecentTrades",
+        "getNymMarketOffers",
+        "usageCredits"};
+    const std::string command = msgIn.m_strCommand.Get();
+
+    if (0 < confined.count(command)) { return true; }
+
+    const bool bNotarize = ("notarizeTransaction" == command);
+
+    if (!bNotarize && ("processInbox" != command)) { return false; }
+
+    // Any other account a transaction reaches is named inside it.
+    const Identifier NYM_ID(msgIn.m_strNymID), ACCOUNT_ID(msgIn.m_strAcctID),
+        NOTARY_ID(server_->m_strNotaryID);
+    Ledger theLedger(NYM_ID, ACCOUNT_ID, NOTARY_ID);
+    const String strLedger(msgIn.m_ascPayload);
+    const bool bLoaded = bNotarize ? theLedger.LoadLedgerFromString(strLedger)
+                                   : theLedger.LoadContractFromString(strLedger);
+
+    // Processing fails the same way, before it touches anything.
+    if (!bLoaded) { return true; }
+
+    for (auto& it : theLedger.GetTransactionMap()) {
+        OTTransaction* pTransaction = it.second;
+        OT_ASSERT(nullptr != pTransaction);
+
+        if (!server_->notary_.LockKeys(*pTransaction, keys)) { return false; }
+    }
+
+    return true;
+}
+
 // this function will create the Nym if it's not passed in. We pass it in so the
 // caller has the option to query things about the Nym (like if it actually
 // exists.)
@@ -242,6 +309,8 @@ bool UserCommandProcessor::ProcessUserCommand(
                 serialized.nymid().c_str());
         } else {
             pNym->LoadCredentialIndex(nym->asPublicNym());
+            // The credentials may have just been updated.
+            nym_cache_.Invalidate(strMsgNymID);
             Log::Output(3, "Pseudonym verified!\n");
             // Okay, now that the Nym is verified, let's verify the
             // message itself...
@@ -484,11 +553,13 @@ bool UserCommandProcessor::ProcessUserCommand(
     // If it is, then we read the public key from that Pseudonym and use it to
     // verify any
     // requests bearing that NymID.
+    //
+    // Credentials which were already verified by an earlier request come out
+    // of nym_cache_, and don't need to be verified again.
+    bool bNymVerified = false;
+
     if (!bNymIsServerNym &&
-        (false == pNym->LoadPublicKey())  // && // Old style. (Deprecated, but
-                                          // fine for now since it calls
-                                          // LoadCredentials.)
-        ) {
+        (false == nym_cache_.LoadCredentials(*pNym, bNymVerified))) {
         Log::vError(
             "Failure loading public credentials for Nym: %s\n",
             theMessage.m_strNymID.Get());
@@ -507,12 +578,16 @@ bool UserCommandProcessor::ProcessUserCommand(
     // signature
     // on the message that we're processing.
 
-    if (!pNym->VerifyPseudonym()) {
-        Log::Output(
-            0,
-            "Pseudonym failed to verify. Hash of public key doesn't match "
-            "Nym ID that was sent.\n");
-        return false;
+    if (!bNymVerified) {
+        if (!pNym->VerifyPseudonym()) {
+            Log::Output(
+                0,
+                "Pseudonym failed to verify. Hash of public key doesn't match "
+                "Nym ID that was sent.\n");
+            return false;
+        }
+
+        if (!bNymIsServerNym) { nym_cache_.SetVerified(*pNym); }
     }
     Log::Output(3, "Pseudonym verified!\n");
 
@@ -538,7 +613,8 @@ bool UserCommandProcessor::ProcessUserCommand(
     // Now we might as well load up the rest of the Nym.
     // Notice I use the && to only load the nymfile if it's NOT the
     // server Nym.
-    if (!bNymIsServerNym && !pNym->LoadSignedNymfile(server_->m_nymServer)) {
+    if (!bNymIsServerNym &&
+        !nym_cache_.LoadNymfile(*pNym, server_->m_nymServer)) {
         Log::vError("Error loading Nymfile: %s\n", theMessage.m_strNymID.Get());
         return false;
     }
@@ -869,14 +945,10 @@ bool UserCommandProcessor::ProcessUserCommand(
     NumList numlist_to_remove;  // a temp variable where we will put the
                                 // numbers "to be removed" (so we can remove
                                 // them all at once, after the loop.)
-    const int32_t nAcknowledgedNumCount =
-        pNym->GetAcknowledgedNumCount(NOTARY_ID);
-
-    if (nAcknowledgedNumCount > 0) {
-        for (int32_t i = 0; i < nAcknowledgedNumCount; i++) {
-            const int64_t lAcknowledgedNum =
-                pNym->GetAcknowledgedNum(NOTARY_ID, i);  // index
+    const NumberSet& theAcknowledgedNums = pNym->GetAcknowledgedNums(NOTARY_ID);
 
+    if (!theAcknowledgedNums.empty()) {
+        for (const int64_t& lAcknowledgedNum : theAcknowledgedNums) {
             // For any numbers on the server's internal list but NOT on the
             // client's list (according
             // to the incoming message) the server removes them from its
@@ -1286,7 +1358,11 @@ void UserCommandProcessor::UserCmdGetMarketList(
     OTASCIIArmor ascOutput;
     int32_t nMarketCount = 0;
 
-    msgOut.m_bSuccess = server_->m_Cron.GetMarketList(ascOutput, nMarketCount);
+    {
+        std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+        msgOut.m_bSuccess =
+            server_->m_Cron.GetMarketList(ascOutput, nMarketCount);
+    }
 
     // If success,
     if ((true == msgOut.m_bSuccess) && (nMarketCount > 0)) {
@@ -1333,21 +1409,24 @@ void UserCommandProcessor::UserCmdGetMarketOffers(
 
     const Identifier MARKET_ID(MsgIn.m_strNymID2);
 
-    OTMarket* pMarket = server_->m_Cron.GetMarket(MARKET_ID);
-
-    // If success,
-    if ((msgOut.m_bSuccess =
-             ((pMarket != nullptr) ? true : false)))  // if assigned true
     {
-        OTASCIIArmor ascOutput;
-        int32_t nOfferCount = 0;
+        std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+        OTMarket* pMarket = server_->m_Cron.GetMarket(MARKET_ID);
 
-        msgOut.m_bSuccess =
-            pMarket->GetOfferList(ascOutput, lDepth, nOfferCount);
+        // If success,
+        if ((msgOut.m_bSuccess =
+                 ((pMarket != nullptr) ? true : false)))  // if assigned true
+        {
+            OTASCIIArmor ascOutput;
+            int32_t nOfferCount = 0;
+
+            msgOut.m_bSuccess =
+                pMarket->GetOfferList(ascOutput, lDepth, nOfferCount);
 
-        if ((true == msgOut.m_bSuccess) && (nOfferCount > 0)) {
-            msgOut.m_ascPayload = ascOutput;
-            msgOut.m_lDepth = nOfferCount;
+            if ((true == msgOut.m_bSuccess) && (nOfferCount > 0)) {
+                msgOut.m_ascPayload = ascOutput;
+                msgOut.m_lDepth = nOfferCount;
+            }
         }
     }
 
@@ -1385,21 +1464,25 @@ void UserCommandProcessor::UserCmdGetMarketRecentTrades(
 
     const Identifier MARKET_ID(MsgIn.m_strNymID2);
 
-    OTMarket* pMarket = server_->m_Cron.GetMarket(MARKET_ID);
-
-    // If success,
-    if ((msgOut.m_bSuccess =
-             ((pMarket != nullptr) ? true : false)))  // if assigned true
     {
-        OTASCIIArmor ascOutput;
-        int32_t nTradeCount = 0;
+        std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+        OTMarket* pMarket = server_->m_Cron.GetMarket(MARKET_ID);
 
-        msgOut.m_bSuccess = pMarket->GetRecentTradeList(ascOutput, nTradeCount);
+        // If success,
+        if ((msgOut.m_bSuccess =
+                 ((pMarket != nullptr) ? true : false)))  // if assigned true
+        {
+            OTASCIIArmor ascOutput;
+            int32_t nTradeCount = 0;
+
+            msgOut.m_bSuccess =
+                pMarket->GetRecentTradeList(ascOutput, nTradeCount);
 
-        if (true == msgOut.m_bSuccess) {
-            msgOut.m_lDepth = nTradeCount;
+            if (true == msgOut.m_bSuccess) {
+                msgOut.m_lDepth = nTradeCount;
 
-            if (nTradeCount > 0) msgOut.m_ascPayload = ascOutput;
+                if (nTradeCount > 0) msgOut.m_ascPayload = ascOutput;
+            }
         }
     }
 
@@ -1441,8 +1524,11 @@ void UserCommandProcessor::UserCmdGetNymMarketOffers(
     OTASCIIArmor ascOutput;
     int32_t nOfferCount = 0;
 
-    msgOut.m_bSuccess =
-        server_->m_Cron.GetNym_OfferList(ascOutput, NYM_ID, nOfferCount);
+    {
+        std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
+        msgOut.m_bSuccess =
+            server_->m_Cron.GetNym_OfferList(ascOutput, NYM_ID, nOfferCount);
+    }
 
     if ((msgOut.m_bSuccess) && (nOfferCount > 0)) {
 
@@ -1567,28 +1653,19 @@ void UserCommandProcessor::UserCmdGetTransactionNumbers(
         // Update: Now we're going to grab 20 or 30 transaction numbers,
         // instead of just 1 like before!!!
         //
-        for (int32_t i = 0; i < 100;
-             i++)  // todo, hardcoding!!!! (But notice we
-                   // grab 100 transaction numbers at a
-                   // time now.)
-        {
-            int64_t lTransNum = 0;
-            // This call will save the new transaction number to the nym's file.
-            // ??? Why did I say that, when clearly the last parameter is false?
-            // AHHHH Because I drop it into the Nymbox instead, and make him
-            // sign for it!
-
-            if (!server_->transactor_.issueNextTransactionNumber(lTransNum)) {
-                lTransNum = 0;
-                Log::Error(
-                    "UserCommandProcessor::UserCmdGetTransactionNumbers: "
-                    "Error issuing "
-                    "next transaction number!\n");
-                bSuccess = false;
-                break;
-            }
-
-            theNumlist.Add(lTransNum);  // <=========
+        // These aren't saved to the nym's file. I drop them into the Nymbox
+        // instead, and make him sign for them!
+        //
+        if (!server_->transactor_.issueNextTransactionNumbers(
+                100,  // todo, hardcoding!!!! (But notice we
+                      // grab 100 transaction numbers at a
+                      // time now.)
+                theNumlist)) {
+            Log::Error(
+                "UserCommandProcessor::UserCmdGetTransactionNumbers: "
+                "Error issuing "
+                "next transaction numbers!\n");
+            bSuccess = false;
         }
 
         int64_t transactionNumber;
@@ -3197,6 +3274,7 @@ void UserCommandProcessor::UserCmdTriggerClause(
             "(Send a getNymbox message to grab the newest one.)\n",
             __FUNCTION__);
     } else {
+        std::lock_guard<std::recursive_mutex> cronLock(server_->cron_lock_);
         OTSmartContract* pSmartContract = nullptr;
         OTCronItem* pCronItem =
             server_->m_Cron.GetItemByValidOpeningNum(MsgIn.m_lTransactionNum);
@@ -3416,6 +3494,8 @@ void UserCommandProcessor::UserCmdDeleteUser(
     msgOut.m_strCommand = "unregisterNymResponse";  // reply to unregisterNym
     msgOut.m_strNymID = MsgIn.m_strNymID;           // NymID
 
+    nym_cache_.Invalidate(MsgIn.m_strNymID);
+
     const Identifier NYM_ID(MsgIn.m_strNymID), NOTARY_ID(MsgIn.m_strNotaryID);
 
     Ledger theLedger(NYM_ID, NYM_ID, NOTARY_ID);
@@ -43,11 +43,15 @@
 #include "opentxs/storage/StorageFS.hpp"
 #elif defined OT_STORAGE_SQLITE
 #include "opentxs/storage/StorageSqlite3.hpp"
+#elif defined OT_STORAGE_LMDB
+#include "opentxs/storage/StorageLMDB.hpp"
 #endif
 
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <functional>
@@ -58,16 +62,470 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
+
+// Most items a node of an index tree lists before it is split
+#define OT_STORAGE_INDEX_LEAF_SIZE 64
+// A node's path has one hex digit per level, so the tree is at most this deep
+#define OT_STORAGE_INDEX_DEPTH 8
+// Version of an index object which lists child nodes instead of items
+#define OT_STORAGE_INDEX_NODE_VERSION 2
+// Version of an index entry which refers to a child node instead of an item
+#define OT_STORAGE_INDEX_CHILD_VERSION 2
+#define OT_STORAGE_INDEX_CHILD_PREFIX "#"
 
 namespace opentxs
 {
+namespace
+{
+typedef ::google::protobuf::RepeatedPtrField<proto::StorageItemHash>
+    ItemHashList;
+
+// Item ids are placed in the tree by FNV-1a, since their position has to
+// stay the same across builds and platforms.
+uint32_t index_key(const std::string& id)
+{
+    uint32_t hash = 2166136261u;
+
+    for (const auto& c : id) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+std::string index_path(const uint32_t key)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string output;
+
+    for (int i = OT_STORAGE_INDEX_DEPTH - 1; i >= 0; --i) {
+        output.push_back(digits[(key >> (4 * i)) & 0xf]);
+    }
+
+    return output;
+}
+
+// The keys under a node are those in [first, last)
+void index_range(const std::string& path, uint64_t& first, uint64_t& last)
+{
+    const uint64_t prefix =
+        path.empty() ? 0 : std::strtoull(path.c_str(), nullptr, 16);
+    const std::size_t shift = 4 * (OT_STORAGE_INDEX_DEPTH - path.size());
+
+    first = prefix << shift;
+    last = (prefix + 1) << shift;
+}
+
+bool parse_child_label(const std::string& id, char& digit)
+{
+    const std::string prefix = OT_STORAGE_INDEX_CHILD_PREFIX;
+
+    if ((prefix.size() + 1) != id.size()) { return false; }
+    if (0 != id.compare(0, prefix.size(), prefix)) { return false; }
+
+    digit = id.back();
+
+    return (('0' <= digit) && ('9' >= digit)) ||
+           (('a' <= digit) && ('f' >= digit));
+}
+
+// Drops everything recorded below path
+template<class T>
+void erase_below(T& container, const std::string& path)
+{
+    auto it = container.upper_bound(path);
+
+    while ((container.end() != it) &&
+           (0 == it->compare(0, path.size(), path))) {
+        it = container.erase(it);
+    }
+}
+
+void erase_below(
+    std::map<std::string, std::string>& container,
+    const std::string& path)
+{
+    auto it = container.upper_bound(path);
+
+    while ((container.end() != it) &&
+           (0 == it->first.compare(0, path.size(), path))) {
+        it = container.erase(it);
+    }
+}
+
+// An interior node is marked twice: by its own version, and by the version
+// of every entry in it. Neither is a version proto::Check accepts, so a node
+// can never pass for a leaf or be read as one by code which predates the tree.
+template<class T>
+bool verify_index_node(const T& node, const ItemHashList& (T::*list)() const)
+{
+    if (OT_STORAGE_INDEX_NODE_VERSION != node.version()) {
+        return proto::Check<T>(node, 0, 0xFFFFFFFF);
+    }
+
+    // Empty subtrees are left out, so an interior node always has children
+    if (0 == (node.*list)().size()) { return false; }
+
+    char previous = 0;
+
+    for (const auto& it : (node.*list)()) {
+        char digit = 0;
+
+        if (OT_STORAGE_INDEX_CHILD_VERSION != it.version()) { return false; }
+        if (!parse_child_label(it.itemid(), digit)) { return false; }
+        // Children are written in digit order, which also rules out repeats
+        if ((0 != previous) && (digit <= previous)) { return false; }
+        if (it.hash().empty()) { return false; }
+        if (!it.alias().empty()) { return false; }
+
+        previous = digit;
+    }
+
+    return true;
+}
+} // namespace
+
 Storage* Storage::instance_pointer_ = nullptr;
 
+class Storage::Batch
+{
+private:
+    const Storage& storage_;
+    bool open_;
+
+    Batch() = delete;
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+
+public:
+    explicit Batch(const Storage& storage)
+        : storage_(storage)
+        , open_(storage.BeginBatch())
+    {
+    }
+
+    // Commits now instead of on destruction, for callers which need to know
+    // whether the backend accepted the writes.
+    bool Commit()
+    {
+        if (!open_) { return true; }
+
+        open_ = false;
+
+        return storage_.CommitBatch();
+    }
+
+    ~Batch()
+    {
+        if (open_) {
+            storage_.CommitBatch();
+        }
+    }
+};
+
+void Storage::SharedMutex::lock()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    ++writers_waiting_;
+    signal_.wait(lock, [this]() { return !writer_ && (0 == readers_); });
+    --writers_waiting_;
+    writer_ = true;
+}
+
+void Storage::SharedMutex::unlock()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    writer_ = false;
+    lock.unlock();
+    signal_.notify_all();
+}
+
+void Storage::SharedMutex::lock_shared()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    signal_.wait(
+        lock, [this]() { return !writer_ && (0 == writers_waiting_); });
+    ++readers_;
+}
+
+void Storage::SharedMutex::unlock_shared()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    const bool last = (0 == --readers_);
+    lock.unlock();
+
+    if (last) {
+        signal_.notify_all();
+    }
+}
+
+void Storage::IndexTree::Add(const std::string& id)
+{
+    keys_.insert({index_key(id), id});
+}
+
+void Storage::IndexTree::Touch(const std::string& id)
+{
+    const uint32_t key = index_key(id);
+    const std::string path = index_path(key);
+    keys_.insert({key, id});
+
+    for (std::size_t i = 1; i <= path.size(); ++i) {
+        dirty_.insert(path.substr(0, i));
+    }
+}
+
+void Storage::IndexTree::Remove(const std::string& id)
+{
+    const uint32_t key = index_key(id);
+    const std::string path = index_path(key);
+    keys_.erase({key, id});
+
+    for (std::size_t i = 1; i <= path.size(); ++i) {
+        dirty_.insert(path.substr(0, i));
+    }
+}
+
+bool Storage::Verify(const proto::StorageNymList& data)
+{
+    return verify_index_node(data, &proto::StorageNymList::nym);
+}
+
+bool Storage::Verify(const proto::StorageServers& data)
+{
+    return verify_index_node(data, &proto::StorageServers::server);
+}
+
+bool Storage::Verify(const proto::StorageUnits& data)
+{
+    return verify_index_node(data, &proto::StorageUnits::unit);
+}
+
+template<class T>
+bool Storage::LoadIndex(
+    const std::string& hash,
+    const ItemHashList& (T::*list)() const,
+    std::vector<proto::StorageItemHash>& items,
+    std::map<std::string, std::string>& nodes,
+    const std::string& path)
+{
+    std::shared_ptr<const T> index;
+
+    if (!LoadProto(hash, index)) { return false; }
+
+    if (!path.empty()) { nodes[path] = hash; }
+
+    if (OT_STORAGE_INDEX_NODE_VERSION != index->version()) {
+        for (const auto& it : ((*index).*list)()) {
+            items.push_back(it);
+        }
+
+        return true;
+    }
+
+    if (OT_STORAGE_INDEX_DEPTH <= path.size()) { return false; }
+
+    for (const auto& it : ((*index).*list)()) {
+        const std::string child = path + it.itemid().back();
+
+        if (!LoadIndex(it.hash(), list, items, nodes, child)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<class T>
+bool Storage::StoreIndex(
+    std::unique_lock<std::mutex>& lock,
+    const Index& index,
+    IndexTree& tree,
+    proto::StorageItemHash* (T::*add)(),
+    T& output)
+{
+    // The root is rebuilt every time, and the caller stores it
+    if (!StoreIndexNode(index, tree, "", add, output)) { return false; }
+
+    lock.unlock();
+
+    return true;
+}
+
+template<class T>
+bool Storage::StoreIndexNode(
+    const Index& index,
+    IndexTree& tree,
+    const std::string& path,
+    proto::StorageItemHash* (T::*add)(),
+    T& output)
+{
+    uint64_t first = 0, last = 0;
+    index_range(path, first, last);
+    const auto begin = tree.keys_.lower_bound({first, ""});
+    std::size_t count = 0;
+
+    for (auto it = begin; (tree.keys_.end() != it) && (it->first < last);
+         ++it) {
+        if (OT_STORAGE_INDEX_LEAF_SIZE < ++count) { break; }
+    }
+
+    if ((OT_STORAGE_INDEX_LEAF_SIZE >= count) ||
+        (OT_STORAGE_INDEX_DEPTH == path.size())) {
+        output.set_version(1);
+
+        for (auto it = begin; (tree.keys_.end() != it) && (it->first < last);
+             ++it) {
+            const auto item = index.find(it->second);
+
+            if (index.end() == item) { continue; }
+            if (item->first.empty() || item->second.first.empty()) {
+                continue;
+            }
+
+            proto::StorageItemHash* entry = (output.*add)();
+            entry->set_version(1);
+            entry->set_itemid(item->first);
+            entry->set_hash(item->second.first);
+            entry->set_alias(item->second.second);
+        }
+
+        // Nothing below a leaf is part of the tree any more
+        erase_below(tree.nodes_, path);
+        erase_below(tree.dirty_, path);
+
+        return true;
+    }
+
+    output.set_version(OT_STORAGE_INDEX_NODE_VERSION);
+
+    for (const char digit : std::string("0123456789abcdef")) {
+        const std::string child = path + digit;
+        auto stored = tree.nodes_.find(child);
+        const bool dirty = (0 < tree.dirty_.count(child));
+
+        if (dirty || (tree.nodes_.end() == stored)) {
+            uint64_t childFirst = 0, childLast = 0;
+            index_range(child, childFirst, childLast);
+            const auto it = tree.keys_.lower_bound({childFirst, ""});
+
+            if ((tree.keys_.end() == it) || (it->first >= childLast)) {
+                // Empty subtrees are left out
+                if (tree.nodes_.end() != stored) { tree.nodes_.erase(stored); }
+                erase_below(tree.nodes_, child);
+                erase_below(tree.dirty_, child);
+                tree.dirty_.erase(child);
+
+                continue;
+            }
+
+            T node;
+            std::string hash;
+
+            if (!StoreIndexNode(index, tree, child, add, node)) {
+                return false;
+            }
+
+            if (!Verify(node)) { return false; }
+            if (!StoreProto(node, hash)) { return false; }
+
+            // Only forget the change once the node is safely stored
+            tree.nodes_[child] = hash;
+            tree.dirty_.erase(child);
+            stored = tree.nodes_.find(child);
+        }
+
+        proto::StorageItemHash* entry = (output.*add)();
+        entry->set_version(OT_STORAGE_INDEX_CHILD_VERSION);
+        entry->set_itemid(
+            std::string(OT_STORAGE_INDEX_CHILD_PREFIX) + digit);
+        entry->set_hash(stored->second);
+    }
+
+    return true;
+}
+
+template<class T>
+void Storage::StartTraversal(
+    const std::shared_ptr<StorageTraversal>& traversal,
+    const std::string& (proto::StorageItems::*index)() const,
+    const ItemHashList& (T::*list)() const,
+    const ItemVisitor& visitor)
+{
+    // Held until FinishTraversal(), so that collection can't start and
+    // empty the bucket which holds objects of the snapshot. A collection
+    // which is already running migrates all of them, since the snapshot is
+    // taken from an index at least as new as the one it started from.
+    ++traversals_;
+
+    if (shutdown_.load()) {
+        FinishTraversal(*traversal, false);
+
+        return;
+    }
+
+    if (!isLoaded_.load()) { Read(); }
+
+    bool snapshot = false;
+
+    {
+        std::lock_guard<std::mutex> gclock(gc_lock_);
+        std::string itemsHash;
+
+        {
+            std::lock_guard<std::mutex> writeLock(write_lock_);
+            itemsHash = items_;
+        }
+
+        std::shared_ptr<const proto::StorageItems> items;
+
+        if (itemsHash.empty()) {
+            snapshot = true;
+        } else if (LoadProto(itemsHash, items)) {
+            const std::string& hash = ((*items).*index)();
+            std::map<std::string, std::string> nodes;
+
+            snapshot = hash.empty() ||
+                       LoadIndex(hash, list, traversal->items_, nodes);
+        }
+    }
+
+    if (!snapshot) {
+        FinishTraversal(*traversal, false);
+
+        return;
+    }
+
+    const std::size_t workers =
+        std::min(pool_.Size(), traversal->items_.size());
+
+    if (0 == workers) {
+        FinishTraversal(*traversal, !traversal->cancel_.load());
+
+        return;
+    }
+
+    traversal->workers_.store(workers);
+
+    for (std::size_t i = 0; i < workers; ++i) {
+        pool_.Run([this, traversal, visitor]() -> void {
+            RunTraversal(traversal, visitor);
+        });
+    }
+}
+
 Storage::Storage(
     const StorageConfig& config,
     const Digest& hash,
     const Random& random)
         : gc_interval_(config.gc_interval_)
+        , cache_(config.cache_bytes_)
+        , pool_(
+              (0 < config.map_threads_)
+                  ? static_cast<std::size_t>(config.map_threads_)
+                  : 1)
         , config_(config)
         , digest_(hash)
         , random_(random)
@@ -83,7 +541,10 @@ void Storage::Init()
     current_bucket_.store(false);
     isLoaded_.store(false);
     gc_running_.store(false);
+    gc_migrating_.store(false);
     gc_resume_.store(false);
+    shutdown_.store(false);
+    traversals_.store(0);
 }
 
 Storage& Storage::It(
@@ -97,6 +558,8 @@ Storage& Storage::It(
         instance_pointer_ = new StorageFS(config, hash, random);
 #elif defined OT_STORAGE_SQLITE
         instance_pointer_ = new StorageSqlite3(config, hash, random);
+#elif defined OT_STORAGE_LMDB
+        instance_pointer_ = new StorageLMDB(config, hash, random);
 #endif
     }
 
@@ -105,6 +568,18 @@ Storage& Storage::It(
     return *instance_pointer_;
 }
 
+bool Storage::Load(
+    const std::string& key,
+    const bool bucket,
+    const RawReader& reader) const
+{
+    std::string value;
+
+    if (!Load(key, value, bucket)) { return false; }
+
+    return reader(value.data(), value.size());
+}
+
 void Storage::Read()
 {
     std::lock_guard<std::mutex> readLock(init_lock_);
@@ -116,7 +591,7 @@ void Storage::Read()
 
         if (root_hash_.empty()) { return; }
 
-        std::shared_ptr<proto::StorageRoot> root;
+        std::shared_ptr<const proto::StorageRoot> root;
 
         if (!LoadProto(root_hash_, root)) { return; }
 
@@ -126,12 +601,12 @@ void Storage::Read()
         gc_resume_.store(root->gc());
         old_gc_root_ = root->gcroot();
 
-        std::shared_ptr<proto::StorageItems> items;
+        std::shared_ptr<const proto::StorageItems> items;
 
         if (!LoadProto(items_, items)) { return; }
 
         if (!items->creds().empty()) {
-            std::shared_ptr<proto::StorageCredentials> creds;
+            std::shared_ptr<const proto::StorageCredentials> creds;
 
             if (!LoadProto(items->creds(), creds)) {
                 std::cerr << __FUNCTION__ << ": failed to load credential "
@@ -147,9 +622,13 @@ void Storage::Read()
         }
 
         if (!items->nyms().empty()) {
-            std::shared_ptr<proto::StorageNymList> nyms;
+            std::vector<proto::StorageItemHash> nyms;
 
-            if (!LoadProto(items->nyms(), nyms)) {
+            if (!LoadIndex(
+                items->nyms(),
+                &proto::StorageNymList::nym,
+                nyms,
+                nym_tree_.nodes_)) {
                 std::cerr << __FUNCTION__ << ": failed to load nym "
                 << "index item. Database is corrupt." << std::endl;
                 std::cerr << "Hash of bad object: (" << items->nyms()
@@ -157,13 +636,14 @@ void Storage::Read()
                 std::abort();
             }
 
-            for (auto& it : nyms->nym()) {
+            for (auto& it : nyms) {
                 nyms_.insert({it.itemid(), {it.hash(), it.alias()}});
+                nym_tree_.Add(it.itemid());
             }
         }
 
         if (!items->seeds().empty()) {
-            std::shared_ptr<proto::StorageSeeds> seeds;
+            std::shared_ptr<const proto::StorageSeeds> seeds;
 
             if (!LoadProto(items->seeds(), seeds)) {
                 std::cerr << __FUNCTION__ << ": failed to load seed "
@@ -181,9 +661,13 @@ void Storage::Read()
         }
 
         if (!items->servers().empty()) {
-            std::shared_ptr<proto::StorageServers> servers;
+            std::vector<proto::StorageItemHash> servers;
 
-            if (!LoadProto(items->servers(), servers)) {
+            if (!LoadIndex(
+                items->servers(),
+                &proto::StorageServers::server,
+                servers,
+                server_tree_.nodes_)) {
                 std::cerr << __FUNCTION__ << ": failed to load server "
                           << "index item. Database is corrupt." << std::endl;
                 std::cerr << "Hash of bad object: (" << items->servers()
@@ -191,15 +675,20 @@ void Storage::Read()
                 std::abort();
             }
 
-            for (auto& it : servers->server()) {
+            for (auto& it : servers) {
                 servers_.insert({it.itemid(), {it.hash(), it.alias()}});
+                server_tree_.Add(it.itemid());
             }
         }
 
         if (!items->units().empty()) {
-            std::shared_ptr<proto::StorageUnits> units;
+            std::vector<proto::StorageItemHash> units;
 
-            if (!LoadProto(items->units(), units)) {
+            if (!LoadIndex(
+                items->units(),
+                &proto::StorageUnits::unit,
+                units,
+                unit_tree_.nodes_)) {
                 std::cerr << __FUNCTION__ << ": failed to load unit "
                           << "index item. Database is corrupt." << std::endl;
                 std::cerr << "Hash of bad object: (" << items->units()
@@ -207,32 +696,109 @@ void Storage::Read()
                 std::abort();
             }
 
-            for (auto& it : units->unit()) {
+            for (auto& it : units) {
                 units_.insert({it.itemid(), {it.hash(), it.alias()}});
+                unit_tree_.Add(it.itemid());
             }
         }
     }
 }
 
-// Applies a lambda to all public nyms in the database in a detached thread.
-void Storage::MapPublicNyms(NymLambda& lambda)
+std::shared_ptr<StorageTraversal> Storage::MapPublicNyms(
+    NymLambda& lambda,
+    const TraversalCallback& done)
 {
-    std::thread bgMap(&Storage::RunMapPublicNyms, this, lambda);
-    bgMap.detach();
+    std::shared_ptr<StorageTraversal> traversal(new StorageTraversal(done));
+    // copy the lambda since original may destruct during execution
+    const NymLambda callback(lambda);
+    const ItemVisitor visitor =
+        [this, callback](const proto::StorageItemHash& item, std::mutex& lock)
+        -> bool {
+        std::shared_ptr<const proto::StorageNym> nymIndex;
+
+        if (!LoadProto(item.hash(), nymIndex)) { return false; }
+
+        std::shared_ptr<const proto::CredentialIndex> nym;
+
+        if (!LoadProto(nymIndex->credlist().hash(), nym)) { return false; }
+
+        std::lock_guard<std::mutex> lambdaLock(lock);
+        callback(*nym);
+
+        return true;
+    };
+
+    pool_.Run([this, traversal, visitor]() -> void {
+        StartTraversal(
+            traversal,
+            &proto::StorageItems::nyms,
+            &proto::StorageNymList::nym,
+            visitor);
+    });
+
+    return traversal;
 }
 
-// Applies a lambda to all server contracts in the database in a detached thread.
-void Storage::MapServers(ServerLambda& lambda)
+std::shared_ptr<StorageTraversal> Storage::MapServers(
+    ServerLambda& lambda,
+    const TraversalCallback& done)
 {
-    std::thread bgMap(&Storage::RunMapServers, this, lambda);
-    bgMap.detach();
+    std::shared_ptr<StorageTraversal> traversal(new StorageTraversal(done));
+    // copy the lambda since original may destruct during execution
+    const ServerLambda callback(lambda);
+    const ItemVisitor visitor =
+        [this, callback](const proto::StorageItemHash& item, std::mutex& lock)
+        -> bool {
+        std::shared_ptr<const proto::ServerContract> server;
+
+        if (!LoadProto(item.hash(), server)) { return false; }
+
+        std::lock_guard<std::mutex> lambdaLock(lock);
+        callback(*server);
+
+        return true;
+    };
+
+    pool_.Run([this, traversal, visitor]() -> void {
+        StartTraversal(
+            traversal,
+            &proto::StorageItems::servers,
+            &proto::StorageServers::server,
+            visitor);
+    });
+
+    return traversal;
 }
 
-// Applies a lambda to all unit definitions in the database in a detached thread.
-void Storage::MapUnitDefinitions(UnitLambda& lambda)
+std::shared_ptr<StorageTraversal> Storage::MapUnitDefinitions(
+    UnitLambda& lambda,
+    const TraversalCallback& done)
 {
-    std::thread bgMap(&Storage::RunMapUnits, this, lambda);
-    bgMap.detach();
+    std::shared_ptr<StorageTraversal> traversal(new StorageTraversal(done));
+    // copy the lambda since original may destruct during execution
+    const UnitLambda callback(lambda);
+    const ItemVisitor visitor =
+        [this, callback](const proto::StorageItemHash& item, std::mutex& lock)
+        -> bool {
+        std::shared_ptr<const proto::UnitDefinition> unit;
+
+        if (!LoadProto(item.hash(), unit)) { return false; }
+
+        std::lock_guard<std::mutex> lambdaLock(lock);
+        callback(*unit);
+
+        return true;
+    };
+
+    pool_.Run([this, traversal, visitor]() -> void {
+        StartTraversal(
+            traversal,
+            &proto::StorageItems::units,
+            &proto::StorageUnits::unit,
+            visitor);
+    });
+
+    return traversal;
 }
 
 bool Storage::RemoveItemFromBox(
@@ -269,6 +835,7 @@ bool Storage::RemoveNymBoxItem(
     if (!FindNym(nymID, false, nymHash)) { return false; }
 
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     return UpdateNymBox(box, nymHash, itemID);
 }
@@ -278,12 +845,15 @@ bool Storage::RemoveServer(const std::string& id)
     if (!isLoaded_.load()) { Read(); }
 
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // Block reads while modifying server map
     std::unique_lock<std::mutex> serverlock(server_lock_);
     auto deleted = servers_.erase(id);
 
     if (0 != deleted) {
+        server_tree_.Remove(id);
+
         return UpdateServers(serverlock);
     }
 
@@ -295,149 +865,239 @@ bool Storage::RemoveUnitDefinition(const std::string& id)
     if (!isLoaded_.load()) { Read(); }
 
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // Block reads while modifying unit map
     std::unique_lock<std::mutex> unitlock(unit_lock_);
     auto deleted = units_.erase(id);
 
     if (0 != deleted) {
+        unit_tree_.Remove(id);
+
         return UpdateUnits(unitlock);
     }
 
     return false;
 }
 
-void Storage::RunMapPublicNyms(NymLambda lambda)
+void Storage::RunTraversal(
+    const std::shared_ptr<StorageTraversal>& traversal,
+    const ItemVisitor& visitor)
 {
-    // std::unique_lock was failing to unlock the mutex even after Release()
-    // was called. For now, lock and unlock mutexes directly instead of using
-    // std::unique_lock and std::lock_guard
+    const std::size_t size = traversal->items_.size();
 
-    gc_lock_.lock(); // block gc while iterating
+    while (!traversal->cancel_.load() && !shutdown_.load()) {
+        const std::size_t position = traversal->next_++;
 
-    write_lock_.lock();
-    std::string index = items_;
-    write_lock_.unlock();
+        if (position >= size) { break; }
 
-    std::shared_ptr<proto::StorageItems> items;
-
-    if (!LoadProto(items_, items)) {
-        gc_lock_.unlock();
-        return;
+        if (!visitor(traversal->items_[position], traversal->lambda_lock_)) {
+            traversal->missed_.store(true);
+        }
     }
 
-    if (items->nyms().empty()) {
-        gc_lock_.unlock();
-        return;
+    // The last worker to finish reports the result
+    if (1 == traversal->workers_--) {
+        const bool complete = (traversal->next_.load() >= size) &&
+                              !traversal->missed_.load() &&
+                              !traversal->cancel_.load() &&
+                              !shutdown_.load();
+        FinishTraversal(*traversal, complete);
     }
+}
 
-    std::shared_ptr<proto::StorageNymList> nyms;
-
-    if (!LoadProto(items->nyms(), nyms)) {
-        gc_lock_.unlock();
-        return;
-    }
+bool Storage::Batching() const
+{
+    return (0 < write_batches_.count(std::this_thread::get_id()));
+}
 
-    for (auto& it : nyms->nym()) {
-        std::shared_ptr<proto::StorageNym> nymIndex;
+proto::StorageCredentials Storage::BuildCredentialIndex() const
+{
+    proto::StorageCredentials credIndex;
+    credIndex.set_version(1);
 
-        if (!LoadProto(it.hash(), nymIndex)) { continue; }
+    for (auto& cred : credentials_) {
+        if (!cred.first.empty() && !cred.second.first.empty()) {
+            proto::StorageItemHash* item = credIndex.add_cred();
+            item->set_version(1);
+            item->set_itemid(cred.first);
+            item->set_hash(cred.second.first);
+            item->set_alias(cred.second.second);
+        }
+    }
 
-        std::shared_ptr<proto::CredentialIndex> nym;
+    return credIndex;
+}
 
-        if (!LoadProto(nymIndex->credlist().hash(), nym))
-            { continue; }
+proto::StorageSeeds Storage::BuildSeedIndex() const
+{
+    proto::StorageSeeds seedIndex;
+    seedIndex.set_version(1);
+    seedIndex.set_defaultseed(default_seed_);
 
-        lambda(*nym);
+    for (auto& seed : seeds_) {
+        if (!seed.first.empty() && !seed.second.first.empty()) {
+            proto::StorageItemHash* item = seedIndex.add_seed();
+            item->set_version(1);
+            item->set_itemid(seed.first);
+            item->set_hash(seed.second.first);
+            item->set_alias(seed.second.second);
+        }
     }
 
-    gc_lock_.unlock();
+    return seedIndex;
 }
 
-void Storage::RunMapServers(ServerLambda lambda)
+bool Storage::UpdateIndexes()
 {
-    // std::unique_lock was failing to unlock the mutex even after Release()
-    // was called. For now, lock and unlock mutexes directly instead of using
-    // std::unique_lock and std::lock_guard
-
-    gc_lock_.lock(); // block gc while iterating
+    // The flags are only cleared by ClearPendingIndexes() once the root has
+    // been written and committed, so a failure leaves them set for a retry.
+    const bool pending = pending_creds_ || pending_nyms_ || pending_seeds_ ||
+        pending_servers_ || pending_units_;
 
-    write_lock_.lock();
-    std::string index = items_;
-    write_lock_.unlock();
+    if (!pending) { return true; }
 
+    // Reuse existing object, since not every index may have changed
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items)) {
-        gc_lock_.unlock();
-        return;
+    if (LoadProto(items_, existing, true)) {
+        items.reset(new proto::StorageItems(*existing));
+    } else {
+        items = std::make_shared<proto::StorageItems>();
+        items->set_version(1);
     }
 
-    if (items->servers().empty()) {
-        gc_lock_.unlock();
-        return;
-    }
+    std::string hash, plaintext;
 
-    std::shared_ptr<proto::StorageServers> servers;
+    if (pending_creds_) {
+        cred_lock_.lock();
+        proto::StorageCredentials credIndex = BuildCredentialIndex();
+        cred_lock_.unlock();
 
-    if (!LoadProto(items->servers(), servers)) {
-        gc_lock_.unlock();
-        return;
+        if (!proto::Check(credIndex, 0, 0xFFFFFFFF)) {
+            abort();
+        }
+
+        if (!StoreProto(credIndex, hash, plaintext)) { return false; }
+
+        items->set_creds(hash);
     }
 
-    for (auto& it : servers->server()) {
-        std::shared_ptr<proto::ServerContract> server;
+    if (pending_nyms_) {
+        std::unique_lock<std::mutex> nymLock(nym_lock_);
+        proto::StorageNymList nymIndex;
 
-        if (!LoadProto(it.hash(), server))
-            { continue; }
+        if (!StoreIndex(
+            nymLock,
+            nyms_,
+            nym_tree_,
+            &proto::StorageNymList::add_nym,
+            nymIndex)) {
+                return false;
+        }
 
-        lambda(*server);
+        if (!Verify(nymIndex)) { return false; }
+
+        if (!StoreProto(nymIndex, hash, plaintext)) { return false; }
+
+        items->set_nyms(hash);
     }
 
-    gc_lock_.unlock();
-}
+    if (pending_seeds_) {
+        std::unique_lock<std::mutex> seedLock(seed_lock_);
+        proto::StorageSeeds seedIndex = BuildSeedIndex();
+        seedLock.unlock();
 
-void Storage::RunMapUnits(UnitLambda lambda)
-{
-    // std::unique_lock was failing to unlock the mutex even after Release()
-    // was called. For now, lock and unlock mutexes directly instead of using
-    // std::unique_lock and std::lock_guard
+        if (!proto::Check(seedIndex, 0, 0xFFFFFFFF)) {
+            abort();
+        }
 
-    gc_lock_.lock(); // block gc while iterating
+        if (!StoreProto(seedIndex, hash, plaintext)) { return false; }
 
-    write_lock_.lock();
-    std::string index = items_;
-    write_lock_.unlock();
+        items->set_seeds(hash);
+    }
 
-    std::shared_ptr<proto::StorageItems> items;
+    if (pending_servers_) {
+        std::unique_lock<std::mutex> serverLock(server_lock_);
+        proto::StorageServers serverIndex;
 
-    if (!LoadProto(items_, items)) {
-        gc_lock_.unlock();
-        return;
+        if (!StoreIndex(
+            serverLock,
+            servers_,
+            server_tree_,
+            &proto::StorageServers::add_server,
+            serverIndex)) {
+                return false;
+        }
+
+        if (!Verify(serverIndex)) { return false; }
+
+        if (!StoreProto(serverIndex, hash, plaintext)) { return false; }
+
+        items->set_servers(hash);
     }
 
-    if (items->units().empty()) {
-        gc_lock_.unlock();
-        return;
+    if (pending_units_) {
+        std::unique_lock<std::mutex> unitLock(unit_lock_);
+        proto::StorageUnits unitIndex;
+
+        if (!StoreIndex(
+            unitLock,
+            units_,
+            unit_tree_,
+            &proto::StorageUnits::add_unit,
+            unitIndex)) {
+                return false;
+        }
+
+        if (!Verify(unitIndex)) { return false; }
+
+        if (!StoreProto(unitIndex, hash, plaintext)) { return false; }
+
+        items->set_units(hash);
     }
 
-    std::shared_ptr<proto::StorageUnits> units;
+    if (!proto::Check(*items, 0, 0xFFFFFFFF)) {
+        abort();
+    }
 
-    if (!LoadProto(items->units(), units)) {
-        gc_lock_.unlock();
-        return;
+    if (StoreProto(*items)) {
+        return UpdateRoot(*items);
     }
 
-    for (auto& it : units->unit()) {
-        std::shared_ptr<proto::UnitDefinition> unit;
+    return false;
+}
+
+bool Storage::FlushIndexes()
+{
+    const std::string items = items_;
+    const std::string root = root_hash_;
+    Batch batch(*this);
 
-        if (!LoadProto(it.hash(), unit))
-            { continue; }
+    if (UpdateIndexes() && batch.Commit()) {
+        ClearPendingIndexes();
 
-        lambda(*unit);
+        return true;
     }
 
-    gc_lock_.unlock();
+    // The backend may have rolled the new root back
+    items_ = items;
+    root_hash_ = root;
+    std::cout << __FUNCTION__ << ": Error: failed to write the pending "
+              << "indices. They will be written again by the next flush."
+              << std::endl;
+
+    return false;
+}
+
+void Storage::ClearPendingIndexes()
+{
+    pending_creds_ = false;
+    pending_nyms_ = false;
+    pending_seeds_ = false;
+    pending_servers_ = false;
+    pending_units_ = false;
 }
 
 bool Storage::UpdateNymCreds(
@@ -447,13 +1107,15 @@ bool Storage::UpdateNymCreds(
 {
     // Reuse existing object, since it may contain more than just creds
     if (!id.empty() && !hash.empty()) {
+        std::shared_ptr<const proto::StorageNym> existing;
         std::shared_ptr<proto::StorageNym> nym;
 
-        if (!LoadProto(id, nym, true)) {
+        if (!LoadProto(id, existing, true)) {
             nym = std::make_shared<proto::StorageNym>();
             nym->set_version(1);
             nym->set_nymid(id);
         } else {
+            nym.reset(new proto::StorageNym(*existing));
             nym->clear_credlist();
         }
 
@@ -482,17 +1144,15 @@ bool Storage::UpdateCredentials(const std::string& id, const std::string& hash)
         // Block reads while updating credential map
         cred_lock_.lock();
         credentials_[id].first = hash;
-        proto::StorageCredentials credIndex;
-        credIndex.set_version(1);
-        for (auto& cred : credentials_) {
-            if (!cred.first.empty() && !cred.second.first.empty()) {
-                proto::StorageItemHash* item = credIndex.add_cred();
-                item->set_version(1);
-                item->set_itemid(cred.first);
-                item->set_hash(cred.second.first);
-                item->set_alias(cred.second.second);
-            }
+
+        if (Batching()) {
+            cred_lock_.unlock();
+            pending_creds_ = true;
+
+            return true;
         }
+
+        proto::StorageCredentials credIndex = BuildCredentialIndex();
         cred_lock_.unlock();
 
         if (!proto::Check(credIndex, 0, 0xFFFFFFFF)) {
@@ -527,6 +1187,7 @@ bool Storage::UpdateNym(const proto::StorageNym& nym, const std::string& alias)
 
     nyms_[id].first = hash;
     nyms_[id].second = newAlias;
+    nym_tree_.Touch(id);
 
     return UpdateNyms(nymLock);
 }
@@ -538,6 +1199,7 @@ bool Storage::UpdateNymAlias(const std::string& id, const std::string& alias)
         // Block reads while updating nym map
         std::unique_lock<std::mutex> nymLock(nym_lock_);
         nyms_[id].second = alias;
+        nym_tree_.Touch(id);
 
         return UpdateNyms(nymLock);
     }
@@ -552,24 +1214,27 @@ bool Storage::UpdateNymBox(
 {
     if (nymHash.empty() || itemID.empty()) { return false; }
 
-    std::shared_ptr<proto::StorageNym> nym;
+    std::shared_ptr<const proto::StorageNym> existingNym;
+
+    if (!LoadNym(nymHash, existingNym)) { return false; }
 
-    if (!LoadNym(nymHash, nym)) { return false; }
+    std::shared_ptr<const proto::StorageNymList> existingBox;
 
-    std::shared_ptr<proto::StorageNymList> storageBox;
+    if (!LoadOrCreateBox(*existingNym, box, existingBox)) { return false; }
 
-    if (!LoadOrCreateBox(*nym, box, storageBox)) { return false; }
+    proto::StorageNym nym(*existingNym);
+    proto::StorageNymList storageBox(*existingBox);
 
-    if (!RemoveItemFromBox(itemID, *storageBox)) { return false; }
+    if (!RemoveItemFromBox(itemID, storageBox)) { return false; }
 
     std::string boxHash, plaintext;
 
-    if (!StoreProto(*storageBox, boxHash, plaintext)) { return false; }
+    if (!StoreProto(storageBox, boxHash, plaintext)) { return false; }
 
-    if (!UpdateNymBoxHash(box, boxHash, *nym)) { return false; }
+    if (!UpdateNymBoxHash(box, boxHash, nym)) { return false; }
 
-    if (StoreProto(*nym)) {
-        return UpdateNym(*nym, "");
+    if (StoreProto(nym)) {
+        return UpdateNym(nym, "");
     }
 
     return false;
@@ -583,24 +1248,27 @@ bool Storage::UpdateNymBox(
 {
     if (nymHash.empty() || itemID.empty() || hash.empty()) { return false; }
 
-    std::shared_ptr<proto::StorageNym> nym;
+    std::shared_ptr<const proto::StorageNym> existingNym;
 
-    if (!LoadNym(nymHash, nym)) { return false; }
+    if (!LoadNym(nymHash, existingNym)) { return false; }
 
-    std::shared_ptr<proto::StorageNymList> storageBox;
+    std::shared_ptr<const proto::StorageNymList> existingBox;
 
-    if (!LoadOrCreateBox(*nym, box, storageBox)) { return false; }
+    if (!LoadOrCreateBox(*existingNym, box, existingBox)) { return false; }
 
-    if (!AddItemToBox(itemID, hash, *storageBox)) { return false; }
+    proto::StorageNym nym(*existingNym);
+    proto::StorageNymList storageBox(*existingBox);
+
+    if (!AddItemToBox(itemID, hash, storageBox)) { return false; }
 
     std::string boxHash, plaintext;
 
-    if (!StoreProto(*storageBox, boxHash, plaintext)) { return false; }
+    if (!StoreProto(storageBox, boxHash, plaintext)) { return false; }
 
-    if (!UpdateNymBoxHash(box, boxHash, *nym)) { return false; }
+    if (!UpdateNymBoxHash(box, boxHash, nym)) { return false; }
 
-    if (StoreProto(*nym)) {
-        return UpdateNym(*nym, "");
+    if (StoreProto(nym)) {
+        return UpdateNym(nym, "");
     }
 
     return false;
@@ -678,23 +1346,26 @@ bool Storage::UpdateNymBoxHash(
 
 bool Storage::UpdateNyms(std::unique_lock<std::mutex>& nymLock)
 {
-    proto::StorageNymList nymIndex;
-    nymIndex.set_version(1);
-    for (auto& nym : nyms_) {
-        if (!nym.first.empty() && !nym.second.first.empty()) {
-            proto::StorageItemHash* item = nymIndex.add_nym();
-            item->set_version(1);
-            item->set_itemid(nym.first);
-            item->set_hash(nym.second.first);
-            item->set_alias(nym.second.second);
-        }
+    if (Batching()) {
+        nymLock.unlock();
+        pending_nyms_ = true;
+
+        return true;
     }
-    nymLock.unlock();
 
-    if (!proto::Check(nymIndex, 0, 0xFFFFFFFF)) {
-        abort();
+    proto::StorageNymList nymIndex;
+
+    if (!StoreIndex(
+        nymLock,
+        nyms_,
+        nym_tree_,
+        &proto::StorageNymList::add_nym,
+        nymIndex)) {
+            return false;
     }
 
+    if (!Verify(nymIndex)) { return false; }
+
     if (StoreProto(nymIndex)) {
         return UpdateItems(nymIndex);
     }
@@ -761,19 +1432,14 @@ bool Storage::UpdateSeedDefault(const std::string& id)
 
 bool Storage::UpdateSeeds(std::unique_lock<std::mutex>& seedlock)
 {
-    proto::StorageSeeds seedIndex;
-    seedIndex.set_version(1);
-    seedIndex.set_defaultseed(default_seed_);
+    if (Batching()) {
+        seedlock.unlock();
+        pending_seeds_ = true;
 
-    for (auto& seed : seeds_) {
-        if (!seed.first.empty() && !seed.second.first.empty()) {
-            proto::StorageItemHash* item = seedIndex.add_seed();
-            item->set_version(1);
-            item->set_itemid(seed.first);
-            item->set_hash(seed.second.first);
-            item->set_alias(seed.second.second);
-        }
+        return true;
     }
+
+    proto::StorageSeeds seedIndex = BuildSeedIndex();
     seedlock.unlock();
 
     if (!proto::Check(seedIndex, 0, 0xFFFFFFFF)) {
@@ -805,6 +1471,7 @@ bool Storage::UpdateServer(
 
         servers_[id].first = hash;
         servers_[id].second = newAlias;
+        server_tree_.Touch(id);
 
         return UpdateServers(serverlock);
     }
@@ -820,6 +1487,7 @@ bool Storage::UpdateServerAlias(const std::string& id, const std::string& alias)
         // Block reads while updating server map
         std::unique_lock<std::mutex> serverlock(server_lock_);
         servers_[id].second = alias;
+        server_tree_.Touch(id);
 
         return UpdateServers(serverlock);
     }
@@ -829,23 +1497,26 @@ bool Storage::UpdateServerAlias(const std::string& id, const std::string& alias)
 
 bool Storage::UpdateServers(std::unique_lock<std::mutex>& serverlock)
 {
-    proto::StorageServers serverIndex;
-    serverIndex.set_version(1);
-    for (auto& server : servers_) {
-        if (!server.first.empty() && !server.second.first.empty()) {
-            proto::StorageItemHash* item = serverIndex.add_server();
-            item->set_version(1);
-            item->set_itemid(server.first);
-            item->set_hash(server.second.first);
-            item->set_alias(server.second.second);
-        }
+    if (Batching()) {
+        serverlock.unlock();
+        pending_servers_ = true;
+
+        return true;
     }
-    serverlock.unlock();
 
-    if (!proto::Check(serverIndex, 0, 0xFFFFFFFF)) {
-        abort();
+    proto::StorageServers serverIndex;
+
+    if (!StoreIndex(
+        serverlock,
+        servers_,
+        server_tree_,
+        &proto::StorageServers::add_server,
+        serverIndex)) {
+            return false;
     }
 
+    if (!Verify(serverIndex)) { return false; }
+
     if (StoreProto(serverIndex)) {
         return UpdateItems(serverIndex);
     }
@@ -872,6 +1543,7 @@ bool Storage::UpdateUnit(
 
         units_[id].first = hash;
         units_[id].second = newAlias;
+        unit_tree_.Touch(id);
 
         return UpdateUnits(unitlock);
     }
@@ -886,6 +1558,7 @@ bool Storage::UpdateUnitAlias(const std::string& id, const std::string& alias)
         // Block reads while updating unit map
         std::unique_lock<std::mutex> unitlock(unit_lock_);
         units_[id].second = alias;
+        unit_tree_.Touch(id);
 
         return UpdateUnits(unitlock);
     }
@@ -895,23 +1568,26 @@ bool Storage::UpdateUnitAlias(const std::string& id, const std::string& alias)
 
 bool Storage::UpdateUnits(std::unique_lock<std::mutex>& unitlock)
 {
-    proto::StorageUnits unitIndex;
-    unitIndex.set_version(1);
-    for (auto& unit : units_) {
-        if (!unit.first.empty() && !unit.second.first.empty()) {
-            proto::StorageItemHash* item = unitIndex.add_unit();
-            item->set_version(1);
-            item->set_itemid(unit.first);
-            item->set_hash(unit.second.first);
-            item->set_alias(unit.second.second);
-        }
+    if (Batching()) {
+        unitlock.unlock();
+        pending_units_ = true;
+
+        return true;
     }
-    unitlock.unlock();
 
-    if (!proto::Check(unitIndex, 0, 0xFFFFFFFF)) {
-        abort();
+    proto::StorageUnits unitIndex;
+
+    if (!StoreIndex(
+        unitlock,
+        units_,
+        unit_tree_,
+        &proto::StorageUnits::add_unit,
+        unitIndex)) {
+            return false;
     }
 
+    if (!Verify(unitIndex)) { return false; }
+
     if (StoreProto(unitIndex)) {
         return UpdateItems(unitIndex);
     }
@@ -923,12 +1599,14 @@ bool Storage::UpdateUnits(std::unique_lock<std::mutex>& unitlock)
 bool Storage::UpdateItems(const proto::StorageCredentials& creds)
 {
     // Reuse existing object, since it may contain more than just creds
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items, true)) {
+    if (!LoadProto(items_, existing, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
     } else {
+        items.reset(new proto::StorageItems(*existing));
         items->clear_creds();
     }
 
@@ -955,12 +1633,14 @@ bool Storage::UpdateItems(const proto::StorageCredentials& creds)
 bool Storage::UpdateItems(const proto::StorageNymList& nyms)
 {
     // Reuse existing object, since it may contain more than just nyms
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items, true)) {
+    if (!LoadProto(items_, existing, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
     } else {
+        items.reset(new proto::StorageItems(*existing));
         items->clear_nyms();
     }
 
@@ -987,12 +1667,14 @@ bool Storage::UpdateItems(const proto::StorageNymList& nyms)
 bool Storage::UpdateItems(const proto::StorageSeeds& seeds)
 {
     // Reuse existing object, since it may contain more than just seeds
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items, true)) {
+    if (!LoadProto(items_, existing, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
     } else {
+        items.reset(new proto::StorageItems(*existing));
         items->clear_seeds();
     }
 
@@ -1018,12 +1700,14 @@ bool Storage::UpdateItems(const proto::StorageSeeds& seeds)
 bool Storage::UpdateItems(const proto::StorageServers& servers)
 {
     // Reuse existing object, since it may contain more than just servers
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items, true)) {
+    if (!LoadProto(items_, existing, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
     } else {
+        items.reset(new proto::StorageItems(*existing));
         items->clear_servers();
     }
 
@@ -1050,12 +1734,14 @@ bool Storage::UpdateItems(const proto::StorageServers& servers)
 bool Storage::UpdateItems(const proto::StorageUnits& units)
 {
     // Reuse existing object, since it may contain more than just units
+    std::shared_ptr<const proto::StorageItems> existing;
     std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(items_, items, true)) {
+    if (!LoadProto(items_, existing, true)) {
         items = std::make_shared<proto::StorageItems>();
         items->set_version(1);
     } else {
+        items.reset(new proto::StorageItems(*existing));
         items->clear_units();
     }
 
@@ -1082,15 +1768,17 @@ bool Storage::UpdateItems(const proto::StorageUnits& units)
 bool Storage::UpdateRoot(const proto::StorageItems& items)
 {
     // Reuse existing object to preserve current settings
+    std::shared_ptr<const proto::StorageRoot> existing;
     std::shared_ptr<proto::StorageRoot> root;
 
-    if (!LoadProto(root_hash_, root, true)) {
+    if (!LoadProto(root_hash_, existing, true)) {
         root = std::make_shared<proto::StorageRoot>();
         root->set_version(1);
         root->set_altlocation(false);
         std::time_t time = std::time(nullptr);
         root->set_lastgc(static_cast<int64_t>(time));
     } else {
+        root.reset(new proto::StorageRoot(*existing));
         root->clear_items();
     }
 
@@ -1158,24 +1846,25 @@ bool Storage::UpdateRoot(
 // this version is for ending garbage collection only
 bool Storage::UpdateRoot()
 {
-    std::shared_ptr<proto::StorageRoot> root;
+    std::shared_ptr<const proto::StorageRoot> existing;
 
-    bool loaded = LoadProto(root_hash_, root);
+    bool loaded = LoadProto(root_hash_, existing);
 
     assert(loaded);
 
     if (loaded && digest_) {
-        gc_running_.store(false);
-        root->set_gc(false);
+        gc_migrating_.store(false);
+        proto::StorageRoot root(*existing);
+        root.set_gc(false);
 
-        if (!proto::Check(*root, 0, 0xFFFFFFFF)) {
+        if (!proto::Check(root, 0, 0xFFFFFFFF)) {
             abort();
         }
 
-        if (StoreProto(*root)) {
+        if (StoreProto(root)) {
             std::string hash;
             std::string plaintext =
-                proto::ProtoAsString<proto::StorageRoot>(*root);
+                proto::ProtoAsString<proto::StorageRoot>(root);
             digest_(Storage::HASH_TYPE, plaintext, hash);
 
             root_hash_ = hash;
@@ -1221,6 +1910,17 @@ bool Storage::ValidateRequestBox(const StorageBox& type) const
     return false;
 }
 
+void Storage::FinishTraversal(
+    StorageTraversal& traversal,
+    const bool success)
+{
+    traversal.items_.clear();
+    --traversals_;
+    traversal.promise_.set_value(success);
+
+    if (traversal.done_) { traversal.done_(success); }
+}
+
 ObjectList Storage::NymBoxList(const std::string& nymID, const StorageBox box)
 {
     if (!isLoaded_.load()) { Read(); }
@@ -1232,10 +1932,10 @@ ObjectList Storage::NymBoxList(const std::string& nymID, const StorageBox box)
     gc_lock_.lock(); // block gc while iterating
 
     if (FindNym(nymID, false, nymHash)) {
-        std::shared_ptr<proto::StorageNym> nym;
+        std::shared_ptr<const proto::StorageNym> nym;
 
         if (LoadNym(nymHash, nym)) {
-            std::shared_ptr<proto::StorageNymList> storageBox;
+            std::shared_ptr<const proto::StorageNymList> storageBox;
 
             if (LoadOrCreateBox(*nym, box, storageBox)) {
                 for (const auto& item : storageBox->nym()) {
@@ -1250,6 +1950,13 @@ ObjectList Storage::NymBoxList(const std::string& nymID, const StorageBox box)
     return items;
 }
 
+StorageGCMetrics Storage::GCMetrics() const
+{
+    std::lock_guard<std::mutex> metricsLock(gc_metrics_lock_);
+
+    return gc_metrics_;
+}
+
 std::string Storage::DefaultSeed()
 {
     if (!isLoaded_.load()) { Read(); }
@@ -1262,7 +1969,7 @@ std::string Storage::DefaultSeed()
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::Credential>& cred,
+    std::shared_ptr<const proto::Credential>& cred,
     const bool checking)
 {
     if (!isLoaded_.load()) { Read(); }
@@ -1295,7 +2002,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::CredentialIndex>& nym,
+    std::shared_ptr<const proto::CredentialIndex>& nym,
     const bool checking)
 {
     std::string notUsed;
@@ -1305,7 +2012,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::CredentialIndex>& nym,
+    std::shared_ptr<const proto::CredentialIndex>& nym,
     std::string& alias,
     const bool checking)
 {
@@ -1315,7 +2022,7 @@ bool Storage::Load(
 
     if (!FindNym(id, checking, nymHash, alias)) { return false; }
 
-    std::shared_ptr<proto::StorageNym> nymIndex;
+    std::shared_ptr<const proto::StorageNym> nymIndex;
 
     if (!LoadNym(nymHash, nymIndex)) { return false; }
 
@@ -1326,7 +2033,7 @@ bool Storage::Load(
     const std::string& nymID,
     const std::string& id,
     const StorageBox box,
-    std::shared_ptr<proto::PeerReply>& reply,
+    std::shared_ptr<const proto::PeerReply>& reply,
     const bool checking)
 {
     if (!isLoaded_.load()) { Read(); }
@@ -1335,7 +2042,7 @@ bool Storage::Load(
 
     if (!FindNym(nymID, checking, nymHash)) { return false; }
 
-    std::shared_ptr<proto::StorageNym> nymIndex;
+    std::shared_ptr<const proto::StorageNym> nymIndex;
 
     if (!LoadNym(nymHash, nymIndex)) { return false; }
 
@@ -1343,7 +2050,7 @@ bool Storage::Load(
 
     if (!FindReplyBox(box, checking, *nymIndex, boxHash)) { return false; }
 
-    std::shared_ptr<proto::StorageNymList> storageBox;
+    std::shared_ptr<const proto::StorageNymList> storageBox;
 
     if (!LoadNymIndex(boxHash, storageBox)) { return false; }
 
@@ -1354,7 +2061,7 @@ bool Storage::Load(
     const std::string& nymID,
     const std::string& id,
     const StorageBox box,
-    std::shared_ptr<proto::PeerRequest>& request,
+    std::shared_ptr<const proto::PeerRequest>& request,
     const bool checking)
 {
     if (!isLoaded_.load()) { Read(); }
@@ -1363,7 +2070,7 @@ bool Storage::Load(
 
     if (!FindNym(nymID, checking, nymHash)) { return false; }
 
-    std::shared_ptr<proto::StorageNym> nymIndex;
+    std::shared_ptr<const proto::StorageNym> nymIndex;
 
     if (!LoadNym(nymHash, nymIndex)) { return false; }
 
@@ -1371,7 +2078,7 @@ bool Storage::Load(
 
     if (!FindRequestBox(box, checking, *nymIndex, boxHash)) { return false; }
 
-    std::shared_ptr<proto::StorageNymList> storageBox;
+    std::shared_ptr<const proto::StorageNymList> storageBox;
 
     if (!LoadNymIndex(boxHash, storageBox)) { return false; }
 
@@ -1380,7 +2087,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::Seed>& seed,
+    std::shared_ptr<const proto::Seed>& seed,
     const bool checking)
 {
     std::string notUsed;
@@ -1390,7 +2097,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::Seed>& seed,
+    std::shared_ptr<const proto::Seed>& seed,
     std::string& alias,
     const bool checking)
 {
@@ -1425,7 +2132,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::ServerContract>& contract,
+    std::shared_ptr<const proto::ServerContract>& contract,
     const bool checking)
 {
     std::string notUsed;
@@ -1435,7 +2142,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::ServerContract>& contract,
+    std::shared_ptr<const proto::ServerContract>& contract,
     std::string& alias,
     const bool checking)
 {
@@ -1469,7 +2176,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::UnitDefinition>& contract,
+    std::shared_ptr<const proto::UnitDefinition>& contract,
     const bool checking)
 {
     std::string notUsed;
@@ -1479,7 +2186,7 @@ bool Storage::Load(
 
 bool Storage::Load(
     const std::string& id,
-    std::shared_ptr<proto::UnitDefinition>& contract,
+    std::shared_ptr<const proto::UnitDefinition>& contract,
     std::string& alias,
     const bool checking)
 {
@@ -1511,12 +2218,40 @@ bool Storage::Load(
     return false;
 }
 
+void Storage::StartWriteBatch()
+{
+    if (!isLoaded_.load()) { Read(); }
+
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+    ++write_batches_[std::this_thread::get_id()];
+}
+
+bool Storage::FinishWriteBatch()
+{
+    std::lock_guard<std::mutex> writeLock(write_lock_);
+    auto it = write_batches_.find(std::this_thread::get_id());
+
+    if (write_batches_.end() == it) {
+        std::cout << __FUNCTION__ << ": Error: no write batch is open."
+                  << std::endl;
+
+        return false;
+    }
+
+    if (0 < --(it->second)) { return true; }
+
+    write_batches_.erase(it);
+
+    return FlushIndexes();
+}
+
 bool Storage::SetDefaultSeed(const std::string& id)
 {
     if (!isLoaded_.load()) { Read(); }
 
     // block writes while searching seed map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // do not set the default seed to an id that's not present in the map
     bool found = (seeds_.find(id) != seeds_.end());
@@ -1535,6 +2270,7 @@ bool Storage::SetNymAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching nym map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (nyms_.find(id) != nyms_.end());
 
@@ -1552,6 +2288,7 @@ bool Storage::SetSeedAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching seed map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (seeds_.find(id) != seeds_.end());
 
@@ -1569,6 +2306,7 @@ bool Storage::SetServerAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching server map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (servers_.find(id) != servers_.end());
 
@@ -1588,6 +2326,7 @@ bool Storage::SetUnitDefinitionAlias(
 
     // block writes while searching server map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (units_.find(id) != units_.end());
 
@@ -1633,7 +2372,7 @@ bool Storage::Store(const proto::Credential& data)
 
     // Avoid overwriting private credentials with public credentials
     bool existingPrivate = false;
-    std::shared_ptr<proto::Credential> existing;
+    std::shared_ptr<const proto::Credential> existing;
     const std::string& id = data.id();
 
     if (Load(id, existing, true)) { // suppress "not found" error
@@ -1649,6 +2388,7 @@ bool Storage::Store(const proto::Credential& data)
 
     std::string key;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
 
@@ -1666,7 +2406,7 @@ bool Storage::Store(const proto::CredentialIndex& data, const std::string alias)
     // overwriting an private nym with a public one.
     bool haveNewerVerion = false;
     bool existingPrivate = false;
-    std::shared_ptr<proto::CredentialIndex> existing;
+    std::shared_ptr<const proto::CredentialIndex> existing;
     const std::string& id = data.nymid();
 
     if (Load(id, existing, true)) { // suppress "not found" error
@@ -1692,6 +2432,7 @@ bool Storage::Store(const proto::CredentialIndex& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_nyms_ && config_.dht_callback_) {
@@ -1721,6 +2462,7 @@ bool Storage::Store(
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         return UpdateNymBox(box, nymHash, data.id(), key);
@@ -1746,6 +2488,7 @@ bool Storage::Store(
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         return UpdateNymBox(box, nymHash, data.id(), key);
@@ -1761,6 +2504,7 @@ bool Storage::Store(const proto::Seed& data, const std::string alias)
 
     std::string key;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
 
@@ -1782,6 +2526,7 @@ bool Storage::Store(const proto::ServerContract& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_servers_ && config_.dht_callback_) {
@@ -1806,6 +2551,7 @@ bool Storage::Store(const proto::UnitDefinition& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
         if (config_.auto_publish_units_ && config_.dht_callback_) {
@@ -1872,15 +2618,45 @@ bool Storage::AddItemToBox(
 
 void Storage::CollectGarbage()
 {
+    const bool resuming = gc_resume_.load();
     bool oldLocation = current_bucket_.load();
-    current_bucket_.store(!(current_bucket_.load()));
 
-    std::shared_ptr<proto::StorageRoot> root;
+    // An interrupted collection had already switched buckets, and Read()
+    // restored the new bucket from the root, so only switch for a new one.
+    if (resuming) {
+        oldLocation = !oldLocation;
+    } else {
+        std::lock_guard<SharedMutex> bucketLock(bucket_lock_);
+        current_bucket_.store(!(current_bucket_.load()));
+    }
+
+    gc_resumed_ = resuming;
+    gc_slice_ = 0;
+
+    // Objects stored by an open write batch are not reachable from the root
+    // until their indices are written, so write them now or those objects
+    // would be left behind in the old bucket.
+    // A flush which failed earlier leaves its indices pending as well. If
+    // they can't be written, stop before anything is migrated, so that the
+    // old bucket is kept.
+    auto pauseStart = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> batchLock(write_lock_);
+    const bool flushed = FlushIndexes();
+    batchLock.unlock();
+    RecordGCPause(pauseStart);
+
+    if (!flushed) {
+        gc_running_.store(false);
+        return;
+    }
+
+    std::shared_ptr<const proto::StorageRoot> root;
     std::string gcroot, gcitems;
     bool updated = false;
 
-    if (!gc_resume_.load()) {
+    if (!resuming) {
         // Do not allow changes to root index object until we've updated it.
+        pauseStart = std::chrono::steady_clock::now();
         std::unique_lock<std::mutex> writeLock(write_lock_);
         gcroot = root_hash_;
 
@@ -1890,8 +2666,10 @@ void Storage::CollectGarbage()
             return;
         }
         gcitems = root->items();
-        updated = UpdateRoot(*root, gcroot);
+        proto::StorageRoot gcRoot(*root);
+        updated = UpdateRoot(gcRoot, gcroot);
         writeLock.unlock();
+        RecordGCPause(pauseStart);
     } else {
         gcroot = old_gc_root_;
 
@@ -1909,7 +2687,7 @@ void Storage::CollectGarbage()
         return;
     }
     MigrateKey(gcitems);
-    std::shared_ptr<proto::StorageItems> items;
+    std::shared_ptr<const proto::StorageItems> items;
 
     if (!LoadProto(gcitems, items)) {
         gc_running_.store(false);
@@ -1918,7 +2696,7 @@ void Storage::CollectGarbage()
 
     if (!items->creds().empty()) {
         MigrateKey(items->creds());
-        std::shared_ptr<proto::StorageCredentials> creds;
+        std::shared_ptr<const proto::StorageCredentials> creds;
 
         if (!LoadProto(items->creds(), creds)) {
             gc_running_.store(false);
@@ -1932,16 +2710,22 @@ void Storage::CollectGarbage()
 
     if (!items->nyms().empty()) {
         MigrateKey(items->nyms());
-        std::shared_ptr<proto::StorageNymList> nyms;
+        std::vector<proto::StorageItemHash> nyms;
+        std::map<std::string, std::string> nodes;
 
-        if (!LoadProto(items->nyms(), nyms)) {
+        if (!LoadIndex(
+            items->nyms(), &proto::StorageNymList::nym, nyms, nodes)) {
             gc_running_.store(false);
             return;
         }
 
-        for (auto& it : nyms->nym()) {
+        for (auto& node : nodes) {
+            MigrateKey(node.second);
+        }
+
+        for (auto& it : nyms) {
             MigrateKey(it.hash());
-            std::shared_ptr<proto::StorageNym> nym;
+            std::shared_ptr<const proto::StorageNym> nym;
 
             if (!LoadProto(it.hash(), nym)) {
                 gc_running_.store(false);
@@ -1980,7 +2764,7 @@ void Storage::CollectGarbage()
 
     if (!items->seeds().empty()) {
         MigrateKey(items->seeds());
-        std::shared_ptr<proto::StorageSeeds> seeds;
+        std::shared_ptr<const proto::StorageSeeds> seeds;
 
         if (!LoadProto(items->seeds(), seeds)) {
             gc_running_.store(false);
@@ -1994,40 +2778,65 @@ void Storage::CollectGarbage()
 
     if (!items->servers().empty()) {
         MigrateKey(items->servers());
-        std::shared_ptr<proto::StorageServers> servers;
-
-        if (!LoadProto(items->servers(), servers)) {
+        std::vector<proto::StorageItemHash> servers;
+        std::map<std::string, std::string> nodes;
+
+        if (!LoadIndex(
+            items->servers(),
+            &proto::StorageServers::server,
+            servers,
+            nodes)) {
             gc_running_.store(false);
             return;
         }
 
-        for (auto& it : servers->server()) {
+        for (auto& node : nodes) {
+            MigrateKey(node.second);
+        }
+
+        for (auto& it : servers) {
             MigrateKey(it.hash());
         }
     }
 
     if (!items->units().empty()) {
         MigrateKey(items->units());
-        std::shared_ptr<proto::StorageUnits> units;
+        std::vector<proto::StorageItemHash> units;
+        std::map<std::string, std::string> nodes;
 
-        if (!LoadProto(items->units(), units)) {
+        if (!LoadIndex(
+            items->units(), &proto::StorageUnits::unit, units, nodes)) {
             gc_running_.store(false);
             return;
         }
 
-        for (auto& it : units->unit()) {
+        for (auto& node : nodes) {
+            MigrateKey(node.second);
+        }
+
+        for (auto& it : units) {
             MigrateKey(it.hash());
         }
     }
 
+    pauseStart = std::chrono::steady_clock::now();
     std::unique_lock<std::mutex> writeLock(write_lock_);
     UpdateRoot();
     writeLock.unlock();
+    RecordGCPause(pauseStart);
 
-    std::unique_lock<std::mutex> bucketLock(bucket_lock_);
+    // Every reachable object is in the active bucket by now. Once
+    // gc_migrating_ is clear LoadProto tries that bucket first, so readers
+    // do not need to be blocked while the old bucket is emptied. gc_running_
+    // stays set until then, so that another collection can not start.
+    gc_migrating_.store(false);
     EmptyBucket(oldLocation);
-    bucketLock.unlock();
 
+    std::unique_lock<std::mutex> metricsLock(gc_metrics_lock_);
+    ++gc_metrics_.runs_;
+    metricsLock.unlock();
+
+    gc_resumed_ = false;
     gc_running_.store(false);
 }
 
@@ -2164,14 +2973,15 @@ bool Storage::FindReplyBox(
 
 bool Storage::LoadCredentialIndex(
     const std::string& hash,
-    std::shared_ptr<proto::CredentialIndex>& nym)
+    std::shared_ptr<const proto::CredentialIndex>& nym)
 {
     const bool output = LoadProto<proto::CredentialIndex>(hash, nym, false);
 
+    // A batch which failed to commit can leave its hashes in the indices, so
+    // report the miss instead of aborting.
     if (!output) {
         std::cout << __FUNCTION__ << ": Error: can not load public nym with "
-                  << "hash " << hash << ". Database is corrupt." << std::endl;
-        abort();
+                  << "hash " << hash << "." << std::endl;
     }
 
     return output;
@@ -2179,15 +2989,13 @@ bool Storage::LoadCredentialIndex(
 
 bool Storage::LoadNym(
     const std::string& hash,
-    std::shared_ptr<proto::StorageNym>& nym)
+    std::shared_ptr<const proto::StorageNym>& nym)
 {
     const bool loaded = LoadProto(hash, nym, false);
 
     if (!loaded) {
         std::cout << __FUNCTION__ << ": Error: can not load index object "
-                  << "for nym with hash " << hash << ". Database is corrupt."
-                  << std::endl;
-        abort();
+                  << "for nym with hash " << hash << "." << std::endl;
 
         return false;
     }
@@ -2197,7 +3005,7 @@ bool Storage::LoadNym(
 
 bool Storage::LoadNymIndex(
     const std::string& hash,
-    std::shared_ptr<proto::StorageNymList>& index)
+    std::shared_ptr<const proto::StorageNymList>& index)
 {
     const bool output = LoadProto(hash, index, false);
 
@@ -2216,7 +3024,7 @@ bool Storage::LoadNymIndex(
 bool Storage::LoadOrCreateBox(
     const proto::StorageNym& nym,
     const StorageBox& type,
-    std::shared_ptr<proto::StorageNymList>& box)
+    std::shared_ptr<const proto::StorageNymList>& box)
 {
     std::string boxHash;
 
@@ -2228,11 +3036,13 @@ bool Storage::LoadOrCreateBox(
 
         return LoadProto(boxHash, box, false);
     } else {
-        box.reset(new proto::StorageNymList);
+        std::shared_ptr<proto::StorageNymList> created(
+            new proto::StorageNymList);
 
-        if (!box) { return false; }
+        if (!created) { return false; }
 
-        box->set_version(1);
+        created->set_version(1);
+        box = created;
     }
 
     return true;
@@ -2242,7 +3052,7 @@ bool Storage::LoadPeerReply(
     const std::string& id,
     const bool checking,
     const proto::StorageNymList& box,
-    std::shared_ptr<proto::PeerReply>& reply)
+    std::shared_ptr<const proto::PeerReply>& reply)
 {
     for (const auto& item : box.nym()) {
         if (id == item.itemid()) {
@@ -2262,7 +3072,7 @@ bool Storage::LoadPeerRequest(
     const std::string& id,
     const bool checking,
     const proto::StorageNymList& box,
-    std::shared_ptr<proto::PeerRequest>& request)
+    std::shared_ptr<const proto::PeerRequest>& request)
 {
     for (const auto& item : box.nym()) {
         if (id == item.itemid()) {
@@ -2280,7 +3090,7 @@ bool Storage::LoadPeerRequest(
 
 bool Storage::MigrateBox(const proto::StorageItemHash& box)
 {
-    std::shared_ptr<proto::StorageNymList> itemList;
+    std::shared_ptr<const proto::StorageNymList> itemList;
 
     if (!LoadProto(box.hash(), itemList)) {
 
@@ -2298,21 +3108,53 @@ bool Storage::MigrateBox(const proto::StorageItemHash& box)
 bool Storage::MigrateKey(const std::string& key)
 {
     std::string value;
+    const bool active = current_bucket_.load();
+
+    // A resumed collection skips the objects its previous run already moved
+    if (gc_resumed_ && Load(key, value, active)) { return true; }
 
     // try to load the key from the inactive bucket
-    if (Load(key, value, !(current_bucket_.load()))) {
+    if (Load(key, value, !active)) {
 
         // save to the active bucket
-        if (Store(key, value, current_bucket_.load())) {
-            return true;
-        } else {
-            return false;
+        if (!Store(key, value, active)) { return false; }
+
+        std::unique_lock<std::mutex> metricsLock(gc_metrics_lock_);
+        ++gc_metrics_.keys_migrated_;
+        gc_metrics_.bytes_migrated_ += value.size();
+        metricsLock.unlock();
+
+        // Yield the database to other users between slices
+        const bool sliced = (0 < config_.gc_slice_keys_);
+
+        if (sliced && (++gc_slice_ >= config_.gc_slice_keys_)) {
+            gc_slice_ = 0;
+
+            if (0 < config_.gc_slice_pause_) {
+                std::this_thread::sleep_for(
+                    std::chrono::milliseconds(config_.gc_slice_pause_));
+            }
         }
     }
 
     return true; // the key must have already been in the active bucket
 }
 
+void Storage::RecordGCPause(const std::chrono::steady_clock::time_point& start)
+{
+    const uint64_t pause = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    std::lock_guard<std::mutex> metricsLock(gc_metrics_lock_);
+    gc_metrics_.last_pause_ = pause;
+    gc_metrics_.total_pause_ += pause;
+
+    if (pause > gc_metrics_.longest_pause_) {
+        gc_metrics_.longest_pause_ = pause;
+    }
+}
+
 void Storage::RunGC()
 {
     if (!isLoaded_.load()) { return; }
@@ -2322,15 +3164,27 @@ void Storage::RunGC()
     const bool intervalExceeded =
         ((time - last_gc_) > gc_interval_);
 
+    // Collection waits for open write batches and traversals to finish
+    std::unique_lock<std::mutex> writeLock(write_lock_);
+    const bool batching = !write_batches_.empty();
+    writeLock.unlock();
+
+    if (batching || (0 < traversals_.load())) { return; }
+
     if (!gc_running_.load() && ( gc_resume_.load() || intervalExceeded)) {
         assert (!gc_running_.load());
         gc_running_.store(true);
+        gc_migrating_.store(true);
         gc_thread_ = new std::thread(&Storage::CollectGarbage, this);
     }
 }
 
 void Storage::Storage::Cleanup_Storage()
 {
+    // Traversals which are still running skip their remaining objects
+    shutdown_.store(true);
+    pool_.Stop();
+
     if ((nullptr != gc_thread_) && gc_thread_->joinable()) {
         gc_thread_->join();
         delete gc_thread_;
@@ -0,0 +1,114 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/storage/StorageCache.hpp"
+
+#include <functional>
+
+namespace opentxs
+{
+StorageCache::StorageCache(const std::size_t bytes)
+    : shard_limit_(bytes / STORAGE_CACHE_SHARDS)
+{
+    hits_.store(0);
+    misses_.store(0);
+
+    for (int i = 0; i < STORAGE_CACHE_SHARDS; ++i) {
+        shards_.emplace_back(new Shard);
+    }
+}
+
+StorageCache::Object StorageCache::Get(const std::string& hash)
+{
+    Shard& shard = GetShard(hash);
+    std::unique_lock<std::mutex> shardLock(shard.lock_);
+    auto it = shard.index_.find(hash);
+
+    if (shard.index_.end() == it) {
+        shardLock.unlock();
+        ++misses_;
+
+        return nullptr;
+    }
+
+    // Move the entry to the front of the list
+    shard.entries_.splice(
+        shard.entries_.begin(), shard.entries_, it->second);
+    Object output = it->second->object_;
+    shardLock.unlock();
+    ++hits_;
+
+    return output;
+}
+
+StorageCache::Shard& StorageCache::GetShard(const std::string& hash)
+{
+    return *shards_[std::hash<std::string>()(hash) % STORAGE_CACHE_SHARDS];
+}
+
+void StorageCache::Put(
+    const std::string& hash,
+    const Object& object,
+    const std::size_t size)
+{
+    if ((!object) || (0 == shard_limit_)) { return; }
+
+    // Objects which would evict a whole shard are not worth caching
+    if (size > shard_limit_) { return; }
+
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> shardLock(shard.lock_);
+
+    if (shard.index_.end() != shard.index_.find(hash)) { return; }
+
+    shard.entries_.push_front(Entry());
+    Entry& entry = shard.entries_.front();
+    entry.hash_ = hash;
+    entry.object_ = object;
+    entry.size_ = size;
+    shard.index_[hash] = shard.entries_.begin();
+    shard.bytes_ += size;
+
+    while (shard.bytes_ > shard_limit_) {
+        const Entry& oldest = shard.entries_.back();
+        shard.bytes_ -= oldest.size_;
+        shard.index_.erase(oldest.hash_);
+        shard.entries_.pop_back();
+    }
+}
+}  // namespace opentxs
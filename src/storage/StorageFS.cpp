@@ -40,14 +40,118 @@
 
 #include <boost/filesystem.hpp>
 
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
 #include <cstdio>
+#include <functional>
 #include <ios>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
+// Number of trailing key characters used to name shard directories. Keys
+// are base58check encoded digests, so their leading characters are not
+// evenly distributed, but their trailing characters are.
+#define STORAGE_FS_SHARD_CHARS 2
+
 namespace opentxs
 {
+namespace
+{
+// Writes data to filename and flushes it to the disk before returning
+bool write_synced(const std::string& filename, const std::string& data)
+{
+#ifdef _WIN32
+    std::ofstream file(
+        filename,
+        std::ios::out | std::ios::trunc | std::ios::binary);
+
+    if (!file.good()) { return false; }
+
+    file.write(data.c_str(), data.size());
+    file.close();
+
+    return !file.fail();
+#else
+    const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (-1 == fd) { return false; }
+
+    const char* position = data.data();
+    std::size_t remaining = data.size();
+    bool success = true;
+
+    while (0 < remaining) {
+        const ssize_t written = ::write(fd, position, remaining);
+
+        if (0 > written) {
+            if (EINTR == errno) { continue; }
+
+            success = false;
+            break;
+        }
+
+        position += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+
+    success = success && (0 == ::fsync(fd));
+
+    return (0 == ::close(fd)) && success;
+#endif
+}
+
+// Makes renames into a directory durable
+bool sync_directory(const std::string& path)
+{
+#ifdef _WIN32
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    // The directory belonged to a bucket which has since been emptied
+    if ((-1 == fd) && (ENOENT == errno)) { return true; }
+
+    if (-1 == fd) { return false; }
+
+    const bool success = (0 == ::fsync(fd));
+    ::close(fd);
+
+    return success;
+#endif
+}
+
+bool replace_file(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(to.c_str());
+#endif
+
+    return (0 == std::rename(from.c_str(), to.c_str()));
+}
+
+// Suffix for temporary files which can not collide between threads
+std::string temp_suffix()
+{
+    static std::atomic<uint64_t> counter(0);
+
+    return ".tmp" +
+        std::to_string(std::hash<std::thread::id>()(
+            std::this_thread::get_id())) +
+        "-" + std::to_string(++counter);
+}
+} // namespace
 
 StorageFS::StorageFS(
     const StorageConfig& config,
@@ -59,6 +163,25 @@ StorageFS::StorageFS(
     Init_StorageFS();
 }
 
+std::string StorageFS::GetFilename(const std::string& key, const bool bucket)
+    const
+{
+    if (STORAGE_FS_SHARD_CHARS >= key.size()) {
+
+        return GetFlatFilename(key, bucket);
+    }
+
+    return folder_ + "/" + GetBucketName(bucket) + "/" +
+        key.substr(key.size() - STORAGE_FS_SHARD_CHARS) + "/" + key;
+}
+
+std::string StorageFS::GetFlatFilename(
+    const std::string& key,
+    const bool bucket) const
+{
+    return folder_ + "/" + GetBucketName(bucket) + "/" + key;
+}
+
 void StorageFS::Init_StorageFS()
 {
     boost::filesystem::create_directory(
@@ -74,89 +197,130 @@ void StorageFS::Purge(const std::string& path)
     boost::filesystem::remove_all(path);
 }
 
-std::string StorageFS::LoadRoot() const
+bool StorageFS::ReadFile(const std::string& filename, std::string& value)
+    const
 {
-    if (!folder_.empty()) {
-        std::string filename = folder_ + "/" + config_.fs_root_file_;
+    std::ifstream file(
+        filename,
+        std::ios::in | std::ios::ate | std::ios::binary);
 
-        if (!boost::filesystem::exists(filename)) { return ""; }
+    if (!file.good()) { return false; }
 
-        std::ifstream file(
-            filename,
-            std::ios::in | std::ios::ate | std::ios::binary);
+    std::ifstream::pos_type pos = file.tellg();
 
-        if (file.good()) {
-            std::ifstream::pos_type pos = file.tellg();
+    if ((0 >= pos) || (0xFFFFFFFF <= pos)) { return false; }
 
-            if ((0 >= pos) || (0xFFFFFFFF <= pos)) { return ""; }
+    uint32_t size(pos);
 
-            uint32_t size(pos);
+    file.seekg(0, std::ios::beg);
+    value.resize(size);
+    file.read(&value[0], size);
 
-            file.seekg(0, std::ios::beg);
+    return file.good();
+}
 
-            std::vector<char> bytes(size);
-            file.read(&bytes[0], size);
+bool StorageFS::SyncDirectories() const
+{
+    std::unique_lock<std::mutex> directoryLock(directory_lock_);
+    std::set<std::string> directories;
+    directories.swap(dirty_directories_);
+    directoryLock.unlock();
 
-            return std::string(&bytes[0], size);
-        }
+    bool success = true;
+
+    for (const auto& directory : directories) {
+        success = sync_directory(directory) && success;
     }
 
-    return "";
+    return success;
 }
 
-bool StorageFS::Load(
-    const std::string& key,
-    std::string& value,
-    const bool bucket) const
+bool StorageFS::WriteFile(
+    const std::string& directory,
+    const std::string& filename,
+    const std::string& value) const
 {
-    std::string folder =  folder_ + "/" + GetBucketName(bucket);
-    std::string filename = folder + "/" + key;
+    std::unique_lock<std::mutex> directoryLock(directory_lock_);
 
-    if (!boost::filesystem::exists(filename)) { return false; }
+    if (0 == shard_directories_.count(directory)) {
+        boost::system::error_code error;
+        const bool created =
+            boost::filesystem::create_directories(directory, error);
 
-    if (!folder_.empty()) {
-        std::ifstream file(
-            filename,
-            std::ios::in | std::ios::ate | std::ios::binary);
+        if (error) { return false; }
 
-        if (file.good()) {
-            std::ifstream::pos_type pos = file.tellg();
+        // The new directory's entry in the bucket directory must be synced
+        // too, or a crash could lose every object inside it
+        if (created) {
+            dirty_directories_.insert(
+                directory.substr(0, directory.rfind('/')));
+        }
 
-            if ((0 >= pos) || (0xFFFFFFFF <= pos)) { return false; }
+        shard_directories_.insert(directory);
+    }
 
-            uint32_t size(pos);
+    directoryLock.unlock();
 
-            file.seekg(0, std::ios::beg);
+    const std::string temp = filename + temp_suffix();
 
-            std::vector<char> bytes(size);
-            file.read(&bytes[0], size);
+    if (!write_synced(temp, value)) {
+        std::remove(temp.c_str());
 
-            value.assign(&bytes[0], size);
+        return false;
+    }
 
-            return true;
-        }
+    if (!replace_file(temp, filename)) {
+        std::remove(temp.c_str());
+
+        return false;
     }
 
-    return false;
+    directoryLock.lock();
+    dirty_directories_.insert(directory);
+
+    return true;
 }
 
-bool StorageFS::StoreRoot(const std::string& hash)
+std::string StorageFS::LoadRoot() const
 {
-    if (!folder_.empty()) {
-        std::string filename = folder_ + "/" + config_.fs_root_file_;
-        std::ofstream file(
-            filename,
-            std::ios::out | std::ios::trunc | std::ios::binary);
+    std::string value;
 
-        if (file.good()) {
-            file.write(hash.c_str(), hash.size());
-            file.close();
+    if (!folder_.empty()) {
+        if (ReadFile(folder_ + "/" + config_.fs_root_file_, value)) {
 
-            return true;
+            return value;
         }
     }
 
-    return false;
+    return "";
+}
+
+bool StorageFS::Load(
+    const std::string& key,
+    std::string& value,
+    const bool bucket) const
+{
+    if (folder_.empty()) { return false; }
+
+    if (ReadFile(GetFilename(key, bucket), value)) { return true; }
+
+    // Buckets written before they were sharded are read in place. Garbage
+    // collection rewrites their contents in the current layout.
+    return ReadFile(GetFlatFilename(key, bucket), value);
+}
+
+bool StorageFS::StoreRoot(const std::string& hash)
+{
+    if (folder_.empty()) { return false; }
+
+    // Everything the new root refers to must be on disk before it is
+    if (!SyncDirectories()) { return false; }
+
+    const std::string filename = folder_ + "/" + config_.fs_root_file_;
+
+    if (!WriteFile(folder_, filename, hash)) { return false; }
+
+    return SyncDirectories();
 }
 
 bool StorageFS::Store(
@@ -164,22 +328,12 @@ bool StorageFS::Store(
     const std::string& value,
     const bool bucket) const
 {
-    std::string folder =  folder_ + "/" + GetBucketName(bucket);
-    std::string filename = folder + "/" + key;
+    if (folder_.empty()) { return false; }
 
-    if (!folder_.empty()) {
-        std::ofstream file(
-            filename,
-            std::ios::out | std::ios::trunc | std::ios::binary);
-        if (file.good()) {
-            file.write(value.c_str(), value.size());
-            file.close();
-
-            return true;
-        }
-    }
+    const std::string filename = GetFilename(key, bucket);
 
-    return false;
+    return WriteFile(
+        filename.substr(0, filename.rfind('/')), filename, value);
 }
 
 bool StorageFS::EmptyBucket(
@@ -198,6 +352,10 @@ bool StorageFS::EmptyBucket(
     std::thread backgroundDelete(&StorageFS::Purge, this, newName);
     backgroundDelete.detach();
 
+    std::unique_lock<std::mutex> directoryLock(directory_lock_);
+    shard_directories_.clear();
+    directoryLock.unlock();
+
     return boost::filesystem::create_directory(oldDirectory);
 }
 
@@ -0,0 +1,340 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+#ifdef OT_STORAGE_LMDB
+#include "opentxs/storage/StorageLMDB.hpp"
+
+#include "opentxs/storage/Storage.hpp"
+#include "opentxs/storage/StorageConfig.hpp"
+
+#include <assert.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+StorageLMDB::StorageLMDB(
+    const StorageConfig& config,
+    const Digest& hash,
+    const Random& random)
+        : ot_super(config, hash, random)
+        , folder_(config.path_)
+        , batch_owner_(std::thread::id())
+{
+    Init_StorageLMDB();
+}
+
+bool StorageLMDB::Get(
+    const MDB_dbi database,
+    const std::string& key,
+    const RawReader& reader) const
+{
+    MDB_val k{key.size(), const_cast<char*>(key.data())};
+    MDB_val v{0, nullptr};
+
+    // Uncommitted writes are only visible to the transaction which made them
+    if (batch_owner_.load() == std::this_thread::get_id()) {
+        std::lock_guard<std::recursive_mutex> batchLock(batch_lock_);
+
+        if (MDB_SUCCESS != mdb_get(batch_, database, &k, &v)) {
+
+            return false;
+        }
+
+        return reader(static_cast<const char*>(v.mv_data), v.mv_size);
+    }
+
+    // Storage publishes new hashes before the batch which wrote them
+    // commits, so a miss may just mean another thread's batch is still open.
+    // Holding batch_lock_ for the second look waits for that batch.
+    std::unique_lock<std::recursive_mutex> batchLock(
+        batch_lock_, std::defer_lock);
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        MDB_txn* txn = nullptr;
+
+        if (MDB_SUCCESS != mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn)) {
+
+            return false;
+        }
+
+        bool success = false;
+        const int result = mdb_get(txn, database, &k, &v);
+
+        // The value points into the memory map and stays valid until the
+        // transaction ends
+        if (MDB_SUCCESS == result) {
+            success = reader(static_cast<const char*>(v.mv_data), v.mv_size);
+        }
+
+        mdb_txn_abort(txn);
+
+        if (MDB_NOTFOUND != result) { return success; }
+
+        if (0 == attempt) { batchLock.lock(); }
+    }
+
+    return false;
+}
+
+bool StorageLMDB::Put(
+    const MDB_dbi database,
+    const std::string& key,
+    const std::string& value) const
+{
+    MDB_val k{key.size(), const_cast<char*>(key.data())};
+    MDB_val v{value.size(), const_cast<char*>(value.data())};
+
+    std::lock_guard<std::recursive_mutex> batchLock(batch_lock_);
+
+    if (nullptr != batch_) {
+
+        return (MDB_SUCCESS == mdb_put(batch_, database, &k, &v, 0));
+    }
+
+    MDB_txn* txn = nullptr;
+
+    if (MDB_SUCCESS != mdb_txn_begin(env_, nullptr, 0, &txn)) {
+
+        return false;
+    }
+
+    if (MDB_SUCCESS != mdb_put(txn, database, &k, &v, 0)) {
+        mdb_txn_abort(txn);
+
+        return false;
+    }
+
+    return (MDB_SUCCESS == mdb_txn_commit(txn));
+}
+
+void StorageLMDB::Init_StorageLMDB()
+{
+    MDB_txn* txn = nullptr;
+    bool success = (MDB_SUCCESS == mdb_env_create(&env_));
+    success = success && (MDB_SUCCESS == mdb_env_set_maxdbs(env_, 3));
+    success = success && (MDB_SUCCESS == mdb_env_set_mapsize(
+        env_, static_cast<size_t>(config_.lmdb_map_size_)));
+    // Transactions are not tied to the thread which opened them
+    success = success && (MDB_SUCCESS == mdb_env_open(
+        env_, folder_.c_str(), MDB_NOTLS, 0664));
+    success = success &&
+        (MDB_SUCCESS == mdb_txn_begin(env_, nullptr, 0, &txn));
+
+    if (success) {
+        success = (MDB_SUCCESS == mdb_dbi_open(
+            txn,
+            config_.lmdb_primary_bucket_.c_str(),
+            MDB_CREATE,
+            &primary_));
+        success = success && (MDB_SUCCESS == mdb_dbi_open(
+            txn,
+            config_.lmdb_secondary_bucket_.c_str(),
+            MDB_CREATE,
+            &secondary_));
+        success = success && (MDB_SUCCESS == mdb_dbi_open(
+            txn,
+            config_.lmdb_control_table_.c_str(),
+            MDB_CREATE,
+            &control_));
+
+        if (success) {
+            success = (MDB_SUCCESS == mdb_txn_commit(txn));
+        } else {
+            mdb_txn_abort(txn);
+        }
+    }
+
+    if (!success) {
+        std::cout << "Failed to initialize database." << std::endl;
+
+        if (nullptr != env_) {
+            mdb_env_close(env_);
+            env_ = nullptr;
+        }
+
+        assert(false);
+    }
+}
+
+bool StorageLMDB::BeginBatch() const
+{
+    batch_lock_.lock();
+
+    if (0 == batch_depth_) {
+        if (MDB_SUCCESS != mdb_txn_begin(env_, nullptr, 0, &batch_)) {
+            batch_ = nullptr;
+            batch_lock_.unlock();
+
+            return false;
+        }
+
+        batch_owner_.store(std::this_thread::get_id());
+    }
+
+    ++batch_depth_;
+
+    return true;
+}
+
+bool StorageLMDB::CommitBatch() const
+{
+    bool success = true;
+
+    if (0 == --batch_depth_) {
+        success = (MDB_SUCCESS == mdb_txn_commit(batch_));
+
+        if (!success) {
+            std::cout << "Failed to commit batch." << std::endl;
+        }
+
+        batch_ = nullptr;
+        batch_owner_.store(std::thread::id());
+    }
+
+    batch_lock_.unlock();
+
+    return success;
+}
+
+std::string StorageLMDB::LoadRoot() const
+{
+    std::string value;
+
+    if (Get(
+        control_,
+        config_.lmdb_root_key_,
+        [&value](const char* data, const std::size_t size) -> bool
+        {
+            value.assign(data, size);
+
+            return true;
+        })) {
+
+        return value;
+    }
+
+    return "";
+}
+
+bool StorageLMDB::Load(
+    const std::string& key,
+    std::string& value,
+    const bool bucket) const
+{
+    return Get(
+        GetDatabase(bucket),
+        key,
+        [&value](const char* data, const std::size_t size) -> bool
+        {
+            value.assign(data, size);
+
+            return true;
+        });
+}
+
+bool StorageLMDB::Load(
+    const std::string& key,
+    const bool bucket,
+    const RawReader& reader) const
+{
+    return Get(GetDatabase(bucket), key, reader);
+}
+
+bool StorageLMDB::StoreRoot(const std::string& hash)
+{
+    return Put(control_, config_.lmdb_root_key_, hash);
+}
+
+bool StorageLMDB::Store(
+    const std::string& key,
+    const std::string& value,
+    const bool bucket) const
+{
+    return Put(GetDatabase(bucket), key, value);
+}
+
+bool StorageLMDB::EmptyBucket(const bool bucket)
+{
+    std::lock_guard<std::recursive_mutex> batchLock(batch_lock_);
+    MDB_txn* txn = batch_;
+
+    if (nullptr == txn) {
+        if (MDB_SUCCESS != mdb_txn_begin(env_, nullptr, 0, &txn)) {
+
+            return false;
+        }
+    }
+
+    // Empties the database but keeps its handle open
+    if (MDB_SUCCESS != mdb_drop(txn, GetDatabase(bucket), 0)) {
+        if (txn != batch_) { mdb_txn_abort(txn); }
+
+        return false;
+    }
+
+    if (txn != batch_) {
+
+        return (MDB_SUCCESS == mdb_txn_commit(txn));
+    }
+
+    return true;
+}
+
+void StorageLMDB::Cleanup_StorageLMDB()
+{
+    std::lock_guard<std::recursive_mutex> batchLock(batch_lock_);
+
+    if (nullptr != env_) {
+        mdb_env_close(env_);
+        env_ = nullptr;
+    }
+}
+
+void StorageLMDB::Cleanup()
+{
+    Cleanup_StorageLMDB();
+}
+
+StorageLMDB::~StorageLMDB()
+{
+    Cleanup_StorageLMDB();
+}
+
+} // namespace opentxs
+#endif
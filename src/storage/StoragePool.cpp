@@ -0,0 +1,102 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/storage/StoragePool.hpp"
+
+namespace opentxs
+{
+StoragePool::StoragePool(const std::size_t threads)
+    : size_((0 < threads) ? threads : 1)
+{
+}
+
+void StoragePool::Run(const Job& job)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    if (stop_) {
+        lock.unlock();
+        job();
+
+        return;
+    }
+
+    if (threads_.empty()) {
+        for (std::size_t i = 0; i < size_; ++i) {
+            threads_.emplace_back(&StoragePool::Worker, this);
+        }
+    }
+
+    jobs_.push(job);
+    lock.unlock();
+    signal_.notify_one();
+}
+
+void StoragePool::Stop()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    stop_ = true;
+    lock.unlock();
+    signal_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) { thread.join(); }
+    }
+}
+
+void StoragePool::Worker()
+{
+    while (true) {
+        std::unique_lock<std::mutex> lock(lock_);
+        signal_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+
+        if (jobs_.empty()) { return; }
+
+        Job job = jobs_.front();
+        jobs_.pop();
+        lock.unlock();
+        job();
+    }
+}
+
+StoragePool::~StoragePool()
+{
+    Stop();
+}
+
+}  // namespace opentxs
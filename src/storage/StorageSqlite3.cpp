@@ -45,7 +45,14 @@
 #include <sqlite3.h>
 #include <stdint.h>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
+#define OT_SQLITE3_IDLE_READERS 8
 
 namespace opentxs
 {
@@ -55,20 +62,174 @@ StorageSqlite3::StorageSqlite3(
     const Random& random)
         : ot_super(config, hash, random)
         , folder_(config.path_)
+        , batch_owner_(std::thread::id())
 {
     Init_StorageSqlite3();
 }
 
+void StorageSqlite3::Close(Connection& connection)
+{
+    for (auto& it : connection.select_) {
+        sqlite3_finalize(it.second);
+    }
+
+    for (auto& it : connection.upsert_) {
+        sqlite3_finalize(it.second);
+    }
+
+    connection.select_.clear();
+    connection.upsert_.clear();
+
+    if (nullptr != connection.db_) {
+        sqlite3_close(connection.db_);
+        connection.db_ = nullptr;
+    }
+}
+
+void StorageSqlite3::Forget(Connection& connection, const std::string& tablename)
+{
+    auto it = connection.select_.find(tablename);
+
+    if (connection.select_.end() != it) {
+        sqlite3_finalize(it->second);
+        connection.select_.erase(it);
+    }
+
+    it = connection.upsert_.find(tablename);
+
+    if (connection.upsert_.end() != it) {
+        sqlite3_finalize(it->second);
+        connection.upsert_.erase(it);
+    }
+}
+
+bool StorageSqlite3::Open(
+    const std::string& filename,
+    const int flags,
+    Connection& connection)
+{
+    if (SQLITE_OK == sqlite3_open_v2(
+        filename.c_str(), &connection.db_, flags, nullptr)) {
+
+        return true;
+    }
+
+    // sqlite3_open_v2 allocates a handle even when it fails
+    sqlite3_close(connection.db_);
+    connection.db_ = nullptr;
+
+    return false;
+}
+
+std::unique_ptr<StorageSqlite3::Connection> StorageSqlite3::Borrow() const
+{
+    std::unique_ptr<Connection> reader;
+
+    {
+        std::lock_guard<std::mutex> readersLock(readers_lock_);
+
+        if (!readers_.empty()) {
+            reader = std::move(readers_.back());
+            readers_.pop_back();
+
+            return reader;
+        }
+    }
+
+    reader.reset(new Connection);
+    const std::string filename = folder_ + "/" + config_.sqlite3_db_file_;
+
+    if (!Open(
+        filename,
+        SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+        *reader)) {
+            std::cout << "Failed to open read connection." << std::endl;
+            reader.reset();
+    }
+
+    return reader;
+}
+
+void StorageSqlite3::GiveBack(std::unique_ptr<Connection>& reader) const
+{
+    std::unique_lock<std::mutex> readersLock(readers_lock_);
+
+    if (OT_SQLITE3_IDLE_READERS > readers_.size()) {
+        readers_.push_back(std::move(reader));
+
+        return;
+    }
+
+    readersLock.unlock();
+    Close(*reader);
+    reader.reset();
+}
+
+sqlite3_stmt* StorageSqlite3::Statement(
+    Connection& connection,
+    const bool upsert,
+    const std::string& tablename) const
+{
+    auto& cache = upsert ? connection.upsert_ : connection.select_;
+    auto it = cache.find(tablename);
+
+    if (cache.end() != it) {
+
+        return it->second;
+    }
+
+    const std::string query = upsert
+        ? "insert or replace into `" + tablename + "` (k, v) values (?1, ?2);"
+        : "select v from `" + tablename + "` where k=?1 LIMIT 0,1;";
+    sqlite3_stmt* statement = nullptr;
+
+    if (SQLITE_OK != sqlite3_prepare_v2(
+        connection.db_, query.c_str(), -1, &statement, 0)) {
+            sqlite3_finalize(statement);
+
+            return nullptr;
+    }
+
+    cache[tablename] = statement;
+
+    return statement;
+}
+
 bool StorageSqlite3::Select(
     const std::string& key,
     const std::string& tablename,
     std::string& value) const
 {
-    sqlite3_stmt* statement = nullptr;
-    const std::string query =
-        "select v from `" + tablename + "` where k=?1 LIMIT 0,1;";
+    // Uncommitted writes are only visible on the connection which made them
+    if (batch_owner_.load() != std::this_thread::get_id()) {
+        std::unique_ptr<Connection> reader = Borrow();
+
+        if (reader) {
+            const bool found = Select(*reader, key, tablename, value);
+            GiveBack(reader);
+
+            if (found) { return true; }
+        }
+    }
+
+    // Storage publishes new hashes before the batch which wrote them
+    // commits, so a miss may just mean another thread's batch is still open.
+    // Waiting for the write connection waits for that batch.
+    std::lock_guard<std::recursive_mutex> writerLock(writer_lock_);
+
+    return Select(writer_, key, tablename, value);
+}
+
+bool StorageSqlite3::Select(
+    Connection& connection,
+    const std::string& key,
+    const std::string& tablename,
+    std::string& value) const
+{
+    sqlite3_stmt* statement = Statement(connection, false, tablename);
+
+    if (nullptr == statement) { return false; }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
     bool success = false;
@@ -79,7 +240,8 @@ bool StorageSqlite3::Select(
         value.assign(static_cast<const char*>(pResult), size);
         success = true;
     }
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
 
     return success;
 }
@@ -89,16 +251,16 @@ bool StorageSqlite3::Upsert(
     const std::string& tablename,
     const std::string& value) const
 {
-    sqlite3_stmt *statement;
-    const std::string query =
-        "insert or replace into `" + tablename +
-        "` (k, v) values (?1, ?2);";
+    std::lock_guard<std::recursive_mutex> writerLock(writer_lock_);
+    sqlite3_stmt* statement = Statement(writer_, true, tablename);
+
+    if (nullptr == statement) { return false; }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     sqlite3_bind_blob(statement, 2, value.c_str(), value.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
 
     return (result == SQLITE_DONE);
 }
@@ -110,15 +272,19 @@ bool StorageSqlite3::Create(const std::string& tablename)
     const std::string sql = createTable + "`" + tablename + "`" + tableFormat;
 
     return (SQLITE_OK ==
-        sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr));
+        sqlite3_exec(writer_.db_, sql.c_str(), nullptr, nullptr, nullptr));
 }
 
 bool StorageSqlite3::Purge(const std::string& tablename)
 {
     const std::string sql = "DROP TABLE `" + tablename + "`;";
+    std::lock_guard<std::recursive_mutex> writerLock(writer_lock_);
+
+    // A table can not be dropped while statements on it are outstanding
+    Forget(writer_, tablename);
 
     if (SQLITE_OK ==
-        sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr)) {
+        sqlite3_exec(writer_.db_, sql.c_str(), nullptr, nullptr, nullptr)) {
             return Create(tablename);
     }
 
@@ -129,16 +295,21 @@ void StorageSqlite3::Init_StorageSqlite3()
 {
     const std::string filename = folder_ + "/" + config_.sqlite3_db_file_;
 
-    if (SQLITE_OK == sqlite3_open_v2(
-        filename.c_str(),
-        &db_,
-        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
-        nullptr)) {
+    // writer_lock_ serializes access to this connection, so sqlite does not
+    // need to.
+    if (Open(
+        filename,
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+        writer_)) {
             Create(config_.sqlite3_primary_bucket_);
             Create(config_.sqlite3_secondary_bucket_);
             Create(config_.sqlite3_control_table_);
             sqlite3_exec(
-                db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+                writer_.db_,
+                "PRAGMA journal_mode=WAL;",
+                nullptr,
+                nullptr,
+                nullptr);
     } else {
         std::cout << "Failed to initialize database." << std::endl;
         assert(false);
@@ -146,6 +317,47 @@ void StorageSqlite3::Init_StorageSqlite3()
 
 }
 
+bool StorageSqlite3::BeginBatch() const
+{
+    writer_lock_.lock();
+
+    if (0 == batch_depth_) {
+        if (SQLITE_OK != sqlite3_exec(
+            writer_.db_, "BEGIN;", nullptr, nullptr, nullptr)) {
+                writer_lock_.unlock();
+
+                return false;
+        }
+
+        batch_owner_.store(std::this_thread::get_id());
+    }
+
+    ++batch_depth_;
+
+    return true;
+}
+
+bool StorageSqlite3::CommitBatch() const
+{
+    bool success = true;
+
+    if (0 == --batch_depth_) {
+        success = (SQLITE_OK == sqlite3_exec(
+            writer_.db_, "COMMIT;", nullptr, nullptr, nullptr));
+
+        if (!success) {
+            std::cout << "Failed to commit batch." << std::endl;
+            sqlite3_exec(writer_.db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+        }
+
+        batch_owner_.store(std::thread::id());
+    }
+
+    writer_lock_.unlock();
+
+    return success;
+}
+
 std::string StorageSqlite3::LoadRoot() const
 {
     std::string value;
@@ -187,7 +399,16 @@ bool StorageSqlite3::EmptyBucket(const bool bucket)
 
 void StorageSqlite3::Cleanup_StorageSqlite3()
 {
-    sqlite3_close(db_);
+    std::lock_guard<std::mutex> readersLock(readers_lock_);
+
+    for (auto& it : readers_) {
+        Close(*it);
+    }
+
+    readers_.clear();
+
+    std::lock_guard<std::recursive_mutex> writerLock(writer_lock_);
+    Close(writer_);
 }
 
 void StorageSqlite3::Cleanup()
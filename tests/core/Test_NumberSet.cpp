@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/NumberSet.hpp"
+#include "opentxs/core/String.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// Checks every observable property of numbers against the expected set.
+void compare(const NumberSet& numbers, const std::set<int64_t>& expected)
+{
+    ASSERT_EQ(expected.size(), numbers.size());
+    ASSERT_EQ(expected.empty(), numbers.empty());
+
+    std::vector<int64_t> iterated(numbers.begin(), numbers.end());
+    ASSERT_EQ(std::vector<int64_t>(expected.begin(), expected.end()),
+              iterated);
+
+    if (expected.empty()) {
+        ASSERT_EQ(0, numbers.Lowest());
+        ASSERT_EQ(0, numbers.Highest());
+
+        return;
+    }
+
+    ASSERT_EQ(*expected.begin(), numbers.Lowest());
+    ASSERT_EQ(*expected.rbegin(), numbers.Highest());
+}
+
+} // namespace
+
+TEST(NumberSet, default_is_empty)
+{
+    NumberSet numbers;
+    String output;
+
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_EQ(0U, numbers.size());
+    ASSERT_TRUE(numbers.begin() == numbers.end());
+    ASSERT_FALSE(numbers.Verify(1));
+    ASSERT_EQ(0, numbers.At(0));
+    ASSERT_FALSE(numbers.Output(output));
+}
+
+TEST(NumberSet, add_and_remove)
+{
+    NumberSet numbers;
+
+    ASSERT_TRUE(numbers.Add(5));
+    ASSERT_FALSE(numbers.Add(5));
+    ASSERT_TRUE(numbers.Add(7));
+    ASSERT_EQ(2U, numbers.Intervals().size());
+
+    // Filling the gap joins both runs
+    ASSERT_TRUE(numbers.Add(6));
+    ASSERT_EQ(1U, numbers.Intervals().size());
+
+    // Removing from the middle splits them again
+    ASSERT_TRUE(numbers.Remove(6));
+    ASSERT_FALSE(numbers.Remove(6));
+    ASSERT_EQ(2U, numbers.Intervals().size());
+    ASSERT_TRUE(numbers.Verify(5));
+    ASSERT_FALSE(numbers.Verify(6));
+    ASSERT_TRUE(numbers.Verify(7));
+
+    numbers.clear();
+    ASSERT_TRUE(numbers.empty());
+    ASSERT_FALSE(numbers.Verify(5));
+}
+
+TEST(NumberSet, at_and_output)
+{
+    NumberSet numbers;
+
+    for (const int64_t number : {9, 3, 4, 5, 12, 10}) {
+        numbers.Add(number);
+    }
+
+    ASSERT_EQ(3, numbers.At(0));
+    ASSERT_EQ(5, numbers.At(2));
+    ASSERT_EQ(9, numbers.At(3));
+    ASSERT_EQ(12, numbers.At(5));
+    ASSERT_EQ(0, numbers.At(6));
+
+    String output;
+    ASSERT_TRUE(numbers.Output(output));
+    ASSERT_STREQ("3,4,5,9,10,12", output.Get());
+}
+
+// A Nym holding 20,000 numbers, issued in blocks with some used up
+TEST(NumberSet, verify_20000_numbers)
+{
+    NumberSet numbers;
+    std::set<int64_t> expected;
+
+    for (int64_t block = 0; block < 200; ++block) {
+        const int64_t first = 1000 + block * 150;
+
+        for (int64_t number = first; number < first + 100; ++number) {
+            ASSERT_TRUE(numbers.Add(number));
+            expected.insert(number);
+        }
+    }
+
+    ASSERT_EQ(20000U, numbers.size());
+    ASSERT_EQ(200U, numbers.Intervals().size());
+
+    for (const auto& number : expected) {
+        ASSERT_TRUE(numbers.Verify(number));
+    }
+
+    for (int64_t block = 0; block < 200; ++block) {
+        const int64_t gap = 1000 + block * 150 + 100;
+
+        ASSERT_FALSE(numbers.Verify(gap));
+        ASSERT_FALSE(numbers.Verify(gap + 49));
+    }
+
+    ASSERT_FALSE(numbers.Verify(999));
+    ASSERT_FALSE(numbers.Verify(0));
+    ASSERT_FALSE(numbers.Verify(-1));
+
+    // Use up every third number
+    for (auto it = expected.begin(); it != expected.end();) {
+        if (0 == (*it % 3)) {
+            ASSERT_TRUE(numbers.Remove(*it));
+            it = expected.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    compare(numbers, expected);
+
+    for (int64_t number = 900; number < 31100; ++number) {
+        ASSERT_EQ(1U == expected.count(number), numbers.Verify(number));
+    }
+}
+
+TEST(NumberSet, random_operations)
+{
+    NumberSet numbers;
+    std::set<int64_t> expected;
+    std::mt19937 random(20000);
+    std::uniform_int_distribution<int64_t> number(1, 500);
+
+    for (int i = 0; i < 20000; ++i) {
+        const int64_t value = number(random);
+
+        if (0 == (random() % 2)) {
+            ASSERT_EQ(expected.insert(value).second, numbers.Add(value));
+        } else {
+            ASSERT_EQ(1U == expected.erase(value), numbers.Remove(value));
+        }
+    }
+
+    compare(numbers, expected);
+
+    std::size_t index = 0;
+
+    for (const auto& value : expected) {
+        ASSERT_EQ(value, numbers.At(index++));
+    }
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/OTData.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/crypto/CryptoUtil.hpp"
+#include "opentxs/core/crypto/OTASCIIArmor.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+std::string payload(const std::size_t size)
+{
+    std::string output;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        output.push_back(static_cast<char>((i * 7919) & 0xff));
+    }
+
+    return output;
+}
+
+} // namespace
+
+TEST(OTASCIIArmor, string_round_trip)
+{
+    const String original("<notaryMessage>hello world</notaryMessage>");
+    OTASCIIArmor armor(original);
+    String decoded;
+
+    ASSERT_TRUE(armor.GetString(decoded));
+    ASSERT_STREQ(original.Get(), decoded.Get());
+}
+
+TEST(OTASCIIArmor, data_round_trip)
+{
+    for (std::size_t size : {1, 2, 3, 4, 71, 72, 73, 4096}) {
+        const auto raw = payload(size);
+        const OTData original(raw.data(), raw.size());
+        OTASCIIArmor armor(original);
+        OTData decoded;
+
+        ASSERT_TRUE(armor.GetData(decoded));
+        ASSERT_TRUE(original == decoded);
+    }
+}
+
+TEST(OTASCIIArmor, decodes_legacy_base58)
+{
+    const auto raw = payload(100);
+    const OTASCIIArmor armor(CryptoUtil::Base58CheckEncode(raw, true).c_str());
+    OTData decoded;
+
+    ASSERT_TRUE(armor.GetData(decoded));
+    ASSERT_TRUE(OTData(raw.data(), raw.size()) == decoded);
+}
+
+TEST(OTASCIIArmor, rejects_corrupted_payload)
+{
+    const auto raw = payload(100);
+    OTASCIIArmor armor(OTData(raw.data(), raw.size()));
+    std::string encoded(armor.Get());
+    encoded[10] = ('A' == encoded[10]) ? 'B' : 'A';
+    const OTASCIIArmor corrupted(encoded.c_str());
+    OTData decoded;
+
+    ASSERT_FALSE(corrupted.GetData(decoded));
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST(OTASCIIArmor, DISABLED_benchmark)
+{
+    const int rounds = 100;
+
+    for (std::size_t size = 256; size <= (1024 * 1024); size *= 4) {
+        const auto raw = payload(size);
+        const OTData original(raw.data(), raw.size());
+        OTASCIIArmor armor;
+        OTData decoded;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < rounds; ++i) {
+            armor.SetData(original);
+        }
+
+        const auto encoded = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < rounds; ++i) {
+            armor.GetData(decoded);
+        }
+
+        const auto finish = std::chrono::steady_clock::now();
+
+        std::cout << size << " bytes: encode "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         encoded - start).count() / rounds
+                  << " us, decode "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(
+                         finish - encoded).count() / rounds
+                  << " us" << std::endl;
+
+        ASSERT_TRUE(original == decoded);
+    }
+}
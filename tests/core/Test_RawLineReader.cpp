@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/util/RawLineReader.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+typedef std::vector<std::string> Lines;
+
+// How Contract::ParseRawFile used to read a raw file
+Lines read_with_sgets(const std::string& input)
+{
+    Lines output;
+    String raw(input);
+    char buffer[2100];
+    bool bIsEOF = false;
+
+    raw.reset();
+
+    do {
+        std::memset(buffer, 0, sizeof(buffer));
+        bIsEOF = !raw.sgets(buffer, 2048);
+        output.push_back(buffer);
+    } while (!bIsEOF);
+
+    return output;
+}
+
+Lines read_with_reader(const std::string& input)
+{
+    Lines output;
+    RawLineReader reader(input.c_str(), input.size());
+    const char* pLine = nullptr;
+    std::size_t lLength = 0;
+    bool bIsEOF = false;
+
+    do {
+        bIsEOF = !reader.Next(pLine, lLength);
+        output.push_back(std::string(pLine, lLength));
+    } while (!bIsEOF);
+
+    return output;
+}
+
+} // namespace
+
+TEST(RawLineReader, short_lines)
+{
+    const std::string input =
+        "-----BEGIN SIGNED FILE-----\nHash: SHA256\n\n<file>\n\n</file>";
+
+    ASSERT_EQ(read_with_sgets(input), read_with_reader(input));
+    ASSERT_EQ(6U, read_with_reader(input).size());
+}
+
+TEST(RawLineReader, overlong_lines)
+{
+    for (const std::size_t length :
+         {2046U, 2047U, 2048U, 2049U, 4094U, 4095U, 5000U}) {
+        const std::string line(length, 'x');
+
+        for (const std::string& input :
+             {line, line + "\nend", "start\n" + line + "\n" + line}) {
+            const Lines lines = read_with_reader(input);
+
+            ASSERT_EQ(read_with_sgets(input), lines);
+
+            for (const auto& it : lines) {
+                ASSERT_GE(2047U, it.size());
+            }
+        }
+    }
+}
+
+TEST(RawLineReader, random_input)
+{
+    std::mt19937 random(2047);
+    std::uniform_int_distribution<std::size_t> length(0, 5000);
+    std::uniform_int_distribution<int> character(0, 99);
+
+    for (int i = 0; i < 200; ++i) {
+        std::string input(length(random), 'a');
+
+        // Mostly short lines, with a few overlong ones and blank lines
+        for (auto& it : input) {
+            const int pick = character(random);
+
+            if (0 == pick) {
+                it = '\n';
+            } else if (pick < 3) {
+                it = '-';
+            } else if (pick < 50) {
+                it = 'a' + (pick % 26);
+            }
+        }
+
+        if (0 == (i % 4)) {
+            input.insert(0, 3000, 'z');
+        }
+
+        ASSERT_EQ(read_with_sgets(input), read_with_reader(input));
+    }
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/Proto.hpp"
+#include "opentxs/storage/StorageCache.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+const std::size_t SHARD_BYTES = 100;
+
+StorageCache::Object object()
+{
+    return StorageCache::Object(new proto::StorageItemHash);
+}
+
+// Returns count hashes which all land in the same shard
+std::vector<std::string> same_shard(const std::size_t count)
+{
+    std::vector<std::string> output;
+    std::size_t shard = 0;
+
+    for (std::size_t i = 0; output.size() < count; ++i) {
+        const std::string hash = "hash " + std::to_string(i);
+        const std::size_t position = std::hash<std::string>()(hash) % STORAGE_CACHE_SHARDS;
+
+        if (output.empty()) {
+            shard = position;
+        } else if (position != shard) {
+            continue;
+        }
+
+        output.push_back(hash);
+    }
+
+    return output;
+}
+
+} // namespace
+
+TEST(StorageCache, hits_and_misses)
+{
+    StorageCache cache(STORAGE_CACHE_SHARDS * SHARD_BYTES);
+    const auto stored = object();
+
+    ASSERT_FALSE(cache.Get("hash"));
+    cache.Put("hash", stored, 10);
+    ASSERT_EQ(stored, cache.Get("hash"));
+    ASSERT_EQ(stored, cache.Get("hash"));
+    ASSERT_FALSE(cache.Get("other"));
+
+    ASSERT_EQ(2U, cache.Hits());
+    ASSERT_EQ(2U, cache.Misses());
+}
+
+TEST(StorageCache, disabled)
+{
+    StorageCache cache(0);
+
+    cache.Put("hash", object(), 1);
+    ASSERT_FALSE(cache.Get("hash"));
+    ASSERT_EQ(0U, cache.Hits());
+    ASSERT_EQ(1U, cache.Misses());
+}
+
+TEST(StorageCache, too_large_for_shard)
+{
+    StorageCache cache(STORAGE_CACHE_SHARDS * SHARD_BYTES);
+
+    cache.Put("large", object(), SHARD_BYTES + 1);
+    ASSERT_FALSE(cache.Get("large"));
+    cache.Put("fits", object(), SHARD_BYTES);
+    ASSERT_TRUE(bool(cache.Get("fits")));
+}
+
+TEST(StorageCache, evicts_least_recently_used)
+{
+    StorageCache cache(STORAGE_CACHE_SHARDS * SHARD_BYTES);
+    const auto hashes = same_shard(4);
+    const auto first = object();
+
+    cache.Put(hashes[0], first, 40);
+    cache.Put(hashes[1], object(), 40);
+
+    // Using the first entry makes the second the least recently used one
+    ASSERT_EQ(first, cache.Get(hashes[0]));
+    cache.Put(hashes[2], object(), 40);
+
+    ASSERT_EQ(first, cache.Get(hashes[0]));
+    ASSERT_FALSE(cache.Get(hashes[1]));
+    ASSERT_TRUE(bool(cache.Get(hashes[2])));
+
+    // Adding an entry again doesn't count its size twice
+    cache.Put(hashes[2], object(), 40);
+    ASSERT_TRUE(bool(cache.Get(hashes[0])));
+
+    // Evicts as many entries as it takes to fit
+    cache.Put(hashes[3], object(), 90);
+    ASSERT_FALSE(cache.Get(hashes[0]));
+    ASSERT_FALSE(cache.Get(hashes[2]));
+    ASSERT_TRUE(bool(cache.Get(hashes[3])));
+
+    ASSERT_EQ(5U, cache.Hits());
+    ASSERT_EQ(3U, cache.Misses());
+}
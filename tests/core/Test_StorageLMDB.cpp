@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/storage/Storage.hpp"
+#include "opentxs/storage/StorageConfig.hpp"
+#include "opentxs/storage/StorageLMDB.hpp"
+
+namespace opentxs
+{
+
+// Friend of StorageLMDB, so the tests can open and commit write batches
+class Test_StorageLMDB : public ::testing::Test
+{
+protected:
+    static StorageLMDB* storage_;
+
+    static void SetUpTestCase()
+    {
+        char folder[] = "/tmp/opentxs-lmdb-XXXXXX";
+        ASSERT_TRUE(nullptr != mkdtemp(folder));
+
+        StorageConfig config;
+        config.path_ = folder;
+
+        Digest digest = [](const uint32_t, const std::string& input,
+                           std::string& output) -> bool {
+            output = std::to_string(std::hash<std::string>()(input));
+
+            return true;
+        };
+        Random random = []() -> std::string { return "random"; };
+
+        storage_ =
+            dynamic_cast<StorageLMDB*>(&Storage::It(digest, random, config));
+        ASSERT_TRUE(nullptr != storage_);
+    }
+
+    static void TearDownTestCase() { storage_->Cleanup(); }
+
+    bool BeginBatch() { return storage_->BeginBatch(); }
+    bool CommitBatch() { return storage_->CommitBatch(); }
+
+    // Load from another thread, which can't see uncommitted writes
+    std::thread LoadElsewhere(
+        const std::string& key,
+        const bool bucket,
+        bool& found)
+    {
+        return std::thread([key, bucket, &found]() {
+            std::string value;
+            found = storage_->Load(key, value, bucket);
+        });
+    }
+
+    bool LoadElsewhere(const std::string& key, const bool bucket)
+    {
+        bool found = false;
+        LoadElsewhere(key, bucket, found).join();
+
+        return found;
+    }
+};
+
+StorageLMDB* Test_StorageLMDB::storage_ = nullptr;
+
+TEST_F(Test_StorageLMDB, store_and_load)
+{
+    std::string value;
+
+    ASSERT_TRUE(storage_->Store("key", "value", false));
+    ASSERT_TRUE(storage_->Load("key", value, false));
+    ASSERT_EQ("value", value);
+    ASSERT_FALSE(storage_->Load("key", value, true));
+    ASSERT_FALSE(storage_->Load("missing", value, false));
+}
+
+TEST_F(Test_StorageLMDB, load_in_place)
+{
+    std::string value;
+
+    ASSERT_TRUE(storage_->Store("in place", "contents", true));
+    ASSERT_TRUE(storage_->Load(
+        "in place", true, [&](const char* data, const std::size_t size) {
+            value.assign(data, size);
+
+            return true;
+        }));
+    ASSERT_EQ("contents", value);
+    ASSERT_FALSE(storage_->Load(
+        "in place", true, [](const char*, const std::size_t) {
+            return false;
+        }));
+}
+
+TEST_F(Test_StorageLMDB, root)
+{
+    ASSERT_TRUE(storage_->StoreRoot("first"));
+    ASSERT_EQ("first", storage_->LoadRoot());
+    ASSERT_TRUE(storage_->StoreRoot("second"));
+    ASSERT_EQ("second", storage_->LoadRoot());
+}
+
+TEST_F(Test_StorageLMDB, empty_bucket)
+{
+    std::string value;
+
+    ASSERT_TRUE(storage_->Store("kept", "a", false));
+    ASSERT_TRUE(storage_->Store("dropped", "b", true));
+    ASSERT_TRUE(storage_->EmptyBucket(true));
+    ASSERT_FALSE(storage_->Load("dropped", value, true));
+    ASSERT_TRUE(storage_->Load("kept", value, false));
+
+    // The bucket is still usable afterwards
+    ASSERT_TRUE(storage_->Store("dropped", "c", true));
+    ASSERT_TRUE(storage_->Load("dropped", value, true));
+    ASSERT_EQ("c", value);
+}
+
+TEST_F(Test_StorageLMDB, batch)
+{
+    std::string value;
+
+    ASSERT_TRUE(BeginBatch());
+    ASSERT_TRUE(BeginBatch());
+    ASSERT_TRUE(storage_->Store("batched", "value", false));
+    ASSERT_TRUE(storage_->StoreRoot("batched root"));
+
+    // Visible to the thread which owns the batch
+    ASSERT_TRUE(storage_->Load("batched", value, false));
+    ASSERT_EQ("value", value);
+    ASSERT_EQ("batched root", storage_->LoadRoot());
+
+    // Other threads wait for the outermost batch to commit instead of
+    // missing the object
+    bool found = false;
+    std::thread reader = LoadElsewhere("batched", false, found);
+    ASSERT_TRUE(CommitBatch());
+    ASSERT_TRUE(CommitBatch());
+    reader.join();
+    ASSERT_TRUE(found);
+    ASSERT_EQ("batched root", storage_->LoadRoot());
+    ASSERT_FALSE(LoadElsewhere("never stored", false));
+}
+
+TEST_F(Test_StorageLMDB, empty_bucket_in_batch)
+{
+    std::string value;
+
+    ASSERT_TRUE(storage_->Store("old", "value", true));
+    ASSERT_TRUE(BeginBatch());
+    ASSERT_TRUE(storage_->EmptyBucket(true));
+    ASSERT_FALSE(storage_->Load("old", value, true));
+    ASSERT_TRUE(LoadElsewhere("old", true));
+    ASSERT_TRUE(CommitBatch());
+    ASSERT_FALSE(LoadElsewhere("old", true));
+}
+
+} // namespace opentxs